@@ -0,0 +1,118 @@
+#include "BackgroundModel.h"
+
+/** Weight of each distance in the moving average of consecutive foreground distances */
+constexpr float     FOREGROUND_WEIGHT   = 0.25f;
+
+// Constructors
+
+BackgroundModel::BackgroundModel(float learningRate, float threshold, float minDeviation, uint32_t warmup, uint32_t absorbAfter)
+        : learningRate(learningRate)
+        , threshold(threshold)
+        , minDeviation(minDeviation)
+        , warmup(warmup)
+        , absorbAfter(absorbAfter)
+{
+}
+
+// Public Methods
+
+BackgroundEvent
+BackgroundModel::add(float value) {
+
+    // the first distance initializes the background
+    // during the warm-up, learn quickly (a cumulative average) and never report foreground
+    // afterwards, a distance is foreground if it deviates by more than the threshold times the typical deviation (or the minimum deviation)
+    //
+    // learn from background distances only
+    // track the average of consecutive foreground distances, and once there have been enough, make it the new background
+    // report a change of state only when the classification differs from the previous one
+
+    float   diff;
+    float   rate;
+    float   limit;
+    bool    wasForeground;
+
+    if (count == 0) {
+
+        background  = value;
+        deviation   = 0;
+        count       = 1;
+
+        return BackgroundEvent::NONE;
+    }
+
+    diff            = (value > background) ? value - background : background - value;
+    wasForeground   = foreground;
+
+    if (count < warmup) {
+
+        ++count;
+        rate        = 1.0f / count;
+        foreground  = false;
+    }
+    else {
+
+        limit       = threshold * deviation;
+        foreground  = diff > ((limit > minDeviation) ? limit : minDeviation);
+        rate        = learningRate;
+    }
+
+    if (!foreground) {
+
+        background         += (value - background) * rate;
+        deviation          += (diff - deviation) * rate;
+        foregroundCount     = 0;
+    }
+    else {
+
+        foregroundMean      = (foregroundCount == 0) ? value : foregroundMean + (value - foregroundMean) * FOREGROUND_WEIGHT;
+        ++foregroundCount;
+
+        if (absorbAfter != 0 && foregroundCount >= absorbAfter) {
+
+            background      = foregroundMean;
+            foreground      = false;
+            foregroundCount = 0;
+        }
+    }
+
+    if (foreground == wasForeground) {
+        return BackgroundEvent::NONE;
+    }
+    return foreground ? BackgroundEvent::FOREGROUND_ENTER : BackgroundEvent::FOREGROUND_EXIT;
+}
+
+bool
+BackgroundModel::is_foreground() const {
+
+    return foreground;
+}
+
+bool
+BackgroundModel::is_learned() const {
+
+    return count >= warmup;
+}
+
+float
+BackgroundModel::get_background() const {
+
+    return background;
+}
+
+float
+BackgroundModel::get_deviation() const {
+
+    return deviation;
+}
+
+void
+BackgroundModel::reset() {
+
+    count           = 0;
+    background      = 0;
+    deviation       = 0;
+    foreground      = false;
+    foregroundCount = 0;
+    foregroundMean  = 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file                    BackgroundModel.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Learned background distance of a static installation, used to detect objects in front of it
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __BACKGROUNDMODEL_H__
+#define __BACKGROUNDMODEL_H__
+
+#include <cstdint>
+
+/**
+ * @brief                   Change of state reported by a BackgroundModel after each distance
+ */
+enum class BackgroundEvent : uint8_t {
+
+    /** The state did not change */
+    NONE,
+    /** A distance deviated significantly from the background (an object appeared) */
+    FOREGROUND_ENTER,
+    /** A distance matched the background again (the object left) */
+    FOREGROUND_EXIT
+};
+
+/**
+ * @brief                   Class that learns the background distance seen by a sensor and detects distances that deviate from it (foreground)
+ *
+ * @remarks                 The background is a slow exponential moving average of the distance, along with a moving average of the absolute
+ *                          deviation from it, and a distance is foreground if it deviates by more than the threshold times the typical deviation
+ *                          (but never by less than the minimum deviation)
+ * @remarks                 Foreground distances are not learned, so that a passing object does not disturb the background, while an object that
+ *                          stays long enough (for example, a box placed on a shelf) is absorbed into it, replacing the background
+ * @remarks                 Nothing is reported as foreground till the model has learned from a number of distances (warm-up)
+ * @remarks                 Each update takes constant time and memory, and the class does not depend on MBed OS
+ */
+class BackgroundModel {
+
+    /** Weight of each background distance in the moving averages */
+    float           learningRate;
+    /** Number of typical deviations by which a distance must deviate to be foreground */
+    float           threshold;
+    /** Smallest deviation that is foreground */
+    float           minDeviation;
+    /** Number of distances to learn from before reporting foreground */
+    uint32_t        warmup;
+    /** Number of consecutive foreground distances after which they are absorbed into the background (0 to never absorb) */
+    uint32_t        absorbAfter;
+
+    /** Number of distances learned from since the last reset */
+    uint32_t        count {0};
+    /** Moving average of the distance (the background) */
+    float           background {0};
+    /** Moving average of the absolute deviation of the distance from the background */
+    float           deviation {0};
+    /** Whether the most recent distance was foreground */
+    bool            foreground {false};
+    /** Number of consecutive foreground distances */
+    uint32_t        foregroundCount {0};
+    /** Moving average of the consecutive foreground distances */
+    float           foregroundMean {0};
+
+public:
+
+    /**
+     * @brief               Construct a new BackgroundModel object
+     *
+     * @param learningRate  Weight of each background distance in the moving averages (for example, 0.01 to follow the background over about 100 distances)
+     * @param threshold     Number of typical deviations by which a distance must deviate from the background to be foreground
+     * @param minDeviation  Smallest deviation that is foreground (in the unit of the distances)
+     * @param warmup        Number of distances to learn from before reporting foreground
+     * @param absorbAfter   Number of consecutive foreground distances after which they become the background (0 to never absorb)
+     */
+    explicit BackgroundModel(float learningRate = 0.01f, float threshold = 4.0f, float minDeviation = 2.0f, uint32_t warmup = 20, uint32_t absorbAfter = 500);
+
+    /**
+     * @brief               Classifies a distance as background or foreground, and learns from it
+     *
+     * @param value         Measured distance
+     *
+     * @return              Change of state caused by the distance (an absorbed object is reported as BackgroundEvent::FOREGROUND_EXIT)
+     */
+    BackgroundEvent add(float value);
+
+    /**
+     * @brief               Checks if the most recent distance was foreground
+     *
+     * @return              true if it was foreground, false otherwise
+     */
+    bool            is_foreground() const;
+
+    /**
+     * @brief               Checks if the model has finished its warm-up and reports foreground
+     *
+     * @return              true if the warm-up is complete, false otherwise
+     */
+    bool            is_learned() const;
+
+    /**
+     * @brief               Get the learned background distance
+     *
+     * @return              Background distance (0 if nothing was learned)
+     */
+    float           get_background() const;
+
+    /**
+     * @brief               Get the typical deviation of the distance from the background
+     *
+     * @return              Moving average of the absolute deviation
+     */
+    float           get_deviation() const;
+
+    /**
+     * @brief               Discards the learned background
+     */
+    void            reset();
+};
+
+#endif //__BACKGROUNDMODEL_H__
@@ -0,0 +1,100 @@
+/**
+ * @file                    BackgroundMonitor.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Attaches background learning and foreground detection to the measurements of an HCSR04 sensor
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __BACKGROUNDMONITOR_H__
+#define __BACKGROUNDMONITOR_H__
+
+#include "mbed.h"
+#include "BackgroundModel.h"
+
+/**
+ * @brief                   Class that learns the background distance seen by a sensor, and reports when objects appear in front of it or leave
+ *
+ * @remarks                 Pass the callback returned by BackgroundMonitor::input() to BasicHCSR04::do_measurement() or BasicHCSR04::start_measurement_periodic()
+ *                          (or call BackgroundMonitor::on_measurement() from an existing callback) to attach the monitor to a sensor
+ * @remarks                 Failed measurements are ignored, so a sensor facing open space beyond its range only learns from real echoes
+ *
+ * @tparam T                Type in which the sensor reports distances (see BasicHCSR04::value_type)
+ */
+template <typename T = float>
+class BackgroundMonitor {
+
+    /** Learned background of the sensor */
+    BackgroundModel model;
+    /** Callback when the state changes */
+    Callback<void(BackgroundEvent, float)> eventCb;
+
+public:
+
+    /**
+     * @brief               Construct a new BackgroundMonitor object
+     *
+     * @param model         Background model, constructed with the parameters of the installation (see BackgroundModel::BackgroundModel())
+     * @param cb            Callback when an object appears or leaves, with the event and the distance that caused it as arguments
+     */
+    BackgroundMonitor(const BackgroundModel &model, const Callback<void(BackgroundEvent, float)> &cb)
+            : model(model)
+            , eventCb(cb)
+    {
+    }
+
+    /**
+     * @brief               Classifies a measurement and learns from it, calling the callback if the state changes
+     *
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param valid         Whether the measurement was successful
+     * @param dist          Measured distance
+     */
+    void on_measurement(bool valid, T dist) {
+
+        BackgroundEvent event;
+
+        if (!valid) {
+            return;
+        }
+
+        event = model.add((float)dist);
+        if (event != BackgroundEvent::NONE && eventCb) {
+            eventCb(event, (float)dist);
+        }
+    }
+
+    /**
+     * @brief               Get a callback that feeds measurements into this object
+     *
+     * @return              Callback with the signature of the callbacks of BasicHCSR04
+     */
+    Callback<void(bool, T)> input() {
+        return callback(this, &BackgroundMonitor::on_measurement);
+    }
+
+    /**
+     * @brief               Get the background model, for example to read the learned background
+     *
+     * @attention           Must be called on the thread on which the measurements are reported (for example, from the event callback)
+     *
+     * @return              Reference to the model
+     */
+    const BackgroundModel &get_model() const {
+        return model;
+    }
+
+    /**
+     * @brief               Discards the learned background, so that it is learned again
+     *
+     * @attention           Must be called on the thread on which the measurements are reported
+     */
+    void reset() {
+        model.reset();
+    }
+};
+
+#endif //__BACKGROUNDMONITOR_H__
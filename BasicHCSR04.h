@@ -0,0 +1,1599 @@
+/**
+ * @file                    BasicHCSR04.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Policy-based Library to use an HCSR04 ultrasonic sensor with MBed OS asynchronously
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __BASICHCSR04_H__
+#define __BASICHCSR04_H__
+
+#include <utility>
+
+#include "mbed.h"
+#include "ConfidenceEstimator.h"
+#include "EchoCapture.h"
+#include "HCSR04Filters.h"
+#include "HCSR04Units.h"
+#include "SpeedOfSound.h"
+
+/**
+ * @brief                   Way in which the distances of the pings of a burst are combined into a single distance
+ */
+enum class BurstCombine : uint8_t {
+
+    /** Median of the distances */
+    MEDIAN,
+    /** Mean of the distances after discarding the lowest and highest quarter of them */
+    TRIMMED_MEAN
+};
+
+/** Maximum number of pings in a burst (see BasicHCSR04::do_burst_measurement()) */
+constexpr uint8_t   BURST_MAX_PINGS = 16;
+/** Interval at which posting the completion of an asynchronous finalize is retried while the shared event queue is full */
+constexpr auto      FINALIZE_POST_RETRY = 10ms;
+
+/**
+ * @brief                   Class template that provides a simple interface to use an HCSR04 ultrasonic sensor asynchronously
+ *
+ * @remarks                 The way the echo pulse is captured, the unit in which distances are reported and the filter applied to them are
+ *                          selected at compile-time, so that only the selected behaviour is paid for (see HCSR04 for the default selection)
+ *
+ * @tparam CapturePolicy    Class that triggers the sensor and measures the width of the returned pulse (see EchoCapture)
+ * @tparam UnitPolicy       Class that converts the width of the pulse into a distance (see HCSR04Units.h)
+ * @tparam FilterPolicy     Class that filters the distances before they are reported (see HCSR04Filters.h)
+ */
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+class BasicHCSR04 {
+
+public:
+
+    /** Type in which distances are reported */
+    using value_type = typename UnitPolicy::value_type;
+
+    /**
+     * @brief               Configuration of a burst of pings (see BasicHCSR04::do_burst_measurement())
+     */
+    struct BurstConfig {
+
+        /** Maximum number of pings in the burst (at most BURST_MAX_PINGS) */
+        uint8_t         maxPings {5};
+        /** Number of distances that must agree within the tolerance to end the burst early (0 to always send all pings) */
+        uint8_t         consistentPings {3};
+        /** Largest difference between the distances that are considered to agree */
+        value_type      tolerance {1};
+        /** Way in which the distances are combined */
+        BurstCombine    combine {BurstCombine::MEDIAN};
+        /** Time to wait between two pings, so that late echoes of the previous ping fade */
+        std::chrono::milliseconds guard {10ms};
+    };
+
+private:
+
+    /** Capture of the echo pulse of the sensor */
+    CapturePolicy   capture;
+    /** Conversion of the width of the pulse into a distance */
+    UnitPolicy      unit;
+    /** Filter applied to the distances before they are reported */
+    FilterPolicy    filter;
+    /** Distance calculated from the duration of the pulse */
+    value_type      dist {};
+    /** Outcome of the most recent measurement attempt */
+    HCSR04Status    status {HCSR04Status::OK};
+    /** Estimate of the confidence in the most recent measurement */
+    ConfidenceEstimator confidence;
+
+    /** Handle to thread used for periodically reading from the sensor */
+    Thread          *threadHandle {nullptr};
+
+    /** Queue to post measurement event on */
+    EventQueue      queue;
+    /** ID of the periodic event on the EventQueue (0 if no periodic event or failed allocation) */
+    int32_t         periodicId {0};
+    /** Number of non-periodic measurements pending in the queue */
+    uint32_t        pendingMeasurementCount {0};
+
+    /** Semaphore to block the queue dispatch thread and for graceful termination */
+    Semaphore       shouldTerminate;
+
+    /** Whether the dispatch thread is started on demand and stopped when idle (see BasicHCSR04::initialize_lazy()) */
+    bool            lazy {false};
+    /** Time without measurements after which the dispatch thread is stopped in lazy mode */
+    std::chrono::milliseconds idleTimeout {0};
+    /** Point in time at which the most recent measurement completed */
+    Kernel::Clock::time_point lastActivity {};
+    /** ID of the periodic idle check on the EventQueue (0 if not in lazy mode or no thread is running) */
+    int32_t         idleCheckId {0};
+    /** Whether the dispatch thread exited because it was idle and is waiting to be joined and freed */
+    volatile bool   dispatchIdle {false};
+    /** ID of the event on the shared event queue that frees an idle dispatch thread (0 if none is pending) */
+    int32_t         reapId {0};
+    /** Mutex to serialize starting, stopping and posting to the dispatch thread in lazy mode */
+    Mutex           lifecycleLock;
+
+    /** Smallest change of the distance that is reported in deadband mode (see BasicHCSR04::set_deadband()) */
+    value_type      deadband {};
+    /** Longest time without a report in deadband mode, 0 for no limit */
+    std::chrono::milliseconds maxSilence {0};
+    /** Whether periodic measurements are only reported when they change (deadband mode) */
+    bool            deadbandEnabled {false};
+    /** Whether a periodic measurement has been reported since periodic measurement was started */
+    bool            hasReported {false};
+    /** Whether the most recently reported periodic measurement was successful */
+    bool            lastReportedValid {false};
+    /** Distance of the most recently reported periodic measurement */
+    value_type      lastReported {};
+    /** Point in time at which the most recent periodic measurement was reported */
+    Kernel::Clock::time_point lastReportTime {};
+    /** Number of periodic measurements not reported in deadband mode */
+    uint32_t        suppressedCount {0};
+
+    /** Whether the object is being finalized asynchronously (see BasicHCSR04::finalize_async()) */
+    volatile bool   finalizing {false};
+    /** Timeout after which pending measurements are cancelled while finalizing asynchronously, then used to retry posting the completion */
+    Timeout         drainDeadline;
+    /** Callback to call once the object has been finalized asynchronously */
+    Callback<void()> finalizeCb;
+    /** Semaphore released once finalizing asynchronously has completed */
+    Semaphore       finalizeDone;
+
+public:
+
+    BasicHCSR04() = delete;
+
+    /**
+     * @brief               Construct a new BasicHCSR04 object
+     *
+     * @param   trig        Microcontroller Pin to which the Trig Pin of the sensor is connected
+     * @param   echo        Microcontroller Pin to which the Echo Pin of the sensor is connected
+     */
+    BasicHCSR04(PinName trig, PinName echo);
+
+    /**
+     * @brief               Construct a new BasicHCSR04 object by taking over the sensor of another object
+     *
+     * @remarks             The other object is finalized first, cancelling its pending measurements and stopping periodic measurement
+     * @remarks             If the other object was initialized (normally or lazily), then this object is initialized the same way
+     * @remarks             The moved-from object can only be destroyed or assigned to
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           Can not call this method from the shared event queue while the other object is being finalized asynchronously
+     *
+     * @param other         Object whose sensor is taken over
+     */
+    BasicHCSR04(BasicHCSR04 &&other);
+
+    /**
+     * @brief               Finalizes this object and takes over the sensor of another object (see BasicHCSR04::BasicHCSR04(BasicHCSR04 &&))
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           Can not call this method from the shared event queue while either object is being finalized asynchronously
+     *
+     * @param other         Object whose sensor is taken over
+     *
+     * @return              Reference to this object
+     */
+    BasicHCSR04 &operator=(BasicHCSR04 &&other);
+
+    BasicHCSR04(const BasicHCSR04 &) = delete;
+    BasicHCSR04 &operator=(const BasicHCSR04 &) = delete;
+
+    /**
+     * @brief               Destroy the BasicHCSR04 object, finalizing it first if required
+     *
+     * @remarks             Periodic measurement is stopped and pending measurements are cancelled (their callbacks are still called)
+     * @remarks             If the object is being finalized asynchronously, the destructor waits for that to complete
+     *
+     * @attention           Can not call this method from ISR context, or from the callback of BasicHCSR04::finalize_async()
+     * @attention           Can not call this method from the shared event queue (see mbed_event_queue()) while the object is being finalized
+     *                      asynchronously, as finalizing completes on that queue and the destructor would wait for itself
+     */
+    ~BasicHCSR04();
+
+    /**
+     * @brief               Initializes the object by allocating and starting a thread to dispatch callbacks on
+     *
+     * @remark              If the thread was already initialized, then the BasicHCSR04::finalize() method must be called
+     *                      before trying to re-initialize it
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully allocated and started, false otherwise
+     */
+    bool        initialize();
+
+    /**
+     * @brief               Initializes the object in lazy mode, where the thread to dispatch callbacks on is only allocated and started
+     *                      when a measurement is requested, and stopped and freed again once no measurement has happened for a while
+     *
+     * @remarks             If the object was already initialized, then the BasicHCSR04::finalize() method must be called
+     *                      before trying to re-initialize it
+     * @remarks             In lazy mode, measurements must be requested from thread context (requests from ISR context are refused),
+     *                      and the first measurement after an idle period is delayed by the time taken to start the thread
+     * @remarks             The idle thread is freed on the shared event queue (see mbed_event_queue()), so it must be dispatched
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param idleTimeout   Time without measurements after which the thread is stopped and freed
+     *
+     * @return              true if the object was put into lazy mode, false otherwise
+     */
+    bool        initialize_lazy(std::chrono::milliseconds idleTimeout);
+
+    /**
+     * @brief               Finalizes the object by stopping and freeing the thread on which callbacks are dispatched
+     *
+     * @remark              If the thread was not initialized or finalized before, then the BasicHCSR04::initialize() method must be called
+     *                      before trying to re-finalize
+     * @remark              The object can not be finalized as long as there are pending non-periodic measurements
+     * @remark              The object can not be finalized as long as there is a registered non-periodic measurement
+     * @remark              To finalize without waiting for pending measurements, see BasicHCSR04::finalize_async()
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully stopped and freed, false otherwise
+     */
+    bool        finalize();
+
+    /**
+     * @brief               Finalizes the object asynchronously, returning immediately and calling the callback once the thread has been stopped and freed
+     *
+     * @remarks             Periodic measurement is stopped, and no new measurements can be started while finalizing
+     * @remarks             Pending non-periodic measurements are completed for up to deadline, after which the remaining (and the one in progress)
+     *                      are cancelled, and their callbacks are called with a failed measurement (see HCSR04Status::CANCELLED)
+     * @remarks             A deadline of 0 cancels all pending measurements right away
+     * @remarks             The callback is always called on the shared event queue (see mbed_event_queue()), so it must be dispatched, even if
+     *                      there was nothing to wait for (lazy mode with no thread running)
+     * @remarks             If the shared event queue is full, posting to it is retried till it succeeds
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param deadline      Time for which pending measurements are allowed to complete
+     * @param cb            Callback when the object has been finalized
+     *
+     * @return              true if finalizing was started, false if the object is not initialized or already being finalized
+     */
+    bool        finalize_async(std::chrono::milliseconds deadline, const Callback<void()> &cb);
+
+    /**
+     * @brief               Checks if the object is being finalized asynchronously
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if BasicHCSR04::finalize_async() was called and the object has not been finalized yet, false otherwise
+     */
+    bool        is_finalizing() const;
+
+    /**
+     * @brief               Checks if the object was initialized and callbacks can be dispatched correctly
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @remarks             In lazy mode (see BasicHCSR04::initialize_lazy()), the object is initialized even while the thread is not running
+     *
+     * @return              true if the thread is running or the object is in lazy mode, false otherwise
+     */
+    bool        is_initialized() const;
+
+    /**
+     * @brief               Asynchronously starts a measurement from the sensor and returns immediately, calling the callback once the measurement is complete
+     *
+     * @remarks             As long as periodic measurement is started, this function will always return false
+     * @remarks             As long as a measurement (enqueued using this method) is still pending, periodic measurement can not be started
+     * @remarks             If the measurement fails, the reason can be retrieved using the BasicHCSR04::get_status() method
+     *
+     * @attention           This function can be called from ISR context, except in lazy mode (see BasicHCSR04::initialize_lazy()), where the
+     *                      thread may have to be started first, which needs thread context, so the request is refused (false is returned)
+     *
+     * @param cb            Callback when the distance is calculated
+     *                      , the first argument to the callback is a boolean value which is false if the sensor timed-out, true otherwise
+     *                      , the second argument to the callback is the distance (see BasicHCSR04::value_type)
+     *
+     * @return              true if the request to start a measurement could successfully be enqueued, false otherwise
+     */
+    bool        do_measurement(const Callback<void(bool, value_type)> &cb);
+
+    /**
+     * @brief               Get the number of pending non-periodic measurements
+     *
+     * @remarks             The object can not be finalized as long as there are pending non-periodic measurements remaining
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              Number of pending non-periodic measurements
+     */
+    uint32_t    get_pending_measurement_count() const;
+
+    /**
+     * @brief               Asynchronously measures the distance using a burst of pings and returns immediately, calling the callback once with the combined distance
+     *
+     * @remarks             Up to BurstConfig::maxPings pings are sent back to back within a single event, and the burst ends early once
+     *                      BurstConfig::consistentPings distances agree within BurstConfig::tolerance, in which case only those distances are combined
+     * @remarks             The burst also ends at the first failed ping (the sensor then backs off), the distances measured till then are still combined
+     * @remarks             The combined distance is passed through the filter policy, and the measurement fails only if no ping succeeded or the filter
+     *                      rejected the distance
+     * @remarks             The same restrictions as BasicHCSR04::do_measurement() apply, and the burst counts as a single pending measurement
+     *
+     * @attention           This function can be called from ISR context, except in lazy mode (see BasicHCSR04::do_measurement())
+     *
+     * @param config        Configuration of the burst
+     * @param cb            Callback when the distance is calculated (see BasicHCSR04::do_measurement())
+     *
+     * @return              true if the request to start the burst could successfully be enqueued, false otherwise
+     */
+    bool        do_burst_measurement(const BurstConfig &config, const Callback<void(bool, value_type)> &cb);
+
+    /**
+     * @brief               Starts periodically measuring the distance asynchronously and returns immediately
+     *
+     * @remarks             To stop periodic measurement, see the BasicHCSR04::stop_measurement_periodic() function
+     * @remarks             If a measurement fails, the reason can be retrieved using the BasicHCSR04::get_status() method
+     *
+     * @attention           This function can be called from ISR context, except in lazy mode (see BasicHCSR04::do_measurement())
+     *
+     * @param period        Time period between two measurements
+     * @param cb            Callback when the distance is calculated
+     *                      , the first argument to the callback is a boolean value which is false if the sensor timed-out, true otherwise
+     *                      , the second argument to the callback is the distance (see BasicHCSR04::value_type)
+     *
+     * @return              true if the request to start a measurement could successfully be enqueued, false otherwise
+     */
+    bool        start_measurement_periodic(std::chrono::milliseconds period, const Callback<void(bool, value_type)> &cb);
+
+    /**
+     * @brief               Stops periodically measuring the distance
+     *
+     * @attention           Can not call from ISR context
+     *
+     * @remarks             If a measurement was happening while this function was called, the measurement (along with the callback) are completed first
+     *                      , rather than instantly stopping the measurements
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void        stop_measurement_periodic();
+
+    /**
+     * @brief           Enables deadband mode, in which the callback of periodic measurement is only called when the distance changes
+     *
+     * @remarks         A periodic measurement is reported if it is the first since periodic measurement was started, if it succeeded while
+     *                  the previously reported one failed (or vice versa), if its distance differs from the previously reported one by more
+     *                  than delta, or if nothing has been reported for maxSilence, all other measurements are suppressed and counted
+     * @remarks         Non-periodic measurements are always reported
+     *
+     * @attention       Must not be called while periodic measurement is started
+     *
+     * @param delta     Smallest change of the distance that is reported
+     * @param maxSilence    Longest time without calling the callback, 0 for no limit
+     *
+     * @return          true if deadband mode was enabled, false if periodic measurement is started
+     */
+    bool        set_deadband(value_type delta, std::chrono::milliseconds maxSilence);
+
+    /**
+     * @brief           Disables deadband mode, so that every periodic measurement is reported again
+     *
+     * @attention       Must not be called while periodic measurement is started
+     *
+     * @return          true if deadband mode was disabled, false if periodic measurement is started
+     */
+    bool        clear_deadband();
+
+    /**
+     * @brief           Get the number of periodic measurements that were not reported in deadband mode
+     *
+     * @attention       This function can be called from ISR context
+     *
+     * @return          Number of suppressed measurements
+     */
+    uint32_t    get_suppressed_count() const;
+
+    /**
+     * @brief           Checks if periodic measurement was started
+     *
+     * @attention       This function can be called from ISR context
+     *
+     * @return          true if periodic measurement is started, false otherwise
+     */
+    bool        is_periodic_started() const;
+
+    /**
+     * @brief           Get the outcome of the most recent measurement attempt
+     *
+     * @remarks         After a fault (HCSR04Status::STUCK_LOW or HCSR04Status::STUCK_HIGH), the sensor is not pinged again
+     *                  until an exponentially growing back-off period has passed, and measurements requested in the meantime
+     *                  fail immediately with HCSR04Status::BACKOFF
+     *
+     * @attention       This function can be called from ISR context
+     *
+     * @return          Status of the most recent measurement attempt
+     */
+    HCSR04Status get_status() const;
+
+    /**
+     * @brief           Get the confidence in the most recent measurement (see ConfidenceEstimator)
+     *
+     * @remarks         The confidence combines the rate of recent timeouts and faults, the plausibility of the width of the echo pulse and
+     *                  the consistency of the pulse with recent ones, and is computed before the filter policy is applied
+     * @remarks         Call this from the callback of the measurement, as the next measurement replaces it
+     *
+     * @attention       This function can be called from ISR context
+     *
+     * @return          Confidence between 0 and 1 (0 for a failed measurement)
+     */
+    float       get_confidence() const;
+
+    /**
+     * @brief           Get the filter policy, for example to configure it
+     *
+     * @attention       The filter must not be modified while measurements are in progress
+     *
+     * @return          Reference to the filter policy
+     */
+    FilterPolicy &get_filter();
+
+    /**
+     * @brief           Get the capture policy, for example to record its timings (see EchoCapture::set_recorder())
+     *
+     * @attention       The capture must not be modified while measurements are in progress
+     *
+     * @return          Reference to the capture policy
+     */
+    CapturePolicy &get_capture();
+
+    /**
+     * @brief           Updates the temperature (and optionally humidity) of the air, to compensate the speed of sound used to calculate distances
+     *
+     * @remarks         The speed of sound is calculated using speed_of_sound(), and the resulting scale factor is precomputed by the unit policy,
+     *                  so that each measurement only costs a multiplication
+     * @remarks         Intended to be called by the application whenever its temperature source (for example, another sensor) has a new reading
+     *
+     * @attention       This function can be called from ISR context, and while measurements are in progress
+     *
+     * @param celsius           Temperature of the air in degrees Celsius
+     * @param relativeHumidity  Relative humidity of the air in percent (0 to 100)
+     */
+    void        set_temperature(float celsius, float relativeHumidity = 0.0f);
+
+    /**
+     * @brief           Updates the speed of sound used to calculate distances directly (see BasicHCSR04::set_temperature())
+     *
+     * @attention       This function can be called from ISR context, and while measurements are in progress
+     *
+     * @param metresPerSecond   Speed of sound in metres per second
+     */
+    void        set_speed_of_sound(float metresPerSecond);
+
+    /**
+     * @brief           Get the number of times a storm of edges was detected on the echo line
+     *
+     * @remarks         When a storm is detected, the interrupt on the echo line is disabled and the measurement fails with
+     *                  HCSR04Status::EDGE_STORM, the interrupt is re-enabled once the resulting back-off has passed
+     *
+     * @attention       This function can be called from ISR context
+     *
+     * @return          Number of edge storms detected
+     */
+    uint32_t    get_edge_storm_count() const;
+
+private:
+
+    /**
+     * @brief           Pings the sensor (unless it is backing off) and waits for the returned pulse
+     *
+     * @remarks         The distance is converted using the unit policy and passed through the filter policy, and is stored in dist if the
+     *                  measurement was successful and the filter accepted it
+     *
+     * @return          true if the distance was measured successfully, false otherwise
+     */
+    bool        measure();
+
+    /**
+     * @brief           Sends a burst of pings and combines their distances (see BasicHCSR04::do_burst_measurement())
+     *
+     * @remarks         The combined distance is passed through the filter policy, and is stored in dist if the burst was successful
+     *
+     * @param config    Configuration of the burst
+     *
+     * @return          true if the distance was measured successfully, false otherwise
+     */
+    bool        measure_burst(const BurstConfig &config);
+
+    /**
+     * @brief           Decides whether a periodic measurement is reported, and counts it as suppressed otherwise (see BasicHCSR04::set_deadband())
+     *
+     * @param valid     Whether the measurement was successful (the distance is taken from dist)
+     *
+     * @return          true if the callback should be called, false otherwise
+     */
+    bool        should_report(bool valid);
+
+    /**
+     * @brief           Helper function to allocate and start the thread to dispatch callbacks on
+     *
+     * @return          true if the thread was successfully allocated and started, false otherwise
+     */
+    bool        start_dispatch();
+
+    /**
+     * @brief           Helper function to make sure that the dispatch thread is running in lazy mode
+     *
+     * @remarks         Frees the thread if it exited due to being idle, and starts a new one if required
+     * @remarks         Must be called with lifecycleLock held
+     *
+     * @return          true if the thread is running, false otherwise
+     */
+    bool        ensure_dispatch();
+
+    /**
+     * @brief           Periodic check (in lazy mode) that stops the dispatch thread once it has been idle for long enough
+     */
+    void        check_idle();
+
+    /**
+     * @brief           Joins and frees a dispatch thread that exited due to being idle, called on the shared event queue
+     */
+    void        reap_idle_dispatch();
+
+    /**
+     * @brief           Finalizes the object regardless of its state, cancelling pending measurements and stopping periodic measurement
+     *
+     * @remarks         Waits for an asynchronous finalize in progress to complete
+     */
+    void        shutdown();
+
+    /**
+     * @brief           Takes over the sensor, configuration and initialization state of another object, which is shut down first
+     *
+     * @remarks         This object must be shut down (or freshly constructed) before calling this method
+     *
+     * @param other     Object whose sensor is taken over
+     */
+    void        take_over(BasicHCSR04 &other);
+
+    /**
+     * @brief           Cancels pending and in-flight measurements, called when the deadline to finalize passes
+     *
+     * @attention       This function can be called from ISR context
+     */
+    void        abort_pending();
+
+    /**
+     * @brief           Queued behind all pending measurements when finalizing asynchronously, prepares the thread for graceful termination
+     */
+    void        drain_complete();
+
+    /**
+     * @brief           Posts BasicHCSR04::complete_finalize() to the shared event queue, and retries after FINALIZE_POST_RETRY if the queue is full
+     *
+     * @attention       This function can be called from ISR context
+     */
+    void        post_complete_finalize();
+
+    /**
+     * @brief           Joins and frees the dispatch thread (if any) after finalizing asynchronously and calls the callback, called on the shared event queue
+     */
+    void        complete_finalize();
+
+    /**
+     * @brief           Helper function to atomically increment the count of pending measurements
+     *
+     * @todo            Make this function atomic
+     */
+    __attribute__((always_inline))
+    void        inc_pending_measurements();
+
+    /**
+     * @brief           Helper function to atomically decrement the count of pending measurements
+     *
+     * @todo            Make this function atomic
+     */
+    __attribute__((always_inline))
+    void        dec_pending_measurements();
+
+    /**
+     * @brief           Function for queue to run callbacks on
+     *
+     * @remarks         Calling break_dispatch() on the queue without acquiring shouldTerminate will cancel
+     *                  the registered periodic event (if at all) and dispatch the queue again
+     *
+     * @remarks         Calling break_dispatch() on the queue after acquiring shouldTerminate will cancel
+     *                  the registered periodic event (if at all) and prepare the thread for graceful termination
+     *
+     * @remarks         In lazy mode, the thread also terminates once BasicHCSR04::check_idle() finds it idle
+     */
+    void        dispatch_events();
+};
+
+// Constructors
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::BasicHCSR04(PinName trig, PinName echo)
+        : capture(trig, echo)
+        , shouldTerminate(1, 1)
+        , finalizeDone(0, 1)
+{
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::BasicHCSR04(BasicHCSR04 &&other)
+        : shouldTerminate(1, 1)
+        , finalizeDone(0, 1)
+{
+
+    take_over(other);
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy> &
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::operator=(BasicHCSR04 &&other) {
+
+    // finalize this object before taking over the sensor of the other one
+
+    if (this != &other) {
+
+        shutdown();
+        take_over(other);
+    }
+
+    return *this;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::~BasicHCSR04() {
+
+    shutdown();
+}
+
+// Public Methods
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::initialize() {
+
+    // return if the thread was already initialized; move forward otherwise
+    // allocate and start the thread
+
+    if (is_initialized()) {
+        return false;
+    }
+
+    return start_dispatch();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::initialize_lazy(std::chrono::milliseconds idleTimeout) {
+
+    // return if the thread was already initialized; move forward otherwise
+    // only remember the idle timeout, the thread is started by the first measurement
+
+    if (is_initialized()) {
+        return false;
+    }
+
+    lazy                = true;
+    this->idleTimeout   = idleTimeout;
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::finalize() {
+
+    // return if the thread was not initialized, is being finalized asynchronously, or there are pending non-periodic measurements or a periodic measurement; move forward otherwise
+    // if the thread is running, break the dispatch after acquiring shouldTerminate to gracefully terminate it
+    // if the thread already exited due to being idle (lazy mode), it only needs to be joined
+    // finally, free the thread and cancel freeing it on the shared event queue (if pending)
+
+    if (!is_initialized() || finalizing || is_periodic_started() || get_pending_measurement_count() > 0) {
+        return false;
+    }
+
+    lifecycleLock.lock();
+
+    if (threadHandle != nullptr) {
+
+        if (!dispatchIdle) {
+
+            shouldTerminate.acquire();
+            queue.break_dispatch();
+            threadHandle->join();
+            shouldTerminate.release();
+        }
+        else {
+            threadHandle->join();
+        }
+
+        delete threadHandle;
+        threadHandle = nullptr;
+    }
+
+    if (reapId != 0) {
+
+        mbed_event_queue()->cancel(reapId);
+        reapId = 0;
+    }
+
+    dispatchIdle    = false;
+    lazy            = false;
+
+    lifecycleLock.unlock();
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::finalize_async(std::chrono::milliseconds deadline, const Callback<void()> &cb) {
+
+    // return if the object was not initialized or is already being finalized; move forward otherwise
+    // drain a stale release of finalizeDone, so that it is only released by the completion of this finalize
+    //
+    // if the thread is not running (lazy mode), there is nothing to wait for, so post the completion to the shared event queue right away
+    // that way the callback is called on the shared event queue in every case, as documented
+    //
+    // otherwise, queue an event behind all pending measurements, which prepares the thread for termination once they are done
+    // stop the periodic measurement (if any), and cancel the pending measurements right away or once the deadline passes
+
+    if (!is_initialized() || finalizing) {
+        return false;
+    }
+
+    finalizeDone.try_acquire();
+
+    finalizing = true;
+    finalizeCb = cb;
+
+    if (threadHandle == nullptr || dispatchIdle) {
+
+        stop_measurement_periodic();
+        post_complete_finalize();
+
+        return true;
+    }
+
+    if (queue.call(this, &BasicHCSR04::drain_complete) == 0) {
+
+        finalizing = false;
+        finalizeCb = nullptr;
+
+        return false;
+    }
+
+    stop_measurement_periodic();
+
+    if (deadline == 0ms) {
+        abort_pending();
+    }
+    else {
+        drainDeadline.attach(callback(this, &BasicHCSR04::abort_pending), deadline);
+    }
+
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::is_finalizing() const {
+
+    return finalizing;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::is_initialized() const {
+
+    // if threadHandle is NULL and the object is not in lazy mode, then the object was not initialized/finalized before
+    // otherwise it is still in the initialized state
+
+    return threadHandle != nullptr || lazy;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::do_measurement(const Callback<void(bool, value_type)> &cb) {
+
+    // return if a periodic event is already registered or the object is being finalized; move forward otherwise
+    // in lazy mode, make sure that the thread is running and hold the lock till the event is posted, so that it can not become idle in between
+    // otherwise, post a non-periodic event to the queue, where the distance is measured and the callback called
+    // increment the pending measurement count if the event was successfully posted
+
+    if (is_periodic_started() || finalizing) {
+        return false;
+    }
+
+    if (lazy) {
+
+        if (core_util_is_isr_active()) {
+            return false;
+        }
+
+        lifecycleLock.lock();
+        if (!ensure_dispatch()) {
+
+            lifecycleLock.unlock();
+            return false;
+        }
+    }
+
+    auto id = queue.call([this, cb]() {
+
+        measure()
+        ? cb(true, dist)
+        : cb(false, value_type {});
+
+        dec_pending_measurements();
+    });
+
+    if (id != 0) {
+        inc_pending_measurements();
+    }
+
+    if (lazy) {
+        lifecycleLock.unlock();
+    }
+
+    return id != 0;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+uint32_t
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::get_pending_measurement_count() const {
+
+    return pendingMeasurementCount;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::do_burst_measurement(const BurstConfig &config, const Callback<void(bool, value_type)> &cb) {
+
+    // same as BasicHCSR04::do_measurement(), except that the event sends the whole burst
+
+    if (is_periodic_started() || finalizing || config.maxPings == 0 || config.maxPings > BURST_MAX_PINGS) {
+        return false;
+    }
+
+    if (lazy) {
+
+        if (core_util_is_isr_active()) {
+            return false;
+        }
+
+        lifecycleLock.lock();
+        if (!ensure_dispatch()) {
+
+            lifecycleLock.unlock();
+            return false;
+        }
+    }
+
+    auto id = queue.call([this, config, cb]() {
+
+        measure_burst(config)
+        ? cb(true, dist)
+        : cb(false, value_type {});
+
+        dec_pending_measurements();
+    });
+
+    if (id != 0) {
+        inc_pending_measurements();
+    }
+
+    if (lazy) {
+        lifecycleLock.unlock();
+    }
+
+    return id != 0;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::start_measurement_periodic(std::chrono::milliseconds period, const Callback<void(bool, value_type)> &cb) {
+
+    // return if a periodic measurement is already started, the object is being finalized, or if there are pending non-periodic measurements; move forward otherwise
+    // otherwise, post a periodic event to the queue, where the distance is measured and the callback called (unless suppressed in deadband mode)
+    // the first periodic measurement is always reported
+
+    if (is_periodic_started() || finalizing || get_pending_measurement_count() > 0) {
+        return false;
+    }
+
+    if (lazy) {
+
+        if (core_util_is_isr_active()) {
+            return false;
+        }
+
+        lifecycleLock.lock();
+        if (!ensure_dispatch()) {
+
+            lifecycleLock.unlock();
+            return false;
+        }
+    }
+
+    hasReported = false;
+
+    auto id = queue.call_every(period, [this, cb] {
+
+        bool valid = measure();
+
+        if (!should_report(valid)) {
+            return;
+        }
+
+        valid
+        ? cb(true, dist)
+        : cb(false, value_type {});
+    });
+
+    periodicId = id;
+
+    if (lazy) {
+        lifecycleLock.unlock();
+    }
+
+    return periodicId != 0;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::stop_measurement_periodic() {
+
+    // return if no periodic measurement was registered; move forward otherwise
+    // if the thread is not running, directly cancel the event and move forward
+    // otherwise, break the dispatch without acquiring shouldTerminate to cancel the event in the other thread
+
+    // because periodic and non-periodic measurements are exclusive, this method can never break pending non-periodic measurements
+
+    if (!is_periodic_started()) {
+        return;
+    }
+
+    if (threadHandle == nullptr) {
+
+        queue.cancel(periodicId);
+        periodicId = 0;
+
+        return;
+    }
+
+    queue.break_dispatch();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::set_deadband(value_type delta, std::chrono::milliseconds maxSilence) {
+
+    if (is_periodic_started()) {
+        return false;
+    }
+
+    deadband            = delta;
+    this->maxSilence    = maxSilence;
+    deadbandEnabled     = true;
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::clear_deadband() {
+
+    if (is_periodic_started()) {
+        return false;
+    }
+
+    deadbandEnabled = false;
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+uint32_t
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::get_suppressed_count() const {
+
+    return suppressedCount;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::is_periodic_started() const {
+
+    // if a periodic event was started, then it will have non-zero ID in the queue
+
+    return (periodicId != 0);
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+HCSR04Status
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::get_status() const {
+
+    return status;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+float
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::get_confidence() const {
+
+    return confidence.get();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+FilterPolicy &
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::get_filter() {
+
+    return filter;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+CapturePolicy &
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::get_capture() {
+
+    return capture;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::set_temperature(float celsius, float relativeHumidity) {
+
+    unit.set_speed_of_sound(speed_of_sound(celsius, relativeHumidity));
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::set_speed_of_sound(float metresPerSecond) {
+
+    unit.set_speed_of_sound(metresPerSecond);
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+uint32_t
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::get_edge_storm_count() const {
+
+    return capture.get_edge_storm_count();
+}
+
+// Private methods
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::measure() {
+
+    // note the time of the measurement, so that the thread is not considered idle in lazy mode
+    // capture the returned pulse, update the confidence and convert its width into a distance
+    // pass the distance through the filter, which may replace it or reject it
+
+    uint32_t    pulse;
+    value_type  value;
+
+    lastActivity = Kernel::Clock::now();
+
+    status = capture.capture(&pulse);
+    if (status != HCSR04Status::OK) {
+
+        confidence.on_failure();
+        return false;
+    }
+
+    confidence.on_pulse(pulse);
+    value = unit.from_pulse(pulse);
+    if (!filter.apply(&value)) {
+
+        status = HCSR04Status::REJECTED;
+        return false;
+    }
+
+    dist = value;
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::measure_burst(const BurstConfig &config) {
+
+    // ping the sensor till the burst is complete, waiting for the guard time between two pings, and stop at the first failed ping
+    // the confidence is updated with every ping, so that it reflects the last one
+    // keep the distances sorted (insertion, as there are only a few), so that agreeing distances are always next to each other
+    // after each ping, look for consistentPings neighbouring distances within the tolerance, and end the burst early if found
+    //
+    // combine the agreeing distances if the burst ended early, all distances otherwise
+    // finally, pass the combined distance through the filter, which may replace it or reject it
+
+    value_type  sorted[BURST_MAX_PINGS];
+    uint8_t     count;
+    uint8_t     first;
+    uint8_t     last;
+    uint32_t    pulse;
+    value_type  value;
+
+    count   = 0;
+    first   = 0;
+    last    = 0;
+
+    lastActivity = Kernel::Clock::now();
+
+    for (uint8_t ping = 0; ping < config.maxPings; ++ping) {
+
+        if (ping > 0) {
+            ThisThread::sleep_for(config.guard);
+        }
+
+        status = capture.capture(&pulse);
+        if (status != HCSR04Status::OK) {
+
+            confidence.on_failure();
+            break;
+        }
+
+        confidence.on_pulse(pulse);
+        value = unit.from_pulse(pulse);
+
+        uint8_t j;
+        for (j = count; j > 0 && sorted[j - 1] > value; --j) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = value;
+        ++count;
+
+        last = count;
+
+        if (config.consistentPings == 0 || count < config.consistentPings) {
+            continue;
+        }
+
+        bool consistent = false;
+        for (first = 0; first + config.consistentPings <= count; ++first) {
+
+            if (sorted[first + config.consistentPings - 1] - sorted[first] <= config.tolerance) {
+
+                consistent = true;
+                break;
+            }
+        }
+
+        if (consistent) {
+
+            last = first + config.consistentPings;
+            break;
+        }
+        first = 0;
+    }
+
+    lastActivity = Kernel::Clock::now();
+
+    if (count == 0) {
+        return false;
+    }
+
+    if (config.combine == BurstCombine::MEDIAN) {
+        value = sorted[first + (last - first) / 2];
+    }
+    else {
+
+        uint8_t     trim;
+        value_type  sum {};
+
+        trim = (last - first) / 4;
+        for (uint8_t i = first + trim; i < last - trim; ++i) {
+            sum += sorted[i];
+        }
+        value = sum / (value_type)(last - first - 2 * trim);
+    }
+
+    status = HCSR04Status::OK;
+    if (!filter.apply(&value)) {
+
+        status = HCSR04Status::REJECTED;
+        return false;
+    }
+
+    dist = value;
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::should_report(bool valid) {
+
+    // report everything if deadband mode is disabled
+    // report the first measurement, a change of validity, a change of the distance by more than the deadband, or the end of the silence
+    // the difference is taken in the order that can not underflow, as the distance may be unsigned
+    // remember what was reported, so that later changes are measured against it (not against suppressed measurements, which would let slow drifts through unnoticed)
+
+    Kernel::Clock::time_point   now;
+    bool                        report;
+
+    if (!deadbandEnabled) {
+        return true;
+    }
+
+    now     = Kernel::Clock::now();
+    report  = !hasReported || valid != lastReportedValid || (maxSilence != 0ms && now - lastReportTime >= maxSilence);
+
+    if (!report && valid) {
+        report = (dist > lastReported) ? (dist - lastReported > deadband) : (lastReported - dist > deadband);
+    }
+
+    if (!report) {
+
+        ++suppressedCount;
+        return false;
+    }
+
+    hasReported         = true;
+    lastReportedValid   = valid;
+    lastReported        = valid ? dist : value_type {};
+    lastReportTime      = now;
+
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::start_dispatch() {
+
+    // allocate the thread and return if the allocation fails; move forward otherwise
+    // in lazy mode, register the periodic idle check, and return if that fails; move forward otherwise
+    // try to start the thread and return if successful
+    // in case of failure, cancel the idle check, delete the allocated thread and return
+
+    threadHandle = new (std::nothrow) Thread(osPriorityRealtime);
+    if (threadHandle == nullptr) {
+        return false;
+    }
+
+    if (lazy) {
+
+        lastActivity    = Kernel::Clock::now();
+        idleCheckId     = queue.call_every(idleTimeout, this, &BasicHCSR04::check_idle);
+
+        if (idleCheckId == 0) {
+
+            delete threadHandle;
+            threadHandle = nullptr;
+
+            return false;
+        }
+    }
+
+    auto status = threadHandle->start(callback(this, &BasicHCSR04::dispatch_events));
+    if (status != osOK) {
+
+        if (idleCheckId != 0) {
+
+            queue.cancel(idleCheckId);
+            idleCheckId = 0;
+        }
+
+        delete threadHandle;
+        threadHandle = nullptr;
+
+        return false;
+    }
+
+    return true;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+bool
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::ensure_dispatch() {
+
+    // if the thread exited due to being idle, join and free it right away instead of waiting for the shared event queue
+    // the event on the shared event queue is cancelled, if it is already running it finds nothing to free
+    // start a new thread if none is running
+
+    if (dispatchIdle) {
+
+        threadHandle->join();
+
+        delete threadHandle;
+        threadHandle = nullptr;
+        dispatchIdle = false;
+
+        if (reapId != 0) {
+
+            mbed_event_queue()->cancel(reapId);
+            reapId = 0;
+        }
+    }
+
+    if (threadHandle != nullptr) {
+        return true;
+    }
+
+    return start_dispatch();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::check_idle() {
+
+    // only try to take the lock, as the thread holding it may be waiting to join this one (finalizing)
+    // if the object is not being finalized, no measurement is pending or periodic, and none has happened for the idle timeout, break the dispatch to let the thread exit
+
+    if (!lifecycleLock.trylock()) {
+        return;
+    }
+
+    if (!finalizing && get_pending_measurement_count() == 0 && !is_periodic_started() && Kernel::Clock::now() - lastActivity >= idleTimeout) {
+
+        dispatchIdle = true;
+        queue.break_dispatch();
+    }
+
+    lifecycleLock.unlock();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::shutdown() {
+
+    // if the object is being finalized asynchronously, hurry it up and wait for it to complete, as it still refers to this object
+    // finalizeDone is released by BasicHCSR04::complete_finalize() on the shared event queue, so this must not run on that queue
+    // return if the object is not initialized; move forward otherwise
+    //
+    // stop the periodic measurement (if any), and cancel the pending measurements
+    // if the thread is running, wait for the cancelled measurements to drain (their callbacks are still called) by queueing an event behind them
+    // then terminate the thread the same way as BasicHCSR04::finalize(), which also frees a thread that exited due to being idle
+
+    if (finalizing) {
+
+        abort_pending();
+        finalizeDone.acquire();
+    }
+
+    if (!is_initialized()) {
+        return;
+    }
+
+    stop_measurement_periodic();
+
+    lifecycleLock.lock();
+
+    if (threadHandle != nullptr) {
+
+        if (!dispatchIdle) {
+
+            Semaphore drained(0, 1);
+
+            abort_pending();
+            if (queue.call([&drained]() { drained.release(); }) != 0) {
+                drained.acquire();
+            }
+
+            shouldTerminate.acquire();
+            queue.break_dispatch();
+            threadHandle->join();
+            shouldTerminate.release();
+        }
+        else {
+            threadHandle->join();
+        }
+
+        delete threadHandle;
+        threadHandle = nullptr;
+    }
+
+    if (reapId != 0) {
+
+        mbed_event_queue()->cancel(reapId);
+        reapId = 0;
+    }
+
+    dispatchIdle    = false;
+    lazy            = false;
+
+    capture.resume();
+
+    lifecycleLock.unlock();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::take_over(BasicHCSR04 &other) {
+
+    // remember how the other object was initialized and shut it down, so that its thread no longer uses the sensor
+    // take over the capture of the sensor along with its configuration
+    // finally, initialize this object the same way as the other one was
+
+    bool        wasInitialized;
+    bool        wasLazy;
+
+    wasInitialized  = other.is_initialized();
+    wasLazy         = other.lazy;
+
+    other.shutdown();
+
+    capture         = std::move(other.capture);
+    unit            = other.unit;
+    filter          = other.filter;
+    dist            = other.dist;
+    status          = other.status;
+    confidence      = other.confidence;
+    deadband        = other.deadband;
+    maxSilence      = other.maxSilence;
+    deadbandEnabled = other.deadbandEnabled;
+    suppressedCount = other.suppressedCount;
+    idleTimeout     = other.idleTimeout;
+
+    if (wasInitialized) {
+        wasLazy ? initialize_lazy(idleTimeout) : initialize();
+    }
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::abort_pending() {
+
+    // make pending measurements fail right away, and wake up the one in progress (if any)
+
+    capture.cancel();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::drain_complete() {
+
+    // all measurements queued before finalizing started have completed (or been cancelled) by the time this runs
+    // stop the deadline, as nothing is left to cancel and the timeout is reused to retry posting the completion
+    // break the dispatch after acquiring shouldTerminate to terminate the thread, it is released again once the thread is joined
+    // the thread can not join itself, so that is done on the shared event queue
+
+    drainDeadline.detach();
+
+    shouldTerminate.acquire();
+    queue.break_dispatch();
+
+    post_complete_finalize();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::post_complete_finalize() {
+
+    // if the shared event queue is full, try again shortly from the timeout, so that no thread is blocked while the queue drains
+    // finalizing is only cleared by BasicHCSR04::complete_finalize(), so it must eventually be posted
+
+    if (mbed_event_queue()->call(this, &BasicHCSR04::complete_finalize) == 0) {
+        drainDeadline.attach(callback(this, &BasicHCSR04::post_complete_finalize), FINALIZE_POST_RETRY);
+    }
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::complete_finalize() {
+
+    // join and free the thread (if any), and leave lazy mode (if enabled)
+    // a thread terminated by BasicHCSR04::drain_complete() holds shouldTerminate, which is released once it is joined
+    // in lazy mode, the thread may never have been started or may have exited due to being idle, which is freed here instead of on the reap event
+    // reset the flags so that the object can be initialized again, and wake up BasicHCSR04::shutdown() if it is waiting
+    // finally, call the callback
+
+    Callback<void()> cb;
+
+    lifecycleLock.lock();
+
+    if (threadHandle != nullptr) {
+
+        threadHandle->join();
+        if (!dispatchIdle) {
+            shouldTerminate.release();
+        }
+
+        delete threadHandle;
+        threadHandle = nullptr;
+    }
+
+    if (reapId != 0) {
+
+        mbed_event_queue()->cancel(reapId);
+        reapId = 0;
+    }
+
+    dispatchIdle    = false;
+    lazy            = false;
+
+    lifecycleLock.unlock();
+
+    cb              = finalizeCb;
+    finalizeCb      = nullptr;
+    finalizing      = false;
+
+    capture.resume();
+    finalizeDone.release();
+
+    if (cb) {
+        cb();
+    }
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::reap_idle_dispatch() {
+
+    // the thread may already have been freed (by a new measurement or finalizing) before this event ran
+    // joining first guarantees that the thread has finished writing reapId
+
+    lifecycleLock.lock();
+
+    if (dispatchIdle && threadHandle != nullptr) {
+
+        threadHandle->join();
+
+        delete threadHandle;
+        threadHandle = nullptr;
+        dispatchIdle = false;
+        reapId       = 0;
+    }
+
+    lifecycleLock.unlock();
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+__attribute__((always_inline))
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::inc_pending_measurements() {
+    ++pendingMeasurementCount;
+}
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+__attribute__((always_inline))
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::dec_pending_measurements() {
+    --pendingMeasurementCount;
+}
+
+
+template <typename CapturePolicy, typename UnitPolicy, typename FilterPolicy>
+void
+BasicHCSR04<CapturePolicy, UnitPolicy, FilterPolicy>::dispatch_events() {
+
+    // keep dispatching the queue in an infinite loop
+    //
+    // if break_dispatch is called without acquiring shouldTerminate,
+    // the periodic event is cancelled (if registered) and the queue is dispatched again
+    //
+    // if break_dispatch is called after acquiring shouldTerminate,
+    // the periodic event is cancelled (if registered) and the thread is prepared for graceful termination
+
+    //
+    // if break_dispatch is called by BasicHCSR04::check_idle() (lazy mode), the thread terminates and has itself freed on the shared event queue
+
+    for (;;) {
+
+        queue.dispatch_forever();
+
+        if (periodicId != 0) {
+
+            queue.cancel(periodicId);
+            periodicId = 0;
+        }
+
+        if (dispatchIdle) {
+            break;
+        }
+
+        if (!shouldTerminate.try_acquire()) {
+            break;
+        }
+        shouldTerminate.release();
+    }
+
+    if (idleCheckId != 0) {
+
+        queue.cancel(idleCheckId);
+        idleCheckId = 0;
+    }
+
+    if (dispatchIdle) {
+        reapId = mbed_event_queue()->call(this, &BasicHCSR04::reap_idle_dispatch);
+    }
+}
+
+#endif //__BASICHCSR04_H__
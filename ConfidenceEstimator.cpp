@@ -0,0 +1,81 @@
+#include "ConfidenceEstimator.h"
+
+/** Weight of each measurement in the moving average of the failure rate (the rate reflects roughly the last 8 measurements) */
+constexpr float     FAILURE_RATE_WEIGHT     = 0.125f;
+/** Weight of each pulse in the moving averages of the history (the history reflects roughly the last 4 pulses) */
+constexpr float     HISTORY_WEIGHT          = 0.25f;
+/** Smallest deviation considered normal (about 1cm), so that a perfectly steady history does not make every small change inconsistent */
+constexpr float     MIN_DEVIATION_US        = 58.0f;
+
+// Constructors
+
+ConfidenceEstimator::ConfidenceEstimator(uint32_t minPulseUs, uint32_t maxPulseUs)
+        : minPulseUs(minPulseUs)
+        , maxPulseUs(maxPulseUs)
+{
+}
+
+// Public Methods
+
+float
+ConfidenceEstimator::on_pulse(uint32_t pulseUs) {
+
+    // decay the failure rate, as this measurement succeeded
+    // a pulse outside the range of the sensor is not plausible (for example, the long pulse of a sensor that heard no echo)
+    // compare the deviation of the pulse from recent history against the typical deviation, the first pulse has no history and is only half as consistent
+    // finally, add the pulse to the history
+
+    float   plausibility;
+    float   consistency;
+    float   deviation;
+    float   scale;
+
+    failureRate -= failureRate * FAILURE_RATE_WEIGHT;
+
+    plausibility = (pulseUs >= minPulseUs && pulseUs <= maxPulseUs) ? 1.0f : 0.0f;
+
+    if (!primed) {
+
+        meanPulse       = pulseUs;
+        meanDeviation   = 0;
+        primed          = true;
+        consistency     = 0.5f;
+    }
+    else {
+
+        deviation   = (pulseUs > meanPulse) ? pulseUs - meanPulse : meanPulse - pulseUs;
+        scale       = 2 * meanDeviation + MIN_DEVIATION_US;
+        consistency = scale / (scale + deviation);
+
+        meanPulse      += (pulseUs - meanPulse) * HISTORY_WEIGHT;
+        meanDeviation  += (deviation - meanDeviation) * HISTORY_WEIGHT;
+    }
+
+    confidence = (1.0f - failureRate) * plausibility * consistency;
+    return confidence;
+}
+
+float
+ConfidenceEstimator::on_failure() {
+
+    failureRate    += (1.0f - failureRate) * FAILURE_RATE_WEIGHT;
+    confidence      = 0;
+
+    return confidence;
+}
+
+float
+ConfidenceEstimator::get() const {
+
+    return confidence;
+}
+
+void
+ConfidenceEstimator::reset() {
+
+    failureRate     = 0;
+    meanPulse       = 0;
+    meanDeviation   = 0;
+    primed          = false;
+    confidence      = 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file                    ConfidenceEstimator.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Estimate of the confidence in each measurement of an HCSR04 sensor
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __CONFIDENCEESTIMATOR_H__
+#define __CONFIDENCEESTIMATOR_H__
+
+#include <cstdint>
+
+/** Width of the echo pulse for the shortest distance the sensor can measure (about 2cm) in microseconds */
+constexpr uint32_t  CONFIDENCE_MIN_PULSE_US     = 116;
+/** Width of the echo pulse for the longest distance the sensor can measure (about 4m) in microseconds */
+constexpr uint32_t  CONFIDENCE_MAX_PULSE_US     = 23'200;
+
+/**
+ * @brief                   Class that estimates the confidence (between 0 and 1) in each measurement of a sensor
+ *
+ * @remarks                 The confidence is the product of three factors -
+ *                          the rate of recent successful measurements (an exponential moving average, so recent timeouts and faults lower it),
+ *                          the plausibility of the width of the echo pulse (0 outside the range the sensor can measure, 1 inside it) and
+ *                          the consistency of the pulse with recent history (1 if it matches the moving average of recent pulses, decreasing
+ *                          as its deviation grows relative to the moving average of recent deviations)
+ * @remarks                 Works on the width of the pulse, so it does not depend on the unit in which distances are reported
+ * @remarks                 Each update takes constant time and memory, and the class does not depend on MBed OS
+ */
+class ConfidenceEstimator {
+
+    /** Width of the shortest plausible pulse in microseconds */
+    uint32_t        minPulseUs;
+    /** Width of the longest plausible pulse in microseconds */
+    uint32_t        maxPulseUs;
+
+    /** Moving average of the rate of failed measurements */
+    float           failureRate {0};
+    /** Moving average of the width of recent pulses */
+    float           meanPulse {0};
+    /** Moving average of the absolute deviation of recent pulses from meanPulse */
+    float           meanDeviation {0};
+    /** Whether a pulse has been received since the last reset (the history is empty otherwise) */
+    bool            primed {false};
+
+    /** Confidence in the most recent measurement */
+    float           confidence {0};
+
+public:
+
+    /**
+     * @brief               Construct a new ConfidenceEstimator object
+     *
+     * @param minPulseUs    Width of the shortest plausible pulse in microseconds
+     * @param maxPulseUs    Width of the longest plausible pulse in microseconds
+     */
+    explicit ConfidenceEstimator(uint32_t minPulseUs = CONFIDENCE_MIN_PULSE_US, uint32_t maxPulseUs = CONFIDENCE_MAX_PULSE_US);
+
+    /**
+     * @brief               Updates the estimate with a successfully received pulse
+     *
+     * @param pulseUs       Width of the pulse in microseconds
+     *
+     * @return              Confidence in the measurement (between 0 and 1)
+     */
+    float           on_pulse(uint32_t pulseUs);
+
+    /**
+     * @brief               Updates the estimate with a failed measurement (timeout or fault)
+     *
+     * @return              Confidence in the measurement (always 0)
+     */
+    float           on_failure();
+
+    /**
+     * @brief               Get the confidence in the most recent measurement
+     *
+     * @return              Confidence (between 0 and 1, 0 if no measurement was made)
+     */
+    float           get() const;
+
+    /**
+     * @brief               Discards the history of measurements
+     */
+    void            reset();
+};
+
+#endif //__CONFIDENCEESTIMATOR_H__
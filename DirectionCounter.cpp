@@ -0,0 +1,99 @@
+#include "DirectionCounter.h"
+
+// Constructors
+
+DirectionCounter::DirectionCounter(float blockDistance, uint32_t maxCrossingMs)
+        : blockDistance(blockDistance)
+        , maxCrossingMs(maxCrossingMs)
+{
+}
+
+// Public Methods
+
+CrossingEvent
+DirectionCounter::add(uint8_t sensor, uint32_t timeMs, bool valid, float value) {
+
+    // update the beam of the sensor
+    // while idle, an interrupted beam starts a crossing, remembering which beam it was
+    // while crossing, note if both beams are interrupted, and abandon the crossing if it takes too long
+    // once both beams are clear, the crossing is complete, count it if the beams overlapped and the last one to clear (this one) is not the first one
+    // after abandoning a crossing, wait for both beams to be clear before starting the next one
+
+    CrossingEvent event = CrossingEvent::NONE;
+
+    blocked[sensor] = valid && value < blockDistance;
+
+    switch (state) {
+
+    case State::IDLE:
+
+        if (blocked[sensor]) {
+
+            state           = State::CROSSING;
+            firstSensor     = sensor;
+            overlapped      = false;
+            crossingStartMs = timeMs;
+        }
+        break;
+
+    case State::CROSSING:
+
+        if (blocked[0] && blocked[1]) {
+            overlapped = true;
+        }
+
+        if (!blocked[0] && !blocked[1]) {
+
+            if (overlapped && sensor != firstSensor) {
+
+                if (firstSensor == 0) {
+
+                    ++inCount;
+                    event = CrossingEvent::IN;
+                }
+                else {
+
+                    ++outCount;
+                    event = CrossingEvent::OUT;
+                }
+            }
+            state = State::IDLE;
+        }
+        else if ((uint32_t)(timeMs - crossingStartMs) > maxCrossingMs) {
+            state = State::WAIT_CLEAR;
+        }
+        break;
+
+    case State::WAIT_CLEAR:
+
+        if (!blocked[0] && !blocked[1]) {
+            state = State::IDLE;
+        }
+        break;
+    }
+
+    return event;
+}
+
+uint32_t
+DirectionCounter::get_in_count() const {
+
+    return inCount;
+}
+
+uint32_t
+DirectionCounter::get_out_count() const {
+
+    return outCount;
+}
+
+void
+DirectionCounter::reset() {
+
+    state       = State::IDLE;
+    blocked[0]  = false;
+    blocked[1]  = false;
+    overlapped  = false;
+    inCount     = 0;
+    outCount    = 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file                    DirectionCounter.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Counts crossings of a doorway, and their direction, from the beams of two sensors mounted next to each other
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __DIRECTIONCOUNTER_H__
+#define __DIRECTIONCOUNTER_H__
+
+#include <cstdint>
+
+/**
+ * @brief                   Crossing of the doorway completed by a measurement
+ */
+enum class CrossingEvent : uint8_t {
+
+    /** No crossing was completed */
+    NONE,
+    /** Something crossed from the beam of sensor 0 to the beam of sensor 1 */
+    IN,
+    /** Something crossed from the beam of sensor 1 to the beam of sensor 0 */
+    OUT
+};
+
+/**
+ * @brief                   Class that infers the direction of crossings from which of two beams is interrupted first
+ *
+ * @remarks                 A beam is interrupted when its sensor measures a distance below the block distance
+ * @remarks                 A crossing starts when either beam is interrupted while both are clear, and completes when both are clear again,
+ *                          it is counted if both beams were interrupted at the same time at some point, and the beam that cleared last
+ *                          differs from the one interrupted first (otherwise, the person turned back)
+ * @remarks                 A crossing that takes longer than the maximum duration is abandoned, and nothing is counted till both beams are clear
+ * @remarks                 The class does not depend on MBed OS, timestamps are supplied by the caller (and must come from a clock shared by both sensors)
+ */
+class DirectionCounter {
+
+    /**
+     * @brief               State of the crossing
+     */
+    enum class State : uint8_t {
+
+        /** Both beams are clear */
+        IDLE,
+        /** A crossing is in progress */
+        CROSSING,
+        /** A crossing was abandoned, waiting for both beams to be clear */
+        WAIT_CLEAR
+    };
+
+    /** Distance below which a beam is interrupted */
+    float           blockDistance;
+    /** Longest duration of a crossing in milliseconds */
+    uint32_t        maxCrossingMs;
+
+    /** State of the crossing */
+    State           state {State::IDLE};
+    /** Whether the beam of each sensor is interrupted */
+    bool            blocked[2] {};
+    /** Sensor whose beam was interrupted first in the current crossing */
+    uint8_t         firstSensor {0};
+    /** Whether both beams were interrupted at the same time in the current crossing */
+    bool            overlapped {false};
+    /** Time at which the current crossing started (in milliseconds) */
+    uint32_t        crossingStartMs {0};
+
+    /** Number of crossings from sensor 0 to sensor 1 */
+    uint32_t        inCount {0};
+    /** Number of crossings from sensor 1 to sensor 0 */
+    uint32_t        outCount {0};
+
+public:
+
+    /**
+     * @brief               Construct a new DirectionCounter object
+     *
+     * @param blockDistance Distance below which a beam is interrupted (in the unit of the distances)
+     * @param maxCrossingMs Longest duration of a crossing in milliseconds
+     */
+    explicit DirectionCounter(float blockDistance, uint32_t maxCrossingMs = 3'000);
+
+    /**
+     * @brief               Updates the state of a beam with a measurement of its sensor
+     *
+     * @remarks             Timestamps must not decrease, and are allowed to wrap around
+     *
+     * @param sensor        Index of the sensor (0 or 1)
+     * @param timeMs        Time at which the measurement was made (in milliseconds)
+     * @param valid         Whether the measurement was successful (a failed measurement leaves the beam clear)
+     * @param value         Measured distance
+     *
+     * @return              Crossing completed by the measurement (if any)
+     */
+    CrossingEvent   add(uint8_t sensor, uint32_t timeMs, bool valid, float value);
+
+    /**
+     * @brief               Get the number of crossings from sensor 0 to sensor 1
+     *
+     * @return              Number of crossings
+     */
+    uint32_t        get_in_count() const;
+
+    /**
+     * @brief               Get the number of crossings from sensor 1 to sensor 0
+     *
+     * @return              Number of crossings
+     */
+    uint32_t        get_out_count() const;
+
+    /**
+     * @brief               Resets the counts and abandons the current crossing
+     */
+    void            reset();
+};
+
+#endif //__DIRECTIONCOUNTER_H__
@@ -0,0 +1,168 @@
+#include "DispatchThread.h"
+
+// Constructors
+
+DispatchThread::DispatchThread()
+        : shouldTerminate(1, 1)
+{
+}
+
+DispatchThread::~DispatchThread() {
+
+    // stop the periodic event (if any) and wait for the posted events by queueing an event behind them, then terminate the thread
+    // the periodic event is cancelled on the thread, so keep draining till it is
+
+    if (!is_running()) {
+        return;
+    }
+
+    stop_periodic();
+    do {
+        drain();
+    } while (is_periodic_started());
+
+    stop();
+}
+
+// Public Methods
+
+bool
+DispatchThread::start() {
+
+    // return if the thread was already started; move forward otherwise
+    // allocate the thread and return if the allocation fails; move forward otherwise
+    // try to start the thread and return if successful
+    // in case of failure, delete the allocated thread and return
+
+    if (is_running()) {
+        return false;
+    }
+
+    threadHandle = new (std::nothrow) Thread(osPriorityRealtime);
+    if (threadHandle == nullptr) {
+        return false;
+    }
+
+    auto status = threadHandle->start(callback(this, &DispatchThread::dispatch_events));
+    if (status != osOK) {
+
+        delete threadHandle;
+        threadHandle = nullptr;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool
+DispatchThread::stop() {
+
+    // return if the thread was not started or the periodic event is started; move forward otherwise
+    // break the dispatch after acquiring shouldTerminate to gracefully terminate the thread, then free it
+
+    if (!is_running() || is_periodic_started()) {
+        return false;
+    }
+
+    shouldTerminate.acquire();
+    queue.break_dispatch();
+    threadHandle->join();
+    shouldTerminate.release();
+
+    delete threadHandle;
+    threadHandle = nullptr;
+    return true;
+}
+
+bool
+DispatchThread::is_running() const {
+
+    return threadHandle != nullptr;
+}
+
+EventQueue &
+DispatchThread::get_queue() {
+
+    return queue;
+}
+
+bool
+DispatchThread::start_periodic(std::chrono::milliseconds period, const Callback<void()> &cb) {
+
+    if (is_periodic_started()) {
+        return false;
+    }
+
+    periodicId = queue.call_every(period, cb);
+    return periodicId != 0;
+}
+
+void
+DispatchThread::stop_periodic() {
+
+    // return if no periodic event was posted; move forward otherwise
+    // if the thread is not running, directly cancel the event
+    // otherwise, break the dispatch without acquiring shouldTerminate to cancel the event in the thread
+
+    if (!is_periodic_started()) {
+        return;
+    }
+
+    if (!is_running()) {
+
+        queue.cancel(periodicId);
+        periodicId = 0;
+
+        return;
+    }
+
+    queue.break_dispatch();
+}
+
+bool
+DispatchThread::is_periodic_started() const {
+
+    return periodicId != 0;
+}
+
+void
+DispatchThread::drain() {
+
+    // the queue is dispatched in order, so an event posted now runs after all events posted before it
+
+    if (!is_running()) {
+        return;
+    }
+
+    Semaphore drained(0, 1);
+    if (queue.call([&drained]() { drained.release(); }) != 0) {
+        drained.acquire();
+    }
+}
+
+// Private methods
+
+void
+DispatchThread::dispatch_events() {
+
+    // same as BasicHCSR04::dispatch_events()
+    // keep dispatching the queue, and cancel the periodic event whenever the dispatch is broken
+    // stop only if the dispatch was broken while shouldTerminate was held (see DispatchThread::stop())
+
+    for (;;) {
+
+        queue.dispatch_forever();
+
+        if (periodicId != 0) {
+
+            queue.cancel(periodicId);
+            periodicId = 0;
+        }
+
+        if (!shouldTerminate.try_acquire()) {
+            break;
+        }
+        shouldTerminate.release();
+    }
+}
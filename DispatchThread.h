@@ -0,0 +1,137 @@
+/**
+ * @file                    DispatchThread.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Thread and EventQueue on which the multi-sensor classes of the library run their measurements
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __DISPATCHTHREAD_H__
+#define __DISPATCHTHREAD_H__
+
+#include "mbed.h"
+
+/**
+ * @brief                   Class that owns an EventQueue and the thread that dispatches it, and runs at most one periodic event on it
+ *
+ * @remarks                 The thread is allocated and started by DispatchThread::start(), and stopped and freed by DispatchThread::stop(),
+ *                          the same way as by BasicHCSR04::initialize() and BasicHCSR04::finalize()
+ * @remarks                 Used by HCSR04Array, DoorwayCounter and SweepScanner, which post their measurements to DispatchThread::get_queue()
+ */
+class DispatchThread {
+
+    /** Handle to the thread on which the queue is dispatched (nullptr if not started) */
+    Thread          *threadHandle {nullptr};
+
+    /** Queue to post measurement events on */
+    EventQueue      queue;
+    /** ID of the periodic event on the EventQueue (0 if no periodic event or failed allocation) */
+    int32_t         periodicId {0};
+
+    /** Semaphore to block the queue dispatch thread and for graceful termination */
+    Semaphore       shouldTerminate;
+
+public:
+
+    /**
+     * @brief               Construct a new DispatchThread object, without starting the thread
+     */
+    DispatchThread();
+
+    DispatchThread(const DispatchThread &) = delete;
+    DispatchThread  &operator=(const DispatchThread &) = delete;
+
+    /**
+     * @brief               Destroy the DispatchThread object, stopping the periodic event and waiting for the posted events before stopping the thread
+     *
+     * @attention           Can not call this method from ISR context, or from the thread itself
+     */
+    ~DispatchThread();
+
+    /**
+     * @brief               Allocates and starts the thread that dispatches the queue
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully allocated and started, false if it was already started or that failed
+     */
+    bool            start();
+
+    /**
+     * @brief               Stops and frees the thread, once it has dispatched the event in progress (if any)
+     *
+     * @remarks             Events still in the queue are kept, and dispatched once the thread is started again
+     *
+     * @attention           Can not call this method from ISR context, or from the thread itself
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully stopped and freed, false if it was not started or the periodic event is started
+     */
+    bool            stop();
+
+    /**
+     * @brief               Checks if the thread is started
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if the thread is running, false otherwise
+     */
+    bool            is_running() const;
+
+    /**
+     * @brief               Get the queue dispatched by the thread
+     *
+     * @return              Reference to the queue
+     */
+    EventQueue      &get_queue();
+
+    /**
+     * @brief               Posts the periodic event
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param period        Time period between two calls
+     * @param cb            Function called on the thread every period
+     *
+     * @return              true if the event was posted, false if the periodic event is already started or the queue is full
+     */
+    bool            start_periodic(std::chrono::milliseconds period, const Callback<void()> &cb);
+
+    /**
+     * @brief               Stops the periodic event
+     *
+     * @remarks             If the thread is running, the event is cancelled on the thread (see BasicHCSR04::stop_measurement_periodic()), so a call in
+     *                      progress is completed first and DispatchThread::is_periodic_started() returns true till then
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            stop_periodic();
+
+    /**
+     * @brief               Checks if the periodic event is started
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if the periodic event is started, false otherwise
+     */
+    bool            is_periodic_started() const;
+
+    /**
+     * @brief               Waits till the events posted before this call have been dispatched (returns immediately if the thread is not running)
+     *
+     * @attention           Can not call this method from ISR context, or from the thread itself
+     */
+    void            drain();
+
+private:
+
+    /**
+     * @brief           Function for queue to run callbacks on (see BasicHCSR04::dispatch_events())
+     */
+    void            dispatch_events();
+};
+
+#endif //__DISPATCHTHREAD_H__
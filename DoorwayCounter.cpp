@@ -0,0 +1,100 @@
+#include "DoorwayCounter.h"
+#include "SpeedOfSound.h"
+
+// Constructors
+
+DoorwayCounter::DoorwayCounter(PinName trig0, PinName echo0, PinName trig1, PinName echo1, float blockDistance, const Callback<void(CrossingEvent)> &cb)
+        : captures {{trig0, echo0}, {trig1, echo1}}
+        , counter(blockDistance)
+        , crossingCb(cb)
+{
+}
+
+DoorwayCounter::~DoorwayCounter() = default;
+
+// Public Methods
+
+bool
+DoorwayCounter::initialize() {
+
+    return dispatch.start();
+}
+
+bool
+DoorwayCounter::finalize() {
+
+    // fails while counting is started (see DispatchThread::stop())
+
+    return dispatch.stop();
+}
+
+bool
+DoorwayCounter::start(std::chrono::milliseconds period) {
+
+    // return if the period is too short for the echoes to fade; move forward otherwise
+    // post a periodic event that pings the sensors alternately
+
+    if (period < DOORWAY_MIN_PING_PERIOD) {
+        return false;
+    }
+
+    return dispatch.start_periodic(period, callback(this, &DoorwayCounter::ping_next));
+}
+
+void
+DoorwayCounter::stop() {
+
+    dispatch.stop_periodic();
+}
+
+bool
+DoorwayCounter::is_started() const {
+
+    return dispatch.is_periodic_started();
+}
+
+uint32_t
+DoorwayCounter::get_in_count() const {
+
+    return counter.get_in_count();
+}
+
+uint32_t
+DoorwayCounter::get_out_count() const {
+
+    return counter.get_out_count();
+}
+
+void
+DoorwayCounter::set_temperature(float celsius, float relativeHumidity) {
+
+    unit.set_speed_of_sound(speed_of_sound(celsius, relativeHumidity));
+}
+
+// Private methods
+
+void
+DoorwayCounter::ping_next() {
+
+    // ping the next sensor and timestamp the measurement at its trigger, against the clock shared by both sensors
+    // the width of the echo (up to the timeout of a missing one) then does not shift the order of the measurements
+    // update the counter and report a completed crossing
+    // switch to the other sensor for the next period
+
+    uint8_t         sensor;
+    uint32_t        pulse;
+    bool            valid;
+    uint32_t        triggerMs;
+    CrossingEvent   event;
+
+    sensor      = nextSensor;
+    nextSensor  = 1 - nextSensor;
+
+    valid       = captures[sensor].capture(&pulse) == HCSR04Status::OK;
+    triggerMs   = captures[sensor].get_trigger_time().time_since_epoch().count();
+
+    event = counter.add(sensor, triggerMs, valid, valid ? unit.from_pulse(pulse) : 0.0f);
+    if (event != CrossingEvent::NONE && crossingCb) {
+        crossingCb(event);
+    }
+}
@@ -0,0 +1,160 @@
+/**
+ * @file                    DoorwayCounter.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Counts people passing through a doorway in each direction using two HCSR04 sensors mounted next to each other
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __DOORWAYCOUNTER_H__
+#define __DOORWAYCOUNTER_H__
+
+#include "mbed.h"
+#include "DirectionCounter.h"
+#include "DispatchThread.h"
+#include "EchoCapture.h"
+#include "HCSR04Units.h"
+
+/** Shortest time between two pings of the pair, the measurement cycle recommended by the datasheet, so that the late echoes of one ping
+ *  have faded before the other sensor listens */
+constexpr auto      DOORWAY_MIN_PING_PERIOD = 60ms;
+
+/**
+ * @brief                   Class that pings two sensors alternately from a single thread, and counts the crossings of their beams in each direction
+ *
+ * @remarks                 Sensor 0 should be mounted on the outside, so that crossing from its beam to the beam of sensor 1 counts as in
+ * @remarks                 Both sensors are pinged from the same periodic event one after the other, so their measurements never overlap (no crosstalk)
+ *                          and are timestamped against the same clock, at the moment each sensor was pinged (see DirectionCounter)
+ * @remarks                 The callback is only called when a crossing is completed, on the thread of the object
+ */
+class DoorwayCounter {
+
+    /** Capture of the echo pulse of each sensor */
+    EchoCapture     captures[2];
+    /** Conversion of the width of the pulse into a distance, shared by both sensors */
+    Centimetres     unit;
+    /** Direction of crossings inferred from the beams */
+    DirectionCounter counter;
+    /** Index of the sensor to ping next */
+    uint8_t         nextSensor {0};
+
+    /** Callback when a crossing is completed */
+    Callback<void(CrossingEvent)> crossingCb;
+
+    /** Thread and queue on which the sensors are pinged (declared last, so that it is stopped before the state it uses is destroyed) */
+    DispatchThread  dispatch;
+
+public:
+
+    /**
+     * @brief               Construct a new DoorwayCounter object
+     *
+     * @param trig0         Microcontroller Pin to which the Trig Pin of sensor 0 (outside) is connected
+     * @param echo0         Microcontroller Pin to which the Echo Pin of sensor 0 (outside) is connected
+     * @param trig1         Microcontroller Pin to which the Trig Pin of sensor 1 (inside) is connected
+     * @param echo1         Microcontroller Pin to which the Echo Pin of sensor 1 (inside) is connected
+     * @param blockDistance Distance (in centimetres) below which the beam of a sensor is interrupted, typically less than the width of the doorway
+     * @param cb            Callback when a crossing is completed, with its direction as argument
+     */
+    DoorwayCounter(PinName trig0, PinName echo0, PinName trig1, PinName echo1, float blockDistance, const Callback<void(CrossingEvent)> &cb);
+
+    DoorwayCounter(const DoorwayCounter &) = delete;
+    DoorwayCounter  &operator=(const DoorwayCounter &) = delete;
+
+    /**
+     * @brief               Destroy the DoorwayCounter object, stopping and finalizing it first if required
+     *
+     * @attention           Can not call this method from ISR context
+     */
+    ~DoorwayCounter();
+
+    /**
+     * @brief               Initializes the object by allocating and starting the thread on which the sensors are pinged (see HCSR04::initialize())
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully allocated and started, false otherwise
+     */
+    bool            initialize();
+
+    /**
+     * @brief               Finalizes the object by stopping and freeing the thread (see HCSR04::finalize())
+     *
+     * @remarks             The object can not be finalized while counting is started
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully stopped and freed, false otherwise
+     */
+    bool            finalize();
+
+    /**
+     * @brief               Starts pinging the sensors alternately and counting crossings
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param period        Time between two pings (each sensor is pinged every other period), at least DOORWAY_MIN_PING_PERIOD
+     *
+     * @return              true if counting was started, false otherwise
+     */
+    bool            start(std::chrono::milliseconds period = DOORWAY_MIN_PING_PERIOD);
+
+    /**
+     * @brief               Stops pinging the sensors
+     *
+     * @remarks             If a sensor was being pinged while this function was called, that measurement is completed first
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            stop();
+
+    /**
+     * @brief               Checks if counting is started
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if counting is started, false otherwise
+     */
+    bool            is_started() const;
+
+    /**
+     * @brief               Get the number of crossings from sensor 0 to sensor 1
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              Number of crossings
+     */
+    uint32_t        get_in_count() const;
+
+    /**
+     * @brief               Get the number of crossings from sensor 1 to sensor 0
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              Number of crossings
+     */
+    uint32_t        get_out_count() const;
+
+    /**
+     * @brief               Updates the temperature (and optionally humidity) of the air for both sensors (see BasicHCSR04::set_temperature())
+     *
+     * @attention           This function can be called from ISR context, and while counting
+     *
+     * @param celsius           Temperature of the air in degrees Celsius
+     * @param relativeHumidity  Relative humidity of the air in percent (0 to 100)
+     */
+    void            set_temperature(float celsius, float relativeHumidity = 0.0f);
+
+private:
+
+    /**
+     * @brief           Pings the next sensor, updates the counter with its measurement and calls the callback if a crossing was completed
+     */
+    void            ping_next();
+};
+
+#endif //__DOORWAYCOUNTER_H__
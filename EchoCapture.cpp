@@ -0,0 +1,154 @@
+#include "EchoCapture.h"
+#include "EchoTiming.h"
+
+// Constructors
+
+EchoCapture::EchoCapture()
+        : edgeLimiter(ECHO_STORM_WINDOW_US, ECHO_STORM_MAX_EDGES)
+{
+}
+
+EchoCapture::EchoCapture(PinName trig, PinName echo)
+        : trigPin(new (std::nothrow) DigitalOut(trig))
+        , echoPin(new (std::nothrow) InterruptIn(echo))
+        , edgeLimiter(ECHO_STORM_WINDOW_US, ECHO_STORM_MAX_EDGES)
+{
+
+    // if either pin could not be allocated, release the other one as well and leave the object unbound
+
+    if (trigPin == nullptr || echoPin == nullptr) {
+
+        trigPin.reset();
+        echoPin.reset();
+        return;
+    }
+
+    bind_handlers();
+}
+
+EchoCapture::EchoCapture(EchoCapture &&other)
+        : trigPin(std::move(other.trigPin))
+        , echoPin(std::move(other.echoPin))
+        , edgeLimiter(other.edgeLimiter)
+        , status(other.status)
+        , faultCount(other.faultCount)
+        , retryTime(other.retryTime)
+        , triggerTime(other.triggerTime)
+        , recorder(other.recorder)
+        , trace(std::move(other.trace))
+{
+
+    bind_handlers();
+}
+
+EchoCapture &
+EchoCapture::operator=(EchoCapture &&other) {
+
+    // take over the pins and the state of the sensor, and re-bind the echo handlers to this object
+    // the pins previously owned by this object (if any) are released
+
+    if (this != &other) {
+
+        trigPin     = std::move(other.trigPin);
+        echoPin     = std::move(other.echoPin);
+
+        edgeLimiter = other.edgeLimiter;
+        status      = other.status;
+        faultCount  = other.faultCount;
+        retryTime   = other.retryTime;
+        triggerTime = other.triggerTime;
+        recorder    = other.recorder;
+        trace       = std::move(other.trace);
+
+        bind_handlers();
+    }
+
+    return *this;
+}
+
+// Public Methods
+
+bool
+EchoCapture::is_bound() const {
+
+    return echoPin != nullptr;
+}
+
+HCSR04Status
+EchoCapture::capture(uint32_t *pulseUs) {
+
+    return core.capture(sensor(), 0, pulseUs);
+}
+
+void
+EchoCapture::cancel() {
+
+    core.cancel();
+}
+
+void
+EchoCapture::resume() {
+
+    core.resume();
+}
+
+void
+EchoCapture::clear_backoff() {
+
+    EchoCaptureCore::clear_backoff(sensor());
+}
+
+HCSR04Status
+EchoCapture::get_status() const {
+
+    return status;
+}
+
+uint32_t
+EchoCapture::get_edge_storm_count() const {
+
+    return edgeLimiter.get_trip_count();
+}
+
+Kernel::Clock::time_point
+EchoCapture::get_trigger_time() const {
+
+    return triggerTime;
+}
+
+bool
+EchoCapture::set_recorder(const Callback<void(const EchoTrace &)> &cb) {
+
+    return EchoCaptureCore::set_recorder(sensor(), cb);
+}
+
+// Private methods
+
+EchoSensor
+EchoCapture::sensor() {
+
+    return {trigPin.get(), echoPin.get(), edgeLimiter, status, faultCount, retryTime, triggerTime, trace, recorder};
+}
+
+void
+EchoCapture::pulse_start_handler() {
+
+    core.on_edge(sensor(), 0, true);
+}
+
+void
+EchoCapture::pulse_end_handler() {
+
+    core.on_edge(sensor(), 0, false);
+}
+
+void
+EchoCapture::bind_handlers() {
+
+    if (echoPin == nullptr) {
+        return;
+    }
+
+    echoPin->rise(callback(this, &EchoCapture::pulse_start_handler));
+    echoPin->fall(callback(this, &EchoCapture::pulse_end_handler));
+}
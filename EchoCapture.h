@@ -0,0 +1,218 @@
+/**
+ * @file                    EchoCapture.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Capture of the echo pulse of an HCSR04 ultrasonic sensor, shared by the sensor classes of the library
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __ECHOCAPTURE_H__
+#define __ECHOCAPTURE_H__
+
+#include <memory>
+#include <new>
+
+#include "mbed.h"
+#include "EchoCaptureCore.h"
+#include "EchoTrace.h"
+#include "EdgeRateLimiter.h"
+#include "HCSR04Status.h"
+
+/**
+ * @brief                   Class that triggers an HCSR04 sensor and measures the width of the returned pulse using an InterruptIn and a Timer
+ *
+ * @remarks                 Handles faults of the sensor (stuck echo line, edge storms) and backs off exponentially after them
+ * @remarks                 Keeps the state of a single sensor and captures it through an EchoCaptureCore, the engine shared with EchoCaptureBank
+ */
+class EchoCapture {
+
+    /** Engine that pings the sensor and measures the returned pulse (declared first, so that the pins detach their interrupts before it is
+     *  destroyed, and not moved with the sensor) */
+    EchoCaptureCore core;
+
+    /** Trigger Pin of the sensor (owned through a pointer so that the sensor can be moved between objects, nullptr if unbound) */
+    std::unique_ptr<DigitalOut>     trigPin;
+    /** Echo Pin of the sensor (owned through a pointer so that the sensor can be moved between objects, nullptr if unbound) */
+    std::unique_ptr<InterruptIn>    echoPin;
+
+    /** Rate limiter to detect a storm of edges on the echo line */
+    EdgeRateLimiter edgeLimiter;
+
+    /** Outcome of the most recent capture */
+    HCSR04Status    status {HCSR04Status::OK};
+    /** Number of consecutive faults, used as the exponent of the retry back-off */
+    uint8_t         faultCount {0};
+    /** Earliest point in time at which the sensor is pinged again after a fault */
+    Kernel::Clock::time_point retryTime {};
+    /** Point in time at which the most recent ping was sent, or at which the capture gave up if it did not ping the sensor */
+    Kernel::Clock::time_point triggerTime {};
+
+    /** Callback that receives the timings of every capture (unset if captures are not recorded) */
+    Callback<void(const EchoTrace &)>   recorder;
+    /** Timings of the capture in progress and the edges since the previous one (only allocated while recording) */
+    std::unique_ptr<EchoTrace>  trace;
+
+public:
+
+    /**
+     * @brief               Construct a new EchoCapture object that is not bound to a sensor
+     *
+     * @remarks             Captures fail with HCSR04Status::STUCK_LOW till a sensor is moved into the object
+     */
+    EchoCapture();
+
+    /**
+     * @brief               Construct a new EchoCapture object
+     *
+     * @remarks             If the pins can not be allocated, the object is left unbound (see EchoCapture::is_bound())
+     *
+     * @param   trig        Microcontroller Pin to which the Trig Pin of the sensor is connected
+     * @param   echo        Microcontroller Pin to which the Echo Pin of the sensor is connected
+     */
+    EchoCapture(PinName trig, PinName echo);
+
+    /**
+     * @brief               Construct a new EchoCapture object by taking over the sensor of another object
+     *
+     * @attention           The other object must not be capturing
+     *
+     * @param other         Object whose sensor is taken over
+     */
+    EchoCapture(EchoCapture &&other);
+
+    /**
+     * @brief               Takes over the sensor of another object
+     *
+     * @attention           Neither object must be capturing
+     *
+     * @param other         Object whose sensor is taken over
+     *
+     * @return              Reference to this object
+     */
+    EchoCapture     &operator=(EchoCapture &&other);
+
+    EchoCapture(const EchoCapture &) = delete;
+    EchoCapture     &operator=(const EchoCapture &) = delete;
+
+    /**
+     * @brief               Checks whether the object is bound to a sensor
+     *
+     * @return              true if the pins of a sensor are owned by this object, false otherwise (captures then fail with HCSR04Status::STUCK_LOW)
+     */
+    bool            is_bound() const;
+
+    /**
+     * @brief               Pings the sensor (unless it is backing off or cancelled) and waits for the returned pulse
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param pulseUs       Location to store the width of the returned pulse in microseconds (only written if successful)
+     *
+     * @return              Outcome of the capture, HCSR04Status::OK if the pulse was received completely
+     */
+    HCSR04Status    capture(uint32_t *pulseUs);
+
+    /**
+     * @brief               Cancels the capture in progress (if any) and makes all further captures fail immediately till EchoCapture::resume() is called
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            cancel();
+
+    /**
+     * @brief               Allows captures again after EchoCapture::cancel()
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            resume();
+
+    /**
+     * @brief               Forgets the consecutive faults of the sensor, so that the next capture pings it even if it is backing off
+     *
+     * @remarks             For callers that know a fault is tied to the conditions of one capture, for example to the direction a swept
+     *                      sensor was pointing in (see SweepScanner)
+     * @remarks             Does not clear the back-off of an edge storm, as the interrupt of the echo line stays disabled till it has passed,
+     *                      so that a noisy line does not cost CPU time again on every capture
+     *
+     * @attention           Must not be called while capturing
+     */
+    void            clear_backoff();
+
+    /**
+     * @brief               Get the outcome of the most recent capture
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              Status of the most recent capture
+     */
+    HCSR04Status    get_status() const;
+
+    /**
+     * @brief               Get the number of times a storm of edges was detected on the echo line
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              Number of edge storms detected
+     */
+    uint32_t        get_edge_storm_count() const;
+
+    /**
+     * @brief               Get the point in time at which the most recent capture pinged the sensor (the end of the trigger pulse, when the
+     *                      sensor sends its burst), which is when the measured distance was true
+     *
+     * @remarks             If the capture did not ping the sensor (for example while backing off), this is the point in time of the attempt
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              Point in time of the most recent ping
+     */
+    Kernel::Clock::time_point get_trigger_time() const;
+
+    /**
+     * @brief               Sets a callback that receives the raw timings of every capture, for example to append them to a buffer or a file
+     *
+     * @remarks             The callback is called on the thread that called EchoCapture::capture(), after the capture is complete, so it does not
+     *                      affect the timing of the capture (the interrupt handlers only store the time and direction of each edge)
+     * @remarks             Every edge seen on the echo line since the previous capture is recorded, so the recorded timings can be replayed on a
+     *                      host through the capture itself (see tools/echo-replay), with its fault handling and edge-storm detection
+     * @remarks             The timings are only stored while recording, in an EchoTrace allocated by this method
+     *
+     * @attention           Must not be called while capturing
+     *
+     * @param cb            Callback with the timings of the capture as argument (nullptr to stop recording and free the timings)
+     *
+     * @return              true if the recorder was set, false if the timings could not be allocated
+     */
+    bool            set_recorder(const Callback<void(const EchoTrace &)> &cb);
+
+private:
+
+    /**
+     * @brief           Helper function to get the state of the sensor as seen by the capture engine
+     */
+    EchoSensor      sensor();
+
+    /**
+     * @brief           Handler for the start of the returned pulse from the sensor
+     *
+     * @remarks         This is called whenever a rise interrupt is received on the Echo pin (start of a pulse)
+     */
+    void            pulse_start_handler();
+
+    /**
+     * @brief           Handler for the end of the returned pulse from the sensor
+     *
+     * @remarks         This is called whenever a fall interrupt is received on the Echo pin (end of a pulse)
+     */
+    void            pulse_end_handler();
+
+    /**
+     * @brief           Helper function to bind the handlers of the Echo pin to this object
+     */
+    void            bind_handlers();
+};
+
+#endif //__ECHOCAPTURE_H__
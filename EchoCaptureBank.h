@@ -0,0 +1,294 @@
+/**
+ * @file                    EchoCaptureBank.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Capture of the echo pulses of a fixed set of HCSR04 ultrasonic sensors that are pinged one after the other
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __ECHOCAPTUREBANK_H__
+#define __ECHOCAPTUREBANK_H__
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "mbed.h"
+#include "EchoCaptureCore.h"
+#include "EchoTiming.h"
+#include "EdgeRateLimiter.h"
+#include "HCSR04Status.h"
+
+/**
+ * @brief                   Pins to which a single HCSR04 sensor is connected
+ */
+struct HCSR04Pins {
+
+    /** Microcontroller Pin to which the Trig Pin of the sensor is connected */
+    PinName         trig;
+    /** Microcontroller Pin to which the Echo Pin of the sensor is connected */
+    PinName         echo;
+};
+
+/**
+ * @brief                   Class that captures the echo pulses of N sensors through the same engine as EchoCapture (see EchoCaptureCore), one
+ *                          sensor at a time
+ *
+ * @remarks                 The state of the sensors is laid out as a struct of arrays, with the pins constructed in place (no heap allocation
+ *                          unless a sensor is recorded), while the engine (with the timer, the Semaphores and the flags of the capture in
+ *                          progress) exists once, as only one sensor is captured at a time
+ * @remarks                 The edge handlers of each sensor are instances of a member function template, bound at compile-time to its index
+ * @remarks                 Edges on every echo line are counted for edge storms, but only those of the sensor being captured are measured
+ * @remarks                 The object binds the handlers to itself, so it can not be copied or moved
+ *
+ * @tparam N                Number of sensors
+ * @tparam Pins             Table of the pins of each sensor (must have static storage duration, typically a constexpr array)
+ */
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+class EchoCaptureBank {
+
+    static_assert(N > 0, "EchoCaptureBank requires at least one sensor");
+
+    /** Engine that pings the sensors and measures the returned pulses, shared by all sensors (declared first, so that the pins detach their
+     *  interrupts before it is destroyed) */
+    EchoCaptureCore core;
+
+    /** Trigger Pin of each sensor */
+    DigitalOut      trigPins[N];
+    /** Echo Pin of each sensor */
+    InterruptIn     echoPins[N];
+    /** Rate limiter to detect a storm of edges on the echo line of each sensor */
+    EdgeRateLimiter edgeLimiters[N];
+    /** Earliest point in time at which each sensor is pinged again after a fault */
+    Kernel::Clock::time_point   retryTimes[N] {};
+    /** Point in time at which each sensor was most recently pinged (see EchoCapture::get_trigger_time()) */
+    Kernel::Clock::time_point   triggerTimes[N] {};
+    /** Outcome of the most recent capture of each sensor */
+    HCSR04Status    statuses[N] {};
+    /** Number of consecutive faults of each sensor, used as the exponent of the retry back-off */
+    uint8_t         faultCounts[N] {};
+    /** Timings of the capture in progress of each sensor and the edges since its previous one (only allocated while recording) */
+    std::unique_ptr<EchoTrace>  traces[N];
+    /** Callback that receives the timings of every capture of each sensor (unset if its captures are not recorded) */
+    Callback<void(const EchoTrace &)>   recorders[N];
+
+public:
+
+    /** Number of bytes of RAM used by the state of each sensor, including its pins (the state shared by all sensors is not included) */
+    static constexpr size_t PER_SENSOR_BYTES = sizeof(DigitalOut) + sizeof(InterruptIn) + sizeof(EdgeRateLimiter) + 2 * sizeof(Kernel::Clock::time_point) +
+                                               sizeof(HCSR04Status) + sizeof(uint8_t) + sizeof(std::unique_ptr<EchoTrace>) +
+                                               sizeof(Callback<void(const EchoTrace &)>);
+
+    /**
+     * @brief               Construct a new EchoCaptureBank object, binding each sensor to its pins from the table
+     */
+    EchoCaptureBank();
+
+    EchoCaptureBank(const EchoCaptureBank &) = delete;
+    EchoCaptureBank &operator=(const EchoCaptureBank &) = delete;
+
+    /**
+     * @brief               Pings a sensor (unless it is backing off or captures are cancelled) and waits for the returned pulse (see EchoCapture::capture())
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently, even for different sensors
+     *
+     * @param index         Index of the sensor in the pin table
+     * @param pulseUs       Location to store the width of the returned pulse in microseconds (only written if successful)
+     *
+     * @return              Outcome of the capture, HCSR04Status::OK if the pulse was received completely
+     */
+    HCSR04Status    capture(size_t index, uint32_t *pulseUs);
+
+    /**
+     * @brief               Cancels the capture in progress (if any) and makes all further captures fail immediately till EchoCaptureBank::resume() is called
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            cancel();
+
+    /**
+     * @brief               Allows captures again after EchoCaptureBank::cancel()
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            resume();
+
+    /**
+     * @brief               Get the outcome of the most recent capture of a sensor
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param index         Index of the sensor in the pin table
+     *
+     * @return              Status of the most recent capture
+     */
+    HCSR04Status    get_status(size_t index) const;
+
+    /**
+     * @brief               Get the number of times a storm of edges was detected on the echo line of a sensor
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param index         Index of the sensor in the pin table
+     *
+     * @return              Number of edge storms detected
+     */
+    uint32_t        get_edge_storm_count(size_t index) const;
+
+    /**
+     * @brief               Get the point in time at which the most recent capture of a sensor pinged it (see EchoCapture::get_trigger_time())
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param index         Index of the sensor in the pin table
+     *
+     * @return              Point in time of the most recent ping
+     */
+    Kernel::Clock::time_point get_trigger_time(size_t index) const;
+
+    /**
+     * @brief               Sets a callback that receives the raw timings of every capture of a sensor (see EchoCapture::set_recorder())
+     *
+     * @attention           Must not be called while capturing
+     *
+     * @param index         Index of the sensor in the pin table
+     * @param cb            Callback with the timings of the capture as argument (nullptr to stop recording and free the timings)
+     *
+     * @return              true if the recorder was set, false if the timings could not be allocated
+     */
+    bool            set_recorder(size_t index, const Callback<void(const EchoTrace &)> &cb);
+
+private:
+
+    /**
+     * @brief           Constructs the pins and rate limiters of all sensors in place, and binds the edge handlers of each sensor
+     */
+    template <size_t... I>
+    EchoCaptureBank(std::index_sequence<I...>);
+
+    /**
+     * @brief           Handler for a rise interrupt on the Echo pin of a sensor
+     *
+     * @tparam I        Index of the sensor in the pin table
+     */
+    template <size_t I>
+    void            pulse_start_handler();
+
+    /**
+     * @brief           Handler for a fall interrupt on the Echo pin of a sensor
+     *
+     * @tparam I        Index of the sensor in the pin table
+     */
+    template <size_t I>
+    void            pulse_end_handler();
+
+    /**
+     * @brief           Helper function to get the state of a sensor as seen by the capture engine
+     *
+     * @param index     Index of the sensor in the pin table
+     */
+    EchoSensor      sensor(size_t index);
+};
+
+// Constructors
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+EchoCaptureBank<N, Pins>::EchoCaptureBank()
+        : EchoCaptureBank(std::make_index_sequence<N> {})
+{
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+template <size_t... I>
+EchoCaptureBank<N, Pins>::EchoCaptureBank(std::index_sequence<I...>)
+        : trigPins {{Pins[I].trig}...}
+        , echoPins {{Pins[I].echo}...}
+        , edgeLimiters {{((void)I, ECHO_STORM_WINDOW_US), ECHO_STORM_MAX_EDGES}...}
+{
+
+    int bound[] = {(echoPins[I].rise(callback(this, &EchoCaptureBank::pulse_start_handler<I>)),
+                    echoPins[I].fall(callback(this, &EchoCaptureBank::pulse_end_handler<I>)), 0)...};
+    (void)bound;
+}
+
+// Public Methods
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+HCSR04Status
+EchoCaptureBank<N, Pins>::capture(size_t index, uint32_t *pulseUs) {
+
+    return core.capture(sensor(index), index, pulseUs);
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+void
+EchoCaptureBank<N, Pins>::cancel() {
+
+    core.cancel();
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+void
+EchoCaptureBank<N, Pins>::resume() {
+
+    core.resume();
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+HCSR04Status
+EchoCaptureBank<N, Pins>::get_status(size_t index) const {
+
+    return statuses[index];
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+uint32_t
+EchoCaptureBank<N, Pins>::get_edge_storm_count(size_t index) const {
+
+    return edgeLimiters[index].get_trip_count();
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+Kernel::Clock::time_point
+EchoCaptureBank<N, Pins>::get_trigger_time(size_t index) const {
+
+    return triggerTimes[index];
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+bool
+EchoCaptureBank<N, Pins>::set_recorder(size_t index, const Callback<void(const EchoTrace &)> &cb) {
+
+    return EchoCaptureCore::set_recorder(sensor(index), cb);
+}
+
+// Private methods
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+EchoSensor
+EchoCaptureBank<N, Pins>::sensor(size_t index) {
+
+    return {&trigPins[index], &echoPins[index], edgeLimiters[index], statuses[index], faultCounts[index], retryTimes[index], triggerTimes[index],
+            traces[index], recorders[index]};
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+template <size_t I>
+void
+EchoCaptureBank<N, Pins>::pulse_start_handler() {
+
+    core.on_edge(sensor(I), I, true);
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+template <size_t I>
+void
+EchoCaptureBank<N, Pins>::pulse_end_handler() {
+
+    core.on_edge(sensor(I), I, false);
+}
+
+#endif //__ECHOCAPTUREBANK_H__
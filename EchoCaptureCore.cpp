@@ -0,0 +1,327 @@
+#include "EchoCaptureCore.h"
+#include "EchoTiming.h"
+
+// Constructors
+
+EchoCaptureCore::EchoCaptureCore()
+        : pulseStartLock(0, 1)
+        , pulseBusyLock(0, 1)
+{
+}
+
+// Public Methods
+
+HCSR04Status
+EchoCaptureCore::capture(const EchoSensor &sensor, size_t index, uint32_t *pulseUs) {
+
+    // if recording, note the start of the capture and the level of the echo line (the edges since the previous capture are already stored)
+    // capture the pulse, then take the timings out of the trace and clear its edges, so that it collects the edges till the next capture
+    // the edge handlers write the trace, so that is done in a critical section, and the recorder is called with the copy
+
+    HCSR04Status    result;
+    EchoTrace       finished;
+
+    if (sensor.trace != nullptr) {
+
+        sensor.trace->startUs       = us_ticker_read();
+        sensor.trace->triggerUs     = 0;
+        sensor.trace->startLevel    = (sensor.echoPin != nullptr) ? sensor.echoPin->read() : 0;
+    }
+
+    result = capture_pulse(sensor, index, pulseUs);
+
+    if (sensor.trace != nullptr && sensor.recorder) {
+
+        {
+            CriticalSectionLock lock;
+
+            finished                    = *sensor.trace;
+            sensor.trace->edgeCount     = 0;
+            sensor.trace->risingMask    = 0;
+        }
+
+        finished.endUs      = us_ticker_read();
+        finished.pulseUs    = (result == HCSR04Status::OK) ? *pulseUs : 0;
+        finished.status     = result;
+
+        sensor.recorder(finished);
+    }
+
+    return result;
+}
+
+void
+EchoCaptureCore::cancel() {
+
+    // make further captures fail right away, and wake up the one in progress (if any)
+    // stale releases of the locks are drained before the next ping, so releasing them without a capture is harmless
+
+    cancelRequested = true;
+
+    pulseStartLock.release();
+    pulseBusyLock.release();
+}
+
+void
+EchoCaptureCore::resume() {
+
+    cancelRequested = false;
+}
+
+void
+EchoCaptureCore::on_edge(const EchoSensor &sensor, size_t index, bool rising) {
+
+    // record the edge (if recording), feed it to the rate limiter of its sensor, and handle the storm if it trips
+    // ignore the edge if its sensor is not being captured, no ping is pending, or it does not fit the pulse (noise on the line)
+    // a rise starts the high-resolution timer and releases pulseStartLock to indicate that the sensor responded to the trigger
+    // a fall stops the timer, stores its measured value, resets it for the next use, and releases pulseBusyLock to indicate that the
+    // pulse has been entirely received
+
+    uint32_t now = us_ticker_read();
+
+    record_edge(sensor.trace.get(), now, rising);
+
+    if (!sensor.edgeLimiter.on_edge(now)) {
+
+        edge_storm_handler(sensor, index);
+        return;
+    }
+
+    if (index != activeSensor) {
+        return;
+    }
+
+    if (rising) {
+
+        if (!echoArmed || pulseStarted) {
+            return;
+        }
+
+        pulseStarted = true;
+
+        pulseTimer.start();
+        pulseStartLock.release();
+        return;
+    }
+
+    if (!pulseStarted) {
+        return;
+    }
+
+    pulseStarted    = false;
+    echoArmed       = false;
+
+    pulseTimer.stop();
+    pulseWidth = chrono::duration_cast<chrono::microseconds>(pulseTimer.elapsed_time()).count();
+
+    pulseTimer.reset();
+    pulseBusyLock.release();
+}
+
+void
+EchoCaptureCore::clear_backoff(const EchoSensor &sensor) {
+
+    // an edge storm keeps its back-off, as its interrupt stays disabled till the back-off has passed (see EchoCaptureCore::capture_pulse())
+
+    if (sensor.edgeLimiter.is_tripped()) {
+        return;
+    }
+
+    sensor.faultCount = 0;
+}
+
+bool
+EchoCaptureCore::set_recorder(const EchoSensor &sensor, const Callback<void(const EchoTrace &)> &cb) {
+
+    // allocate the timings when recording starts, and free them when it stops
+    // the edge handlers use the timings, so they are swapped in a critical section
+
+    std::unique_ptr<EchoTrace> timings;
+
+    if (cb && sensor.trace != nullptr) {
+
+        sensor.recorder = cb;
+        return true;
+    }
+
+    if (cb) {
+
+        timings.reset(new (std::nothrow) EchoTrace {});
+        if (timings == nullptr) {
+            return false;
+        }
+    }
+
+    {
+        CriticalSectionLock lock;
+        sensor.trace.swap(timings);
+    }
+
+    sensor.recorder = cb;
+    return true;
+}
+
+// Private methods
+
+HCSR04Status
+EchoCaptureCore::capture_pulse(const EchoSensor &sensor, size_t index, uint32_t *pulseUs) {
+
+    // if the sensor is unbound (its pins could not be allocated), fail as if the sensor were missing
+    // if captures were cancelled, fail immediately without pinging the sensor
+    // if the sensor is backing off after a fault, fail immediately without pinging it
+    // if the interrupt was disabled due to an edge storm and the back-off has passed, re-arm the limiter and listen again
+    // (the back-off of a storm is never cleared early, see EchoCaptureCore::clear_backoff(), so the line is only listened to once it has passed)
+    // drain stale releases of the locks (a late pulse from a previous timed-out capture) before pinging
+    // if the echo line is already high, then the sensor can not respond to the trigger, so do not ping it
+    //
+    // make the sensor the active one and arm the echo handlers, so that the edges of other sensors leave the capture alone
+    // start a pulse and wait a short while for the returned pulse to start, the lock is released in EchoCaptureCore::on_edge()
+    // if the pulse does not start, the echo line is stuck low (sensor missing or broken wire)
+    //
+    // sleep on the lock while the pulse does not return
+    // the lock is released in EchoCaptureCore::on_edge() when the pulse is completely received
+    // if the pulse is still not complete after waiting, the capture was cancelled, an edge storm occurred, or the pulse took
+    // too long (echo line stuck high), in each case disarm the handlers and reset the timer that was left running
+    //
+    // both locks are also released by EchoCaptureCore::edge_storm_handler() and EchoCaptureCore::cancel(), so the flags are checked before waiting
+    //
+    // the time of the attempt is noted first, and replaced by the end of the trigger pulse if the sensor is pinged
+
+    sensor.triggerTime = Kernel::Clock::now();
+
+    if (sensor.echoPin == nullptr) {
+        return sensor.status = HCSR04Status::STUCK_LOW;
+    }
+
+    if (cancelRequested) {
+        return sensor.status = HCSR04Status::CANCELLED;
+    }
+
+    if (sensor.faultCount > 0 && Kernel::Clock::now() < sensor.retryTime) {
+        return sensor.status = HCSR04Status::BACKOFF;
+    }
+
+    if (sensor.edgeLimiter.is_tripped()) {
+
+        sensor.edgeLimiter.rearm();
+        sensor.echoPin->enable_irq();
+    }
+
+    pulseStartLock.try_acquire();
+    pulseBusyLock.try_acquire();
+
+    if (sensor.echoPin->read() != 0) {
+        return record_fault(sensor, HCSR04Status::STUCK_HIGH);
+    }
+
+    pulseStarted    = false;
+    activeSensor    = index;
+    echoArmed       = true;
+
+    start_pulse(*sensor.trigPin);
+    sensor.triggerTime = Kernel::Clock::now();
+    if (sensor.trace != nullptr) {
+        sensor.trace->triggerUs = us_ticker_read();
+    }
+
+    if (!pulseStartLock.try_acquire_for(ECHO_START_TIMEOUT)) {
+
+        echoArmed       = false;
+        activeSensor    = NO_SENSOR;
+        return record_fault(sensor, HCSR04Status::STUCK_LOW);
+    }
+
+    if (!cancelRequested && !sensor.edgeLimiter.is_tripped()) {
+        pulseBusyLock.try_acquire_for(ECHO_SENSOR_TIMEOUT);
+    }
+
+    if (cancelRequested || sensor.edgeLimiter.is_tripped() || pulseStarted) {
+
+        echoArmed       = false;
+        pulseStarted    = false;
+        activeSensor    = NO_SENSOR;
+
+        pulseTimer.stop();
+        pulseTimer.reset();
+
+        if (cancelRequested) {
+            return sensor.status = HCSR04Status::CANCELLED;
+        }
+        return record_fault(sensor, sensor.edgeLimiter.is_tripped() ? HCSR04Status::EDGE_STORM : HCSR04Status::STUCK_HIGH);
+    }
+
+    activeSensor        = NO_SENSOR;
+    *pulseUs            = pulseWidth;
+    sensor.faultCount   = 0;
+    return sensor.status = HCSR04Status::OK;
+}
+
+void
+EchoCaptureCore::edge_storm_handler(const EchoSensor &sensor, size_t index) {
+
+    // stop listening to the line altogether, so that the noise stops costing CPU time
+    // wake up the capture if the sensor is being captured, which notices the tripped limiter and reports the storm
+
+    sensor.echoPin->disable_irq();
+
+    if (index != activeSensor) {
+        return;
+    }
+
+    echoArmed       = false;
+    pulseStarted    = false;
+
+    pulseStartLock.release();
+    pulseBusyLock.release();
+}
+
+__attribute__((always_inline))
+void
+EchoCaptureCore::start_pulse(DigitalOut &trigPin) {
+
+    // send a short 10ms pulse on the sensor
+
+    ThisThread::sleep_for(2ms);
+    trigPin = 1;
+    ThisThread::sleep_for(10ms);
+    trigPin = 0;
+}
+
+void
+EchoCaptureCore::record_edge(EchoTrace *trace, uint32_t now, bool rising) {
+
+    // store the edge if there is room, and count it regardless, so that a replay knows that edges are missing
+
+    uint16_t index;
+
+    if (trace == nullptr) {
+        return;
+    }
+
+    index = trace->edgeCount;
+
+    if (index < ECHO_TRACE_MAX_EDGES) {
+
+        trace->edgesUs[index] = now;
+        if (rising) {
+            trace->risingMask |= 1u << index;
+        }
+    }
+
+    if (index < UINT16_MAX) {
+        trace->edgeCount = index + 1;
+    }
+}
+
+HCSR04Status
+EchoCaptureCore::record_fault(const EchoSensor &sensor, HCSR04Status fault) {
+
+    // the back-off doubles with every consecutive fault (see echo_backoff())
+
+    sensor.retryTime = Kernel::Clock::now() + echo_backoff(sensor.faultCount);
+
+    if (sensor.faultCount < UINT8_MAX) {
+        ++sensor.faultCount;
+    }
+    return sensor.status = fault;
+}
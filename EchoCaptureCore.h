@@ -0,0 +1,207 @@
+/**
+ * @file                    EchoCaptureCore.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Capture engine of the echo pulse of an HCSR04 ultrasonic sensor, shared by EchoCapture and EchoCaptureBank
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __ECHOCAPTURECORE_H__
+#define __ECHOCAPTURECORE_H__
+
+#include <cstddef>
+#include <memory>
+
+#include "mbed.h"
+#include "EchoTrace.h"
+#include "EdgeRateLimiter.h"
+#include "HCSR04Status.h"
+
+/**
+ * @brief                   State of a single sensor, as seen by EchoCaptureCore
+ *
+ * @remarks                 The state lives wherever its owner lays it out (in the members of an EchoCapture, or in the arrays of an
+ *                          EchoCaptureBank), and is only referred to here, so that the engine does not depend on the layout
+ */
+struct EchoSensor {
+
+    /** Trigger Pin of the sensor (nullptr if the sensor is unbound) */
+    DigitalOut      *trigPin;
+    /** Echo Pin of the sensor (nullptr if the sensor is unbound) */
+    InterruptIn     *echoPin;
+    /** Rate limiter to detect a storm of edges on the echo line */
+    EdgeRateLimiter &edgeLimiter;
+    /** Outcome of the most recent capture */
+    HCSR04Status    &status;
+    /** Number of consecutive faults, used as the exponent of the retry back-off */
+    uint8_t         &faultCount;
+    /** Earliest point in time at which the sensor is pinged again after a fault */
+    Kernel::Clock::time_point   &retryTime;
+    /** Point in time at which the most recent ping was sent, or at which the capture gave up if it did not ping the sensor */
+    Kernel::Clock::time_point   &triggerTime;
+    /** Timings of the capture in progress and the edges since the previous one (only allocated while recording) */
+    std::unique_ptr<EchoTrace>  &trace;
+    /** Callback that receives the timings of every capture (unset if captures are not recorded) */
+    Callback<void(const EchoTrace &)>   &recorder;
+};
+
+/**
+ * @brief                   Class that triggers a sensor and measures the width of the returned pulse using an InterruptIn and a Timer, handles
+ *                          its faults (stuck echo line, edge storms), backs off exponentially after them and records its timings
+ *
+ * @remarks                 Owns the state of the capture in progress (the timer, the Semaphores and the flags), which exists once however many
+ *                          sensors are captured through it, as it captures a single sensor at a time
+ * @remarks                 The owner keeps the state of each sensor, passes it in as an EchoSensor with an index that identifies the sensor,
+ *                          and forwards the edges of the echo line of each sensor to EchoCaptureCore::on_edge()
+ */
+class EchoCaptureCore {
+
+    /** Index passed for the active sensor while no sensor is being captured */
+    static constexpr size_t NO_SENSOR = SIZE_MAX;
+
+    /** Microsecond timer to measure the duration of a pulse */
+    Timer           pulseTimer;
+    /** Width of the most recently received pulse in microseconds */
+    uint32_t        pulseWidth {0};
+
+    /** Index of the sensor being captured (NO_SENSOR if none), whose edges are the only ones measured */
+    volatile size_t activeSensor {NO_SENSOR};
+    /** Whether a ping was sent and its returned pulse is expected (edges are ignored otherwise) */
+    volatile bool   echoArmed {false};
+    /** Whether the start of the returned pulse has been received */
+    volatile bool   pulseStarted {false};
+    /** Whether captures should be cancelled instead of pinging the sensor */
+    volatile bool   cancelRequested {false};
+
+    /** Semaphore to indicate whether the start of a pulse has been received or not */
+    Semaphore       pulseStartLock;
+    /** Semaphore to indicate whether a complete pulse has been received or not */
+    Semaphore       pulseBusyLock;
+
+public:
+
+    /**
+     * @brief               Construct a new EchoCaptureCore object, with no capture in progress
+     */
+    EchoCaptureCore();
+
+    EchoCaptureCore(const EchoCaptureCore &) = delete;
+    EchoCaptureCore &operator=(const EchoCaptureCore &) = delete;
+
+    /**
+     * @brief               Pings a sensor (unless it is backing off or cancelled) and waits for the returned pulse, recording its timings
+     *                      if the sensor has a recorder
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently, even for different sensors
+     *
+     * @param sensor        State of the sensor
+     * @param index         Index of the sensor, as passed to EchoCaptureCore::on_edge()
+     * @param pulseUs       Location to store the width of the returned pulse in microseconds (only written if successful)
+     *
+     * @return              Outcome of the capture, HCSR04Status::OK if the pulse was received completely
+     */
+    HCSR04Status    capture(const EchoSensor &sensor, size_t index, uint32_t *pulseUs);
+
+    /**
+     * @brief               Cancels the capture in progress (if any) and makes all further captures fail immediately till EchoCaptureCore::resume() is called
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            cancel();
+
+    /**
+     * @brief               Allows captures again after EchoCaptureCore::cancel()
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            resume();
+
+    /**
+     * @brief               Handler for an edge on the echo line of a sensor
+     *
+     * @remarks             Every edge feeds the edge-storm detection of its sensor, while only those of the sensor being captured are measured
+     *
+     * @attention           Must only be called from the edge interrupts of the echo line
+     *
+     * @param sensor        State of the sensor
+     * @param index         Index of the sensor, as passed to EchoCaptureCore::capture()
+     * @param rising        Whether the edge is a rise
+     */
+    void            on_edge(const EchoSensor &sensor, size_t index, bool rising);
+
+    /**
+     * @brief               Forgets the consecutive faults of a sensor, unless its echo line is in an edge storm (see EchoCapture::clear_backoff())
+     *
+     * @attention           Must not be called while the sensor is being captured
+     *
+     * @param sensor        State of the sensor
+     */
+    static void     clear_backoff(const EchoSensor &sensor);
+
+    /**
+     * @brief               Sets a callback that receives the raw timings of every capture of a sensor (see EchoCapture::set_recorder())
+     *
+     * @attention           Must not be called while the sensor is being captured
+     *
+     * @param sensor        State of the sensor
+     * @param cb            Callback with the timings of the capture as argument (nullptr to stop recording and free the timings)
+     *
+     * @return              true if the recorder was set, false if the timings could not be allocated
+     */
+    static bool     set_recorder(const EchoSensor &sensor, const Callback<void(const EchoTrace &)> &cb);
+
+private:
+
+    /**
+     * @brief           Helper function to ping the sensor and wait for the returned pulse (see EchoCaptureCore::capture())
+     *
+     * @param sensor    State of the sensor
+     * @param index     Index of the sensor
+     * @param pulseUs   Location to store the width of the returned pulse in microseconds
+     *
+     * @return          Outcome of the capture
+     */
+    HCSR04Status    capture_pulse(const EchoSensor &sensor, size_t index, uint32_t *pulseUs);
+
+    /**
+     * @brief           Handler for a storm of edges on the echo line of a sensor
+     *
+     * @remarks         Disables the interrupt on the Echo pin and wakes up the capture waiting for the pulse if the sensor is being captured
+     *
+     * @param sensor    State of the sensor
+     * @param index     Index of the sensor
+     */
+    void            edge_storm_handler(const EchoSensor &sensor, size_t index);
+
+    /**
+     * @brief           Helper function to send a pulse to the sensor's Trig pin
+     *
+     * @param trigPin   Trigger Pin of the sensor
+     */
+    __attribute__((always_inline))
+    static void     start_pulse(DigitalOut &trigPin);
+
+    /**
+     * @brief           Helper function to store the time and direction of an edge on the Echo pin while recording
+     *
+     * @param trace     Timings of the sensor (nullptr if not recording)
+     * @param now       Time of the edge
+     * @param rising    Whether the edge is rising
+     */
+    static void     record_edge(EchoTrace *trace, uint32_t now, bool rising);
+
+    /**
+     * @brief           Helper function to record a fault of the sensor and schedule the next retry
+     *
+     * @param sensor    State of the sensor
+     * @param fault     Type of fault that occurred
+     *
+     * @return          The fault
+     */
+    static HCSR04Status record_fault(const EchoSensor &sensor, HCSR04Status fault);
+};
+
+#endif //__ECHOCAPTURECORE_H__
@@ -0,0 +1,46 @@
+/**
+ * @file                    EchoTiming.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Timing limits of a capture of the echo pulse, shared by every class that captures pulses
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __ECHOTIMING_H__
+#define __ECHOTIMING_H__
+
+#include <cstdint>
+
+#include "mbed.h"
+
+/** Maximum Distance the sensor should be able to measure before readings are considered invalid/too far away */
+constexpr auto      ECHO_MAX_DISTANCE       = 300;
+/** Timeout of the sensor based on the maximum distance it can measure */
+constexpr auto      ECHO_SENSOR_TIMEOUT     = ECHO_MAX_DISTANCE * 20'000ms / 343;
+/** Time within which the sensor must start the returned pulse after being triggered before its Echo pin is considered stuck low */
+constexpr auto      ECHO_START_TIMEOUT      = 5ms;
+/** Back-off after the first fault, doubled with every consecutive fault */
+constexpr auto      ECHO_BACKOFF_BASE       = 100ms;
+/** Maximum exponent of the back-off (the back-off never exceeds ECHO_BACKOFF_BASE * 2^ECHO_MAX_BACKOFF_SHIFT) */
+constexpr uint8_t   ECHO_MAX_BACKOFF_SHIFT  = 6;
+/** Length of the window over which edges on the echo line are counted (in microseconds) */
+constexpr uint32_t  ECHO_STORM_WINDOW_US    = 10'000;
+/** Maximum edges allowed within a window, a working sensor produces two edges per ping and pings are further apart */
+constexpr uint32_t  ECHO_STORM_MAX_EDGES    = 16;
+
+/**
+ * @brief                   Get the time for which a sensor is not pinged after a fault
+ *
+ * @param faultCount        Number of consecutive faults before this one
+ *
+ * @return                  Back-off, doubled with every consecutive fault till it saturates at ECHO_BACKOFF_BASE * 2^ECHO_MAX_BACKOFF_SHIFT
+ */
+inline std::chrono::milliseconds
+echo_backoff(uint8_t faultCount) {
+
+    return ECHO_BACKOFF_BASE * (1 << ((faultCount < ECHO_MAX_BACKOFF_SHIFT) ? faultCount : ECHO_MAX_BACKOFF_SHIFT));
+}
+
+#endif //__ECHOTIMING_H__
@@ -0,0 +1,108 @@
+#include "EchoTrace.h"
+
+/**
+ * @brief                   Writes a 16-bit value in little-endian order
+ */
+static inline void
+put_u16(uint8_t *out, uint16_t value) {
+
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+/**
+ * @brief                   Writes a 32-bit value in little-endian order
+ */
+static inline void
+put_u32(uint8_t *out, uint32_t value) {
+
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+}
+
+/**
+ * @brief                   Reads a 16-bit value in little-endian order
+ */
+static inline uint16_t
+get_u16(const uint8_t *in) {
+
+    return in[0] | (in[1] << 8);
+}
+
+/**
+ * @brief                   Reads a 32-bit value in little-endian order
+ */
+static inline uint32_t
+get_u32(const uint8_t *in) {
+
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+// Functions
+
+size_t
+echo_trace_pack(const EchoTrace &trace, uint8_t *out) {
+
+    // fixed header, followed by the stored edges
+
+    uint8_t stored = echo_trace_stored_edges(trace);
+
+    put_u32(out, trace.startUs);
+    put_u32(out + 4, trace.triggerUs);
+    put_u32(out + 8, trace.endUs);
+    put_u32(out + 12, trace.pulseUs);
+    put_u32(out + 16, trace.risingMask);
+    put_u16(out + 20, trace.edgeCount);
+    out[22] = trace.startLevel;
+    out[23] = (uint8_t)trace.status;
+
+    for (uint8_t i = 0; i < stored; ++i) {
+        put_u32(out + ECHO_TRACE_HEADER_SIZE + 4 * i, trace.edgesUs[i]);
+    }
+
+    return ECHO_TRACE_HEADER_SIZE + 4 * stored;
+}
+
+size_t
+echo_trace_unpack(const uint8_t *in, size_t size, EchoTrace *trace) {
+
+    // a capture never reports HCSR04Status::REJECTED (the filter does), so any larger value is not a trace
+    // the number of stored edges follows from the number of edges seen, and they must all be available
+
+    uint16_t    edgeCount;
+    uint8_t     stored;
+
+    if (size < ECHO_TRACE_HEADER_SIZE || in[23] >= (uint8_t)HCSR04Status::REJECTED || in[22] > 1) {
+        return 0;
+    }
+
+    edgeCount   = get_u16(in + 20);
+    stored      = (edgeCount < ECHO_TRACE_MAX_EDGES) ? edgeCount : ECHO_TRACE_MAX_EDGES;
+
+    if (size < ECHO_TRACE_HEADER_SIZE + 4 * stored) {
+        return 0;
+    }
+
+    trace->startUs      = get_u32(in);
+    trace->triggerUs    = get_u32(in + 4);
+    trace->endUs        = get_u32(in + 8);
+    trace->pulseUs      = get_u32(in + 12);
+    trace->risingMask   = get_u32(in + 16);
+    trace->edgeCount    = edgeCount;
+    trace->startLevel   = in[22];
+    trace->status       = (HCSR04Status)in[23];
+
+    for (uint8_t i = 0; i < stored; ++i) {
+        trace->edgesUs[i] = get_u32(in + ECHO_TRACE_HEADER_SIZE + 4 * i);
+    }
+
+    return ECHO_TRACE_HEADER_SIZE + 4 * stored;
+}
+
+uint8_t
+echo_trace_stored_edges(const EchoTrace &trace) {
+
+    return (trace.edgeCount < ECHO_TRACE_MAX_EDGES) ? trace.edgeCount : ECHO_TRACE_MAX_EDGES;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file                    EchoTrace.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Raw timings of the measurement attempts of an HCSR04 sensor, to record them on a device and replay them on a host
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __ECHOTRACE_H__
+#define __ECHOTRACE_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "HCSR04Status.h"
+
+/** Maximum number of edges of the echo line stored in a trace (further edges are only counted) */
+constexpr uint8_t   ECHO_TRACE_MAX_EDGES        = 32;
+/** Size of a trace without edges packed by echo_trace_pack() in bytes */
+constexpr size_t    ECHO_TRACE_HEADER_SIZE      = 24;
+/** Largest size of a trace packed by echo_trace_pack() in bytes */
+constexpr size_t    ECHO_TRACE_MAX_PACKED_SIZE  = ECHO_TRACE_HEADER_SIZE + 4 * ECHO_TRACE_MAX_EDGES;
+
+/**
+ * @brief                   Timings of a single measurement attempt, and of every edge seen on the echo line since the previous attempt, as
+ *                          recorded by EchoCapture::set_recorder()
+ *
+ * @remarks                 Timestamps are read from the microsecond ticker (us_ticker_read()) and wrap around
+ * @remarks                 The edges include noise and edges that arrive between attempts, as they all feed the edge-storm detection, but not
+ *                          edges that arrive while the interrupt of the echo line is disabled after a storm (the device never sees those)
+ */
+struct EchoTrace {
+
+    /** Time at which the attempt started */
+    uint32_t        startUs;
+    /** Time at which the trigger pulse ended (0 if the sensor was not pinged) */
+    uint32_t        triggerUs;
+    /** Time at which the attempt ended */
+    uint32_t        endUs;
+    /** Width of the echo pulse in microseconds, as measured by the capture (only meaningful if the status is HCSR04Status::OK) */
+    uint32_t        pulseUs;
+    /** Times of the edges on the echo line since the previous attempt ended, in order (the first ECHO_TRACE_MAX_EDGES of them) */
+    uint32_t        edgesUs[ECHO_TRACE_MAX_EDGES];
+    /** Direction of the stored edges, bit i is set if edge i was rising */
+    uint32_t        risingMask;
+    /** Number of edges seen, larger than ECHO_TRACE_MAX_EDGES if some were not stored */
+    uint16_t        edgeCount;
+    /** Level of the echo line when the attempt started */
+    uint8_t         startLevel;
+    /** Outcome of the attempt */
+    HCSR04Status    status;
+};
+
+/**
+ * @brief                   Packs a trace into bytes in little-endian order, to store it in a file independently of the layout of the struct
+ *
+ * @remarks                 Only the stored edges are packed, so the size depends on the number of edges
+ *
+ * @param trace             Trace to pack
+ * @param out               Location to write the bytes to, at least ECHO_TRACE_MAX_PACKED_SIZE bytes
+ *
+ * @return                  Number of bytes written
+ */
+size_t              echo_trace_pack(const EchoTrace &trace, uint8_t *out);
+
+/**
+ * @brief                   Unpacks a trace packed by echo_trace_pack()
+ *
+ * @param in                Packed bytes
+ * @param size              Number of bytes available
+ * @param trace             Location to store the trace
+ *
+ * @return                  Number of bytes of the trace, 0 if the bytes do not hold a complete and valid trace (nothing is stored)
+ */
+size_t              echo_trace_unpack(const uint8_t *in, size_t size, EchoTrace *trace);
+
+/**
+ * @brief                   Get the number of edges stored in a trace
+ *
+ * @param trace             Trace
+ *
+ * @return                  Number of edges in EchoTrace::edgesUs
+ */
+uint8_t             echo_trace_stored_edges(const EchoTrace &trace);
+
+#endif //__ECHOTRACE_H__
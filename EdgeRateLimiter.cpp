@@ -0,0 +1,58 @@
+#include "EdgeRateLimiter.h"
+
+// Constructors
+
+EdgeRateLimiter::EdgeRateLimiter(uint32_t windowUs, uint32_t maxEdges)
+        : windowUs(windowUs)
+        , maxEdges(maxEdges)
+{
+}
+
+// Public Methods
+
+bool
+EdgeRateLimiter::on_edge(uint32_t nowUs) {
+
+    // ignore all edges once tripped, till the limiter is re-armed
+    // start a new window if the current one has elapsed (unsigned subtraction handles wrap-around of the timestamps)
+    // count the edge and trip if the window now contains too many edges
+
+    if (tripped) {
+        return false;
+    }
+
+    if (edgeCount == 0 || (uint32_t)(nowUs - windowStart) >= windowUs) {
+
+        windowStart = nowUs;
+        edgeCount   = 0;
+    }
+
+    if (++edgeCount > maxEdges) {
+
+        tripped = true;
+        ++tripCount;
+
+        return false;
+    }
+
+    return true;
+}
+
+void
+EdgeRateLimiter::rearm() {
+
+    edgeCount   = 0;
+    tripped     = false;
+}
+
+bool
+EdgeRateLimiter::is_tripped() const {
+
+    return tripped;
+}
+
+uint32_t
+EdgeRateLimiter::get_trip_count() const {
+
+    return tripCount;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file                    EdgeRateLimiter.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Rate limiter to detect storms of edges on a noisy interrupt line
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __EDGERATELIMITER_H__
+#define __EDGERATELIMITER_H__
+
+#include <cstdint>
+
+/**
+ * @brief                   Class that counts edges on an interrupt line within fixed windows of time and trips once too many are seen
+ *
+ * @remarks                 The class does not depend on MBed OS, timestamps are supplied by the caller, which allows
+ *                          it to be driven by a simulated pin on a host
+ */
+class EdgeRateLimiter {
+
+    /** Length of a counting window in microseconds */
+    uint32_t        windowUs;
+    /** Maximum number of edges allowed within a single window */
+    uint32_t        maxEdges;
+
+    /** Timestamp (in microseconds) at which the current window started */
+    uint32_t        windowStart {0};
+    /** Number of edges seen in the current window */
+    uint32_t        edgeCount {0};
+
+    /** Whether the limiter has tripped and not been re-armed since */
+    volatile bool   tripped {false};
+    /** Number of times the limiter has tripped */
+    uint32_t        tripCount {0};
+
+public:
+
+    EdgeRateLimiter() = delete;
+
+    /**
+     * @brief               Construct a new EdgeRateLimiter object
+     *
+     * @param windowUs      Length of a counting window in microseconds
+     * @param maxEdges      Maximum number of edges allowed within a single window
+     */
+    EdgeRateLimiter(uint32_t windowUs, uint32_t maxEdges);
+
+    /**
+     * @brief               Records an edge on the line
+     *
+     * @remarks             Timestamps are allowed to wrap around
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param nowUs         Timestamp of the edge in microseconds
+     *
+     * @return              true if the edge should be processed, false if the limiter has tripped
+     */
+    bool            on_edge(uint32_t nowUs);
+
+    /**
+     * @brief               Re-arms a tripped limiter and starts a new window on the next edge
+     *
+     * @attention           Must not be called concurrently with EdgeRateLimiter::on_edge() (disable the interrupt first)
+     */
+    void            rearm();
+
+    /**
+     * @brief               Checks if the limiter has tripped
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if the limiter has tripped and not been re-armed, false otherwise
+     */
+    bool            is_tripped() const;
+
+    /**
+     * @brief               Get the number of times the limiter has tripped
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              Number of times the limiter has tripped
+     */
+    uint32_t        get_trip_count() const;
+};
+
+#endif //__EDGERATELIMITER_H__
@@ -0,0 +1,463 @@
+/**
+ * @file                    HCSR04Array.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Library to use a fixed array of HCSR04 ultrasonic sensors with MBed OS asynchronously, sharing a single thread
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __HCSR04ARRAY_H__
+#define __HCSR04ARRAY_H__
+
+#include <cstddef>
+
+#include "mbed.h"
+#include "DispatchThread.h"
+#include "EchoCaptureBank.h"
+#include "HCSR04Units.h"
+#include "SpeedOfSound.h"
+
+/**
+ * @brief                   Class that provides a simple interface to use a fixed array of HCSR04 ultrasonic sensors asynchronously
+ *
+ * @remarks                 All sensors share a single thread and EventQueue (see DispatchThread), and are measured one after the other (which
+ *                          also avoids crosstalk) by a single capture engine, while the state of the sensors is laid out as a struct of arrays
+ *                          (see EchoCaptureBank) with their pins constructed in place
+ * @remarks                 The sensors are captured by the same engine as HCSR04 (see EchoCaptureCore), so they handle faults the same way,
+ *                          timestamp their pings and can be recorded
+ * @remarks                 Results are delivered by calling Handler::on_measurement(size_t index, bool valid, float dist) on the thread,
+ *                          which is resolved at compile-time instead of through a Callback
+ * @remarks                 Compared to N independent HCSR04 objects, the thread (and its stack), EventQueue, Timer and Semaphores are only paid for
+ *                          once, while each sensor costs HCSR04Array::PER_SENSOR_BYTES, with no heap allocation
+ *
+ * @tparam N                Number of sensors
+ * @tparam Pins             Table of the pins of each sensor (must have static storage duration, typically a constexpr array)
+ * @tparam Handler          Type with a static on_measurement(size_t index, bool valid, float dist) function
+ */
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+class HCSR04Array {
+
+    static_assert(N > 0, "HCSR04Array requires at least one sensor");
+
+    /** Capture of the echo pulses of all sensors */
+    EchoCaptureBank<N, Pins>    captures;
+    /** Most recent distance measured by each sensor */
+    float           distances[N] {};
+    /** Conversion of the width of the pulse into a distance, shared by all sensors as they share the air */
+    Centimetres     unit;
+
+    /** Number of non-periodic measurements pending in the queue */
+    uint32_t        pendingMeasurementCount {0};
+    /** Thread and queue on which the sensors are measured (declared last, so that it is stopped before the state it uses is destroyed) */
+    DispatchThread  dispatch;
+
+public:
+
+    /** Number of bytes of RAM used by the state of each sensor, including its pins (the shared thread, queue and capture engine are not included) */
+    static constexpr size_t PER_SENSOR_BYTES = EchoCaptureBank<N, Pins>::PER_SENSOR_BYTES + sizeof(float);
+
+    /**
+     * @brief               Construct a new HCSR04Array object, binding each sensor to its pins from the table
+     */
+    HCSR04Array();
+
+    HCSR04Array(const HCSR04Array &) = delete;
+    HCSR04Array     &operator=(const HCSR04Array &) = delete;
+
+    /**
+     * @brief               Destroy the HCSR04Array object, stopping periodic measurement, cancelling pending measurements and finalizing it first if required
+     *
+     * @attention           Can not call this method from ISR context
+     */
+    ~HCSR04Array();
+
+    /**
+     * @brief               Initializes the object by allocating and starting the thread to dispatch callbacks on (see HCSR04::initialize())
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully allocated and started, false otherwise
+     */
+    bool            initialize();
+
+    /**
+     * @brief               Finalizes the object by stopping and freeing the thread on which callbacks are dispatched (see HCSR04::finalize())
+     *
+     * @remarks             The object can not be finalized as long as there are pending non-periodic measurements or a periodic measurement
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully stopped and freed, false otherwise
+     */
+    bool            finalize();
+
+    /**
+     * @brief               Checks if the object was initialized and callbacks can be dispatched correctly
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if the thread is running, false otherwise
+     */
+    bool            is_initialized() const;
+
+    /**
+     * @brief               Asynchronously measures the distance from a single sensor and returns immediately
+     *
+     * @remarks             As long as periodic measurement is started, this function will always return false
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param index         Index of the sensor in the pin table
+     *
+     * @return              true if the request to start a measurement could successfully be enqueued, false otherwise
+     */
+    bool            do_measurement(size_t index);
+
+    /**
+     * @brief               Asynchronously measures the distance from all sensors one after the other and returns immediately
+     *
+     * @remarks             As long as periodic measurement is started, this function will always return false
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if the request to start the measurements could successfully be enqueued, false otherwise
+     */
+    bool            do_scan();
+
+    /**
+     * @brief               Get the number of pending non-periodic measurements (a scan counts as one)
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              Number of pending non-periodic measurements
+     */
+    uint32_t        get_pending_measurement_count() const;
+
+    /**
+     * @brief               Starts periodically measuring the distance from all sensors one after the other, and returns immediately
+     *
+     * @remarks             As long as there are pending non-periodic measurements, periodic measurement can not be started
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param period        Time period between the start of two scans
+     *
+     * @return              true if the request to start the measurements could successfully be enqueued, false otherwise
+     */
+    bool            start_scan_periodic(std::chrono::milliseconds period);
+
+    /**
+     * @brief               Stops periodically measuring the distance
+     *
+     * @remarks             If a scan was happening while this function was called, the scan is completed first
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            stop_scan_periodic();
+
+    /**
+     * @brief               Checks if periodic measurement was started
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if periodic measurement is started, false otherwise
+     */
+    bool            is_periodic_started() const;
+
+    /**
+     * @brief               Get the outcome of the most recent measurement attempt of a sensor
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param index         Index of the sensor in the pin table
+     *
+     * @return              Status of the most recent measurement attempt
+     */
+    HCSR04Status    get_status(size_t index) const;
+
+    /**
+     * @brief               Get the point in time at which the most recent measurement attempt of a sensor pinged it (see EchoCapture::get_trigger_time())
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param index         Index of the sensor in the pin table
+     *
+     * @return              Point in time of the most recent ping
+     */
+    Kernel::Clock::time_point get_trigger_time(size_t index) const;
+
+    /**
+     * @brief               Sets a callback that receives the raw timings of every capture of a sensor (see EchoCapture::set_recorder())
+     *
+     * @remarks             The callback is called on the thread of the array, after the capture is complete
+     *
+     * @attention           Must not be called while a measurement or periodic measurement is pending
+     *
+     * @param index         Index of the sensor in the pin table
+     * @param cb            Callback with the timings of the capture as argument (nullptr to stop recording and free the timings)
+     *
+     * @return              true if the recorder was set, false if the index is out of range or the timings could not be allocated
+     */
+    bool            set_recorder(size_t index, const Callback<void(const EchoTrace &)> &cb);
+
+    /**
+     * @brief               Get the most recent distance successfully measured by a sensor
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @param index         Index of the sensor in the pin table
+     *
+     * @return              Most recent distance measured by the sensor
+     */
+    float           get_distance(size_t index) const;
+
+    /**
+     * @brief               Updates the temperature (and optionally humidity) of the air for all sensors (see BasicHCSR04::set_temperature())
+     *
+     * @attention           This function can be called from ISR context, and while measurements are in progress
+     *
+     * @param celsius           Temperature of the air in degrees Celsius
+     * @param relativeHumidity  Relative humidity of the air in percent (0 to 100)
+     */
+    void            set_temperature(float celsius, float relativeHumidity = 0.0f);
+
+    /**
+     * @brief               Get the number of sensors
+     *
+     * @return              Number of sensors
+     */
+    static constexpr size_t size() { return N; }
+
+private:
+
+    /**
+     * @brief           Measures the distance from a single sensor and reports it to the handler
+     *
+     * @param index     Index of the sensor in the pin table
+     */
+    void            measure(size_t index);
+
+    /**
+     * @brief           Measures the distance from all sensors one after the other and reports each to the handler
+     */
+    void            scan();
+};
+
+// Constructors
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+HCSR04Array<N, Pins, Handler>::HCSR04Array() = default;
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+HCSR04Array<N, Pins, Handler>::~HCSR04Array() {
+
+    // stop the periodic measurement (if any) and cancel the pending measurements
+    // wait for the cancelled measurements and the periodic event to drain, and terminate the thread as in finalize()
+
+    if (!is_initialized()) {
+        return;
+    }
+
+    dispatch.stop_periodic();
+    captures.cancel();
+    do {
+        dispatch.drain();
+    } while (dispatch.is_periodic_started());
+
+    pendingMeasurementCount = 0;
+    finalize();
+}
+
+// Public Methods
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+bool
+HCSR04Array<N, Pins, Handler>::initialize() {
+
+    // start the thread, and allow captures again if they were cancelled by the destructor of a previous run
+
+    if (!dispatch.start()) {
+        return false;
+    }
+
+    captures.resume();
+    return true;
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+bool
+HCSR04Array<N, Pins, Handler>::finalize() {
+
+    // return if there are pending non-periodic measurements; otherwise stop the thread, which fails if it is not running or a scan is periodic
+
+    if (get_pending_measurement_count() > 0) {
+        return false;
+    }
+
+    return dispatch.stop();
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+bool
+HCSR04Array<N, Pins, Handler>::is_initialized() const {
+
+    return dispatch.is_running();
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+bool
+HCSR04Array<N, Pins, Handler>::do_measurement(size_t index) {
+
+    // return if the index is out of range or a periodic event is already registered; move forward otherwise
+    // otherwise, post a non-periodic event to the queue, and increment the pending measurement count if it was successfully posted
+
+    if (index >= N || is_periodic_started()) {
+        return false;
+    }
+
+    auto id = dispatch.get_queue().call([this, index]() {
+
+        measure(index);
+        --pendingMeasurementCount;
+    });
+
+    if (id == 0) {
+        return false;
+    }
+
+    ++pendingMeasurementCount;
+    return true;
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+bool
+HCSR04Array<N, Pins, Handler>::do_scan() {
+
+    // same as do_measurement(), but a single event measures all sensors, so the queue overhead is paid once per scan
+
+    if (is_periodic_started()) {
+        return false;
+    }
+
+    auto id = dispatch.get_queue().call([this]() {
+
+        scan();
+        --pendingMeasurementCount;
+    });
+
+    if (id == 0) {
+        return false;
+    }
+
+    ++pendingMeasurementCount;
+    return true;
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+uint32_t
+HCSR04Array<N, Pins, Handler>::get_pending_measurement_count() const {
+
+    return pendingMeasurementCount;
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+bool
+HCSR04Array<N, Pins, Handler>::start_scan_periodic(std::chrono::milliseconds period) {
+
+    // return if there are pending non-periodic measurements; move forward otherwise
+    // otherwise, post a periodic event to the queue, where all sensors are measured
+
+    if (get_pending_measurement_count() > 0) {
+        return false;
+    }
+
+    return dispatch.start_periodic(period, callback(this, &HCSR04Array::scan));
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+void
+HCSR04Array<N, Pins, Handler>::stop_scan_periodic() {
+
+    dispatch.stop_periodic();
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+bool
+HCSR04Array<N, Pins, Handler>::is_periodic_started() const {
+
+    return dispatch.is_periodic_started();
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+HCSR04Status
+HCSR04Array<N, Pins, Handler>::get_status(size_t index) const {
+
+    return captures.get_status(index);
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+Kernel::Clock::time_point
+HCSR04Array<N, Pins, Handler>::get_trigger_time(size_t index) const {
+
+    return captures.get_trigger_time(index);
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+bool
+HCSR04Array<N, Pins, Handler>::set_recorder(size_t index, const Callback<void(const EchoTrace &)> &cb) {
+
+    if (index >= N) {
+        return false;
+    }
+
+    return captures.set_recorder(index, cb);
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+float
+HCSR04Array<N, Pins, Handler>::get_distance(size_t index) const {
+
+    return distances[index];
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+void
+HCSR04Array<N, Pins, Handler>::set_temperature(float celsius, float relativeHumidity) {
+
+    unit.set_speed_of_sound(speed_of_sound(celsius, relativeHumidity));
+}
+
+// Private methods
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+void
+HCSR04Array<N, Pins, Handler>::measure(size_t index) {
+
+    // capture the returned pulse, convert its width into a distance, and report it to the handler
+
+    uint32_t pulse;
+
+    if (captures.capture(index, &pulse) != HCSR04Status::OK) {
+
+        Handler::on_measurement(index, false, 0.0f);
+        return;
+    }
+
+    distances[index] = unit.from_pulse(pulse);
+    Handler::on_measurement(index, true, distances[index]);
+}
+
+template <size_t N, const HCSR04Pins (&Pins)[N], typename Handler>
+void
+HCSR04Array<N, Pins, Handler>::scan() {
+
+    for (size_t i = 0; i < N; ++i) {
+        measure(i);
+    }
+}
+
+#endif //__HCSR04ARRAY_H__
@@ -8,6 +8,19 @@ HCSR04Blocking::HCSR04Blocking(PinName trigPin, PinName echoPin)
 {
 }
 
+HCSR04Blocking::HCSR04Blocking(HCSR04Blocking &&other)
+        : sensor(std::move(other.sensor))
+        , measurementLock(0, 1)
+{
+}
+
+HCSR04Blocking &
+HCSR04Blocking::operator=(HCSR04Blocking &&other) {
+
+    sensor = std::move(other.sensor);
+    return *this;
+}
+
 // Public Methods
 
 bool
@@ -15,11 +28,21 @@ HCSR04Blocking::initialize() {
     return sensor.initialize();
 }
 
+bool
+HCSR04Blocking::initialize_lazy(std::chrono::milliseconds idleTimeout) {
+    return sensor.initialize_lazy(idleTimeout);
+}
+
 bool
 HCSR04Blocking::finalize() {
     return sensor.finalize();
 }
 
+bool
+HCSR04Blocking::finalize_async(std::chrono::milliseconds deadline, const Callback<void()> &cb) {
+    return sensor.finalize_async(deadline, cb);
+}
+
 bool
 HCSR04Blocking::is_initialized() const {
     return sensor.is_initialized();
@@ -28,9 +51,12 @@ HCSR04Blocking::is_initialized() const {
 bool
 HCSR04Blocking::get_distance(float *distPtr) {
 
-    // start the measurement and sleep till the HCSR04 releases the Semaphore in the callback
+    // start the measurement and return if it could not be enqueued (for example, while finalizing); move forward otherwise
+    // sleep till the HCSR04 releases the Semaphore in the callback
 
-    sensor.do_measurement(callback(this, &HCSR04Blocking::distance_cb));
+    if (!sensor.do_measurement(callback(this, &HCSR04Blocking::distance_cb))) {
+        return false;
+    }
     measurementLock.acquire();
 
     if (!noTimeout) {
@@ -40,6 +40,29 @@ public:
      */
     HCSR04Blocking(PinName trigPin, PinName echoPin);
 
+    /**
+     * @brief               Construct a new HCSR04Blocking object by taking over the sensor of another object (see HCSR04::HCSR04(HCSR04 &&))
+     *
+     * @attention           Can not call this method from ISR context, or while the other object is measuring the distance
+     *
+     * @param other         Object whose sensor is taken over
+     */
+    HCSR04Blocking(HCSR04Blocking &&other);
+
+    /**
+     * @brief               Finalizes this object and takes over the sensor of another object (see HCSR04::operator=(HCSR04 &&))
+     *
+     * @attention           Can not call this method from ISR context, or while either object is measuring the distance
+     *
+     * @param other         Object whose sensor is taken over
+     *
+     * @return              Reference to this object
+     */
+    HCSR04Blocking  &operator=(HCSR04Blocking &&other);
+
+    HCSR04Blocking(const HCSR04Blocking &) = delete;
+    HCSR04Blocking  &operator=(const HCSR04Blocking &) = delete;
+
     /**
      * @brief               Initializes the internal HCSR04 object (See HCSR04::initialize())
      *
@@ -54,6 +77,22 @@ public:
      */
     bool            initialize();
 
+    /**
+     * @brief               Initializes the internal HCSR04 object in lazy mode (See HCSR04::initialize_lazy())
+     *
+     * @remarks             The thread is only started when the distance is measured, and stopped again once it has been idle for idleTimeout
+     * @remark              If the object was already initialized, then the HCSR04Blocking::finalize() method must be called
+     *                      before trying to initialize it again
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param idleTimeout   Time without measurements after which the thread is stopped and freed
+     *
+     * @return              true if the object could be initialized, false otherwise
+     */
+    bool            initialize_lazy(std::chrono::milliseconds idleTimeout);
+
     /**
      * @brief               Finalizes the internal HCSR04 object (see HCSR04::finalize())
      *
@@ -68,6 +107,21 @@ public:
      */
     bool            finalize();
 
+    /**
+     * @brief               Finalizes the internal HCSR04 object asynchronously (see HCSR04::finalize_async())
+     *
+     * @remarks             A call to HCSR04Blocking::get_distance() in progress returns false if its measurement is cancelled
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param deadline      Time for which a pending measurement is allowed to complete
+     * @param cb            Callback when the object has been finalized
+     *
+     * @return              true if finalizing was started, false otherwise
+     */
+    bool            finalize_async(std::chrono::milliseconds deadline, const Callback<void()> &cb);
+
     /**
      * @brief               Checks if the object was initialized and callbacks can be dispatched correctly
      *
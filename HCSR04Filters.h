@@ -0,0 +1,229 @@
+/**
+ * @file                    HCSR04Filters.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Filter policies applied to the distances measured by an HCSR04 sensor before they are reported
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __HCSR04FILTERS_H__
+#define __HCSR04FILTERS_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief                   Filter policy that reports every distance unchanged (the default)
+ *
+ * @remarks                 A filter policy provides bool apply(T *value), which is given each successfully measured distance,
+ *                          may replace it with a filtered value, and returns false if the distance should not be reported as valid
+ */
+struct NoFilter {
+
+    /**
+     * @brief               Filters a measured distance
+     *
+     * @param value         Measured distance
+     *
+     * @return              Always true
+     */
+    template <typename T>
+    bool apply(T *) {
+        return true;
+    }
+};
+
+/**
+ * @brief                   Filter policy that reports the median of the most recent N distances
+ *
+ * @remarks                 Until N distances have been measured, the median of the ones measured so far is reported
+ *
+ * @tparam T                Type in which distances are reported (see the unit policies)
+ * @tparam N                Number of distances to take the median of
+ */
+template <typename T, size_t N>
+class MedianFilter {
+
+    static_assert(N > 0, "MedianFilter requires a window of at least one distance");
+
+    /** Most recent distances, in the order in which they were measured (circular) */
+    T               window[N] {};
+    /** Index in the window at which the next distance is stored */
+    size_t          next {0};
+    /** Number of distances in the window */
+    size_t          count {0};
+
+public:
+
+    /**
+     * @brief               Filters a measured distance
+     *
+     * @param value         Measured distance, replaced by the median of the window
+     *
+     * @return              Always true
+     */
+    bool apply(T *value) {
+
+        // store the distance in the window, overwriting the oldest one
+        // insertion-sort a copy of the window (N is small) and pick the middle element
+
+        T sorted[N];
+
+        window[next] = *value;
+        next         = (next + 1) % N;
+        if (count < N) {
+            ++count;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+
+            size_t j;
+
+            for (j = i; j > 0 && sorted[j - 1] > window[i]; --j) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = window[i];
+        }
+
+        *value = sorted[count / 2];
+        return true;
+    }
+};
+
+/**
+ * @brief                   Filter policy that suppresses spikes using a Hampel filter over the most recent N distances
+ *
+ * @remarks                 A distance that deviates from the median of the window by more than the threshold times the scaled median absolute
+ *                          deviation (MAD) of the window is considered a spike, and is replaced by the median
+ * @remarks                 Spikes still enter the window, so that a real step in the distance is followed once it persists for about half the window
+ * @remarks                 Each distance costs two insertion sorts of the window, so the time and memory per distance are bounded by N
+ *
+ * @tparam T                Type in which distances are reported (see the unit policies)
+ * @tparam N                Number of distances in the window
+ */
+template <typename T, size_t N>
+class HampelFilter {
+
+    static_assert(N >= 3, "HampelFilter requires a window of at least three distances");
+
+    /** Most recent distances, in the order in which they were measured (circular) */
+    T               window[N] {};
+    /** Index in the window at which the next distance is stored */
+    size_t          next {0};
+    /** Number of distances in the window */
+    size_t          count {0};
+
+    /** Number of scaled MADs by which a distance must deviate from the median to be a spike */
+    float           threshold {3.0f};
+    /** Smallest deviation that can be a spike, so that a perfectly steady window does not turn every small change into a spike */
+    float           minDeviation {1.0f};
+    /** Number of spikes suppressed */
+    uint32_t        spikeCount {0};
+
+public:
+
+    /**
+     * @brief               Filters a measured distance
+     *
+     * @param value         Measured distance, replaced by the median of the window if it is a spike
+     *
+     * @return              Always true
+     */
+    bool apply(T *value) {
+
+        // store the distance in the window, overwriting the oldest one
+        // find the median of the window, and the median of the absolute deviations from it (scaled to estimate the standard deviation)
+        // a distance is a spike if it deviates by more than the threshold, which is never less than the minimum deviation
+        // spikes are only detected once the window is full, as the median of fewer distances is not robust
+
+        float       sorted[N];
+        float       median;
+        float       mad;
+        float       deviation;
+        float       limit;
+
+        window[next] = *value;
+        next         = (next + 1) % N;
+        if (count < N) {
+
+            ++count;
+            return true;
+        }
+
+        for (size_t i = 0; i < N; ++i) {
+            sorted[i] = (float)window[i];
+        }
+        median = sort_median(sorted);
+
+        for (size_t i = 0; i < N; ++i) {
+            sorted[i] = ((float)window[i] > median) ? (float)window[i] - median : median - (float)window[i];
+        }
+        mad = sort_median(sorted);
+
+        deviation   = ((float)*value > median) ? (float)*value - median : median - (float)*value;
+        limit       = threshold * 1.4826f * mad;
+        if (limit < minDeviation) {
+            limit = minDeviation;
+        }
+
+        if (deviation > limit) {
+
+            *value = (T)median;
+            ++spikeCount;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief               Sets how far a distance must deviate from the median to be a spike
+     *
+     * @attention           Must not be called while measurements are in progress
+     *
+     * @param threshold     Number of scaled MADs (3 is the usual choice, lower values suppress more)
+     * @param minDeviation  Smallest deviation that can be a spike (in the unit in which distances are reported)
+     */
+    void set_threshold(float threshold, float minDeviation) {
+
+        this->threshold     = threshold;
+        this->minDeviation  = minDeviation;
+    }
+
+    /**
+     * @brief               Get the number of spikes suppressed
+     *
+     * @return              Number of spikes
+     */
+    uint32_t get_spike_count() const {
+        return spikeCount;
+    }
+
+private:
+
+    /**
+     * @brief           Helper function to insertion-sort the values (N is small) and pick the middle one
+     *
+     * @param values    Values to sort
+     *
+     * @return          Median of the values
+     */
+    static float sort_median(float (&values)[N]) {
+
+        for (size_t i = 1; i < N; ++i) {
+
+            float   key = values[i];
+            size_t  j;
+
+            for (j = i; j > 0 && values[j - 1] > key; --j) {
+                values[j] = values[j - 1];
+            }
+            values[j] = key;
+        }
+
+        return values[N / 2];
+    }
+};
+
+#endif //__HCSR04FILTERS_H__
@@ -0,0 +1,37 @@
+/**
+ * @file                    HCSR04Status.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Outcome of a measurement attempt of an HCSR04 sensor, shared by the capture policies of the library
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __HCSR04STATUS_H__
+#define __HCSR04STATUS_H__
+
+#include <cstdint>
+
+/**
+ * @brief                   Outcome of the most recent measurement attempt of a sensor
+ */
+enum class HCSR04Status : uint8_t {
+
+    /** The echo pulse was received completely and the distance is valid */
+    OK,
+    /** The echo line never went high after the trigger (sensor missing, unpowered or broken echo wire) */
+    STUCK_LOW,
+    /** The echo line was already high before the trigger, or never fell after rising */
+    STUCK_HIGH,
+    /** No ping was sent because the sensor is backing off after a previous fault */
+    BACKOFF,
+    /** The echo line produced edges faster than a real sensor can, so its interrupt was temporarily disabled */
+    EDGE_STORM,
+    /** The measurement was cancelled because the object is being finalized */
+    CANCELLED,
+    /** The echo pulse was received, but the distance was rejected by the filter */
+    REJECTED
+};
+
+#endif //__HCSR04STATUS_H__
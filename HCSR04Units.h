@@ -0,0 +1,96 @@
+/**
+ * @file                    HCSR04Units.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Unit policies to convert the width of the echo pulse of an HCSR04 sensor into a distance
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __HCSR04UNITS_H__
+#define __HCSR04UNITS_H__
+
+#include <cstdint>
+
+#include "SpeedOfSound.h"
+
+/**
+ * @brief                   Unit policy that reports distances as floating point centimetres (the default)
+ *
+ * @remarks                 A unit policy provides value_type from_pulse(uint32_t pulseUs) and void set_speed_of_sound(float metresPerSecond),
+ *                          the scale factor is precomputed whenever the speed of sound changes, so that each conversion is a single multiplication
+ */
+class Centimetres {
+
+    /** Centimetres per microsecond of echo pulse (half the distance travelled by sound, as the pulse covers the round trip) */
+    volatile float  scale {SPEED_OF_SOUND_DEFAULT / 20'000};
+
+public:
+
+    /** Type in which distances are reported */
+    using value_type = float;
+
+    /**
+     * @brief               Converts the width of the echo pulse into a distance
+     *
+     * @param pulseUs       Width of the echo pulse in microseconds
+     *
+     * @return              Distance in centimetres
+     */
+    value_type from_pulse(uint32_t pulseUs) const {
+        return (float)pulseUs * scale;
+    }
+
+    /**
+     * @brief               Updates the speed of sound used for the conversion
+     *
+     * @attention           This function can be called from ISR context, and concurrently with Centimetres::from_pulse()
+     *
+     * @param metresPerSecond   Speed of sound in metres per second
+     */
+    void set_speed_of_sound(float metresPerSecond) {
+        scale = metresPerSecond / 20'000;
+    }
+};
+
+/**
+ * @brief                   Unit policy that reports distances as integer millimetres, without any floating point operations per sample
+ */
+class Millimetres {
+
+    /** Millimetres per microsecond of echo pulse as an unsigned Q16.16 fixed-point value */
+    volatile uint32_t   scaleQ16 {(uint32_t)(SPEED_OF_SOUND_DEFAULT / 2'000 * 65'536 + 0.5f)};
+
+public:
+
+    /** Type in which distances are reported */
+    using value_type = uint32_t;
+
+    /**
+     * @brief               Converts the width of the echo pulse into a distance (rounded to the nearest millimetre)
+     *
+     * @remarks             The product is formed in 64 bits (a single long multiply on Cortex-M3 and above), so that pulses longer than
+     *                      about 380ms (which a stuck echo line can produce before the timeout) do not wrap around into plausible distances
+     *
+     * @param pulseUs       Width of the echo pulse in microseconds
+     *
+     * @return              Distance in millimetres
+     */
+    value_type from_pulse(uint32_t pulseUs) const {
+        return (value_type)(((uint64_t)pulseUs * scaleQ16 + 32'768) >> 16);
+    }
+
+    /**
+     * @brief               Updates the speed of sound used for the conversion
+     *
+     * @attention           This function can be called from ISR context, and concurrently with Millimetres::from_pulse()
+     *
+     * @param metresPerSecond   Speed of sound in metres per second
+     */
+    void set_speed_of_sound(float metresPerSecond) {
+        scaleQ16 = (uint32_t)(metresPerSecond / 2'000 * 65'536 + 0.5f);
+    }
+};
+
+#endif //__HCSR04UNITS_H__
@@ -0,0 +1,75 @@
+#include "OccupancyDetector.h"
+
+// Constructors
+
+OccupancyDetector::OccupancyDetector(const OccupancyConfig &config)
+        : config(config)
+{
+}
+
+// Public Methods
+
+bool
+OccupancyDetector::add(uint32_t timeMs, bool valid, float value) {
+
+    // while vacant, a distance below the enter distance agrees on occupied, and while occupied, a distance above the exit distance
+    // (or a failed measurement) agrees on vacant, any other distance restarts the streak
+    // the first distance of a streak notes its start time
+    // once the streak is long enough in both count and time, switch the state and restart the streak
+
+    bool        agrees;
+    uint32_t    count;
+    uint32_t    dwellMs;
+
+    if (!occupied) {
+
+        agrees  = valid && value < config.enterDistance;
+        count   = config.enterCount;
+        dwellMs = config.enterDwellMs;
+    }
+    else {
+
+        agrees  = !valid || value > config.exitDistance;
+        count   = config.exitCount;
+        dwellMs = config.exitDwellMs;
+    }
+
+    if (!agrees) {
+
+        streakCount = 0;
+        return false;
+    }
+
+    if (streakCount == 0) {
+        streakStartMs = timeMs;
+    }
+    ++streakCount;
+
+    if (streakCount < count || (uint32_t)(timeMs - streakStartMs) < dwellMs) {
+        return false;
+    }
+
+    occupied    = !occupied;
+    streakCount = 0;
+
+    return true;
+}
+
+bool
+OccupancyDetector::is_occupied() const {
+
+    return occupied;
+}
+
+bool
+OccupancyDetector::is_settling() const {
+
+    return streakCount > 0;
+}
+
+void
+OccupancyDetector::reset() {
+
+    occupied    = false;
+    streakCount = 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file                    OccupancyDetector.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Debounced presence detection from the distances measured by a sensor
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __OCCUPANCYDETECTOR_H__
+#define __OCCUPANCYDETECTOR_H__
+
+#include <cstdint>
+
+/**
+ * @brief                   Thresholds and debounce settings of an OccupancyDetector
+ *
+ * @remarks                 The exit distance should be larger than the enter distance, so that a distance close to either threshold
+ *                          does not toggle the state (hysteresis)
+ */
+struct OccupancyConfig {
+
+    /** Distance below which something is detected (in the unit of the distances) */
+    float           enterDistance {100};
+    /** Distance above which nothing is detected (in the unit of the distances) */
+    float           exitDistance {120};
+    /** Time for which something must be detected before the state becomes occupied (in milliseconds) */
+    uint32_t        enterDwellMs {200};
+    /** Time for which nothing must be detected before the state becomes vacant (in milliseconds) */
+    uint32_t        exitDwellMs {2'000};
+    /** Number of consecutive distances that must detect something before the state becomes occupied */
+    uint8_t         enterCount {3};
+    /** Number of consecutive distances that must detect nothing before the state becomes vacant */
+    uint8_t         exitCount {3};
+};
+
+/**
+ * @brief                   Class that tracks whether something is present in front of a sensor, with debounce
+ *
+ * @remarks                 The state only changes once enough consecutive distances (and enough time) agree on the new state,
+ *                          a single distance that disagrees restarts the count
+ * @remarks                 A failed measurement counts as nothing detected, as a sensor that hears no echo within its range has nothing in front of it
+ * @remarks                 The class does not depend on MBed OS, timestamps are supplied by the caller
+ */
+class OccupancyDetector {
+
+    /** Thresholds and debounce settings */
+    OccupancyConfig config;
+
+    /** Whether something is present */
+    bool            occupied {false};
+    /** Number of consecutive distances that agree on the opposite state */
+    uint32_t        streakCount {0};
+    /** Time at which the first of the consecutive distances was measured (in milliseconds) */
+    uint32_t        streakStartMs {0};
+
+public:
+
+    /**
+     * @brief               Construct a new OccupancyDetector object, which starts in the vacant state
+     *
+     * @param config        Thresholds and debounce settings
+     */
+    explicit OccupancyDetector(const OccupancyConfig &config);
+
+    /**
+     * @brief               Updates the state with a measurement
+     *
+     * @remarks             Timestamps must not decrease, and are allowed to wrap around
+     *
+     * @param timeMs        Time at which the measurement was made (in milliseconds)
+     * @param valid         Whether the measurement was successful
+     * @param value         Measured distance (ignored if the measurement failed)
+     *
+     * @return              true if the state changed, false otherwise
+     */
+    bool            add(uint32_t timeMs, bool valid, float value);
+
+    /**
+     * @brief               Checks if something is present
+     *
+     * @return              true if the state is occupied, false if it is vacant
+     */
+    bool            is_occupied() const;
+
+    /**
+     * @brief               Checks if the recent distances agree on the opposite state, which is not confirmed yet
+     *
+     * @return              true if the state may be about to change, false otherwise
+     */
+    bool            is_settling() const;
+
+    /**
+     * @brief               Resets the state to vacant
+     */
+    void            reset();
+};
+
+#endif //__OCCUPANCYDETECTOR_H__
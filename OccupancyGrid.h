@@ -0,0 +1,282 @@
+/**
+ * @file                    OccupancyGrid.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Local occupancy grid built from the distances measured by a ring of sensors with known poses
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __OCCUPANCYGRID_H__
+#define __OCCUPANCYGRID_H__
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/** Log-odds added to a cell in which a beam ended (scaled so that 20 corresponds to about 0.85 probability) */
+constexpr int8_t    GRID_LOG_ODDS_OCCUPIED  = 20;
+/** Log-odds added to a cell that a beam passed through */
+constexpr int8_t    GRID_LOG_ODDS_FREE      = -6;
+/** Largest magnitude of the log-odds of a cell, so that a cell can change its state again after enough evidence */
+constexpr int8_t    GRID_LOG_ODDS_LIMIT     = 100;
+
+/**
+ * @brief                   Class that fuses the distances measured by a set of sensors into a fixed-size grid of log-odds
+ *
+ * @remarks                 Each sensor is registered with its pose relative to the grid, and the directions of the rays that make up its beam
+ *                          cone are precomputed then, so that each update only steps along the rays using additions (no trigonometry)
+ * @remarks                 Every cell a ray passes through becomes more likely free, and the cell in which it ends becomes more likely occupied,
+ *                          a failed measurement (no echo) marks the rays free up to the maximum range
+ * @remarks                 Log-odds are stored as saturating 8-bit integers, so the grid costs one byte per cell
+ * @remarks                 The class does not depend on MBed OS, timestamps are supplied by the caller
+ *
+ * @tparam Width            Number of columns of the grid
+ * @tparam Height           Number of rows of the grid
+ * @tparam MaxSensors       Largest number of sensors that can be registered
+ * @tparam Rays             Number of rays per beam cone
+ */
+template <size_t Width, size_t Height, size_t MaxSensors, size_t Rays = 5>
+class OccupancyGrid {
+
+    static_assert(Rays > 0, "OccupancyGrid requires at least one ray per beam");
+
+    /**
+     * @brief               Precomputed geometry of the beam of a sensor
+     */
+    struct Beam {
+
+        /** Column of the position of the sensor (in cells, fractional) */
+        float       originX;
+        /** Row of the position of the sensor (in cells, fractional) */
+        float       originY;
+        /** Step along each ray per half cell, in columns */
+        float       stepX[Rays];
+        /** Step along each ray per half cell, in rows */
+        float       stepY[Rays];
+        /** Time of the most recent update from the sensor (in milliseconds) */
+        uint32_t    lastTimeMs;
+        /** Whether an update has been received from the sensor */
+        bool        updated;
+    };
+
+    /** Log-odds of each cell */
+    int8_t          cells[Height][Width] {};
+
+    /** Length of the side of a cell (in the unit of the distances) */
+    float           cellSize;
+    /** Largest distance the sensors can measure (in the unit of the distances) */
+    float           maxRange;
+    /** Full angle of the beam cone in degrees */
+    float           beamWidth;
+
+    /** Geometry of the beam of each registered sensor */
+    Beam            beams[MaxSensors];
+    /** Number of registered sensors */
+    size_t          sensorCount {0};
+
+public:
+
+    /**
+     * @brief               Construct a new OccupancyGrid object, with all cells unknown
+     *
+     * @param cellSize      Length of the side of a cell (in the unit of the distances)
+     * @param maxRange      Largest distance the sensors can measure (in the unit of the distances)
+     * @param beamWidth     Full angle of the beam cone of the sensors in degrees (about 30 for an HCSR04)
+     */
+    OccupancyGrid(float cellSize, float maxRange, float beamWidth = 30.0f)
+            : cellSize(cellSize)
+            , maxRange(maxRange)
+            , beamWidth(beamWidth)
+    {
+    }
+
+    /**
+     * @brief               Registers a sensor with its pose, and precomputes the directions of the rays of its beam
+     *
+     * @param x             Position of the sensor along the columns of the grid (in the unit of the distances, from the left edge)
+     * @param y             Position of the sensor along the rows of the grid (in the unit of the distances, from the top edge)
+     * @param heading       Direction in which the sensor points, in degrees counter-clockwise from the direction of increasing columns
+     *
+     * @return              Index of the sensor (passed to OccupancyGrid::update()), -1 if MaxSensors sensors are already registered
+     */
+    int add_sensor(float x, float y, float heading) {
+
+        // spread the rays evenly across the beam cone (a single ray points along the heading)
+        // each step along a ray is half a cell long, so that no cell along the ray is skipped
+
+        constexpr float DEGREES_TO_RADIANS = 3.14159265f / 180.0f;
+
+        if (sensorCount == MaxSensors) {
+            return -1;
+        }
+
+        Beam    &beam = beams[sensorCount];
+
+        beam.originX    = x / cellSize;
+        beam.originY    = y / cellSize;
+        beam.updated    = false;
+
+        for (size_t i = 0; i < Rays; ++i) {
+
+            float angle = heading;
+            if (Rays > 1) {
+                angle += beamWidth * ((float)i / (Rays - 1) - 0.5f);
+            }
+
+            beam.stepX[i] = 0.5f * cosf(angle * DEGREES_TO_RADIANS);
+            beam.stepY[i] = -0.5f * sinf(angle * DEGREES_TO_RADIANS);
+        }
+
+        return (int)sensorCount++;
+    }
+
+    /**
+     * @brief               Updates the grid with a measurement of a registered sensor
+     *
+     * @remarks             A measurement older than the most recent one of the same sensor (for example, delivered out of order) is ignored
+     *
+     * @param sensor        Index of the sensor (see OccupancyGrid::add_sensor())
+     * @param timeMs        Time at which the measurement was made (in milliseconds)
+     * @param valid         Whether the measurement was successful
+     * @param distance      Measured distance (in the unit of the distances)
+     *
+     * @return              true if the grid was updated, false if the sensor is not registered or the measurement is out of order
+     */
+    bool update(size_t sensor, uint32_t timeMs, bool valid, float distance) {
+
+        // walk each ray of the beam in half-cell steps up to the measured distance (or the maximum range if nothing was heard)
+        // every new cell the ray enters before the cell in which it ends becomes more likely free, and that cell more likely occupied
+        // a ray stops at the edge of the grid
+
+        bool        hit;
+        uint32_t    steps;
+
+        if (sensor >= sensorCount) {
+            return false;
+        }
+
+        Beam        &beam = beams[sensor];
+
+        if (beam.updated && (int32_t)(timeMs - beam.lastTimeMs) < 0) {
+            return false;
+        }
+
+        beam.updated    = true;
+        beam.lastTimeMs = timeMs;
+
+        hit     = valid && distance < maxRange;
+        steps   = (uint32_t)(2.0f * (hit ? distance : maxRange) / cellSize);
+
+        for (size_t i = 0; i < Rays; ++i) {
+
+            float   cx      = beam.originX;
+            float   cy      = beam.originY;
+            float   endX    = beam.originX + beam.stepX[i] * steps;
+            float   endY    = beam.originY + beam.stepY[i] * steps;
+            int32_t endCol  = (int32_t)endX;
+            int32_t endRow  = (int32_t)endY;
+            int32_t lastCol = -1;
+            int32_t lastRow = -1;
+
+            for (uint32_t s = 0; s < steps; ++s, cx += beam.stepX[i], cy += beam.stepY[i]) {
+
+                int32_t col = (int32_t)cx;
+                int32_t row = (int32_t)cy;
+
+                if (cx < 0 || cy < 0 || col >= (int32_t)Width || row >= (int32_t)Height) {
+                    break;
+                }
+                if ((col == lastCol && row == lastRow) || (col == endCol && row == endRow)) {
+                    continue;
+                }
+
+                lastCol = col;
+                lastRow = row;
+
+                add(cells[row][col], GRID_LOG_ODDS_FREE);
+            }
+
+            if (hit && endX >= 0 && endY >= 0 && endCol < (int32_t)Width && endRow < (int32_t)Height) {
+                add(cells[endRow][endCol], GRID_LOG_ODDS_OCCUPIED);
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief               Get the log-odds of a cell
+     *
+     * @param col           Column of the cell
+     * @param row           Row of the cell
+     *
+     * @return              Log-odds of the cell, positive if likely occupied, negative if likely free, 0 if unknown
+     */
+    int8_t get_log_odds(size_t col, size_t row) const {
+        return cells[row][col];
+    }
+
+    /**
+     * @brief               Checks if a cell is likely occupied
+     *
+     * @param col           Column of the cell
+     * @param row           Row of the cell
+     *
+     * @return              true if the log-odds of the cell are positive, false otherwise
+     */
+    bool is_occupied(size_t col, size_t row) const {
+        return cells[row][col] > 0;
+    }
+
+    /**
+     * @brief               Resets all cells to unknown
+     */
+    void clear() {
+
+        for (auto &row : cells) {
+            for (auto &cell : row) {
+                cell = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief               Get the number of columns of the grid
+     *
+     * @return              Number of columns
+     */
+    static constexpr size_t width() { return Width; }
+
+    /**
+     * @brief               Get the number of rows of the grid
+     *
+     * @return              Number of rows
+     */
+    static constexpr size_t height() { return Height; }
+
+private:
+
+    /**
+     * @brief           Helper function to add to the log-odds of a cell, saturating at GRID_LOG_ODDS_LIMIT
+     *
+     * @param cell      Log-odds of the cell
+     * @param delta     Log-odds to add
+     */
+    static void add(int8_t &cell, int8_t delta) {
+
+        int32_t value = cell + delta;
+
+        if (value > GRID_LOG_ODDS_LIMIT) {
+            value = GRID_LOG_ODDS_LIMIT;
+        }
+        else if (value < -GRID_LOG_ODDS_LIMIT) {
+            value = -GRID_LOG_ODDS_LIMIT;
+        }
+
+        cell = (int8_t)value;
+    }
+};
+
+#endif //__OCCUPANCYGRID_H__
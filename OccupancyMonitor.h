@@ -0,0 +1,185 @@
+/**
+ * @file                    OccupancyMonitor.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Drives an HCSR04 sensor to detect occupancy, measuring slowly while idle and quickly while something is detected
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __OCCUPANCYMONITOR_H__
+#define __OCCUPANCYMONITOR_H__
+
+#include "mbed.h"
+#include "OccupancyDetector.h"
+
+/**
+ * @brief                   Class that measures a sensor at an adaptive rate, and reports when the occupancy in front of it changes
+ *
+ * @remarks                 While vacant, the sensor is measured once per idle period, and once something is detected (or while occupied),
+ *                          it is measured once per active period, so that the state is confirmed quickly without keeping the sensor busy otherwise
+ * @remarks                 Each measurement is requested using BasicHCSR04::do_measurement() from a Timeout, so the sensor must be initialized
+ *                          normally (not lazily), and must not be measured periodically while the monitor is running
+ * @remarks                 The callback is only called when the state changes, on the thread of the sensor
+ *
+ * @tparam Sensor           Type of the sensor (an instantiation of BasicHCSR04, such as HCSR04)
+ */
+template <typename Sensor>
+class OccupancyMonitor {
+
+    /** Sensor that is measured */
+    Sensor          &sensor;
+    /** Debounced occupancy state */
+    OccupancyDetector detector;
+
+    /** Time between two measurements while nothing is detected */
+    std::chrono::milliseconds   idlePeriod;
+    /** Time between two measurements while something is detected */
+    std::chrono::milliseconds   activePeriod;
+
+    /** Timeout to request the next measurement */
+    Timeout         nextPing;
+    /** Whether the monitor is running */
+    volatile bool   running {false};
+    /** Whether a measurement requested by the monitor is pending */
+    volatile bool   measuring {false};
+
+    /** Callback when the state changes */
+    Callback<void(bool)> stateCb;
+
+public:
+
+    /**
+     * @brief               Construct a new OccupancyMonitor object
+     *
+     * @param sensor        Sensor to measure, which must outlive the monitor
+     * @param config        Thresholds and debounce settings (in the unit of the sensor)
+     * @param idlePeriod    Time between two measurements while nothing is detected
+     * @param activePeriod  Time between two measurements while something is detected
+     * @param cb            Callback when the state changes, the argument is true if something is present, false otherwise
+     */
+    OccupancyMonitor(Sensor &sensor, const OccupancyConfig &config, std::chrono::milliseconds idlePeriod, std::chrono::milliseconds activePeriod,
+                     const Callback<void(bool)> &cb)
+            : sensor(sensor)
+            , detector(config)
+            , idlePeriod(idlePeriod)
+            , activePeriod(activePeriod)
+            , stateCb(cb)
+    {
+    }
+
+    OccupancyMonitor(const OccupancyMonitor &) = delete;
+    OccupancyMonitor &operator=(const OccupancyMonitor &) = delete;
+
+    /**
+     * @brief               Destroy the OccupancyMonitor object, stopping it first if required
+     *
+     * @attention           Can not call this method from ISR context, or from the callback
+     */
+    ~OccupancyMonitor() {
+        stop();
+    }
+
+    /**
+     * @brief               Starts measuring the sensor, beginning in the vacant state
+     *
+     * @attention           Can not call this method from ISR context
+     *
+     * @return              true if the monitor was started, false if it is already running or the sensor is not initialized
+     */
+    bool start() {
+
+        if (running || !sensor.is_initialized()) {
+            return false;
+        }
+
+        detector.reset();
+
+        running = true;
+        nextPing.attach(callback(this, &OccupancyMonitor::ping), idlePeriod);
+        return true;
+    }
+
+    /**
+     * @brief               Stops measuring the sensor, waiting for the measurement in progress (if any) to complete
+     *
+     * @attention           Can not call this method from ISR context, or from the callback
+     */
+    void stop() {
+
+        running = false;
+        nextPing.detach();
+
+        while (measuring) {
+            ThisThread::sleep_for(1ms);
+        }
+    }
+
+    /**
+     * @brief               Checks if something is present
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if the state is occupied, false if it is vacant
+     */
+    bool is_occupied() const {
+        return detector.is_occupied();
+    }
+
+private:
+
+    /**
+     * @brief           Requests a measurement, called from the Timeout
+     *
+     * @remarks         If the request fails (for example, the queue is full), it is retried after the current period
+     */
+    void ping() {
+
+        if (!running) {
+            return;
+        }
+
+        measuring = true;
+        if (!sensor.do_measurement(callback(this, &OccupancyMonitor::on_measurement))) {
+
+            measuring = false;
+            nextPing.attach(callback(this, &OccupancyMonitor::ping), current_period());
+        }
+    }
+
+    /**
+     * @brief           Updates the state with a measurement and schedules the next one, called on the thread of the sensor
+     *
+     * @param valid     Whether the measurement was successful
+     * @param dist      Measured distance
+     */
+    void on_measurement(bool valid, typename Sensor::value_type dist) {
+
+        // update the state, and call the callback if it changed
+        // schedule the next measurement at the rate that matches the new state, unless the monitor was stopped meanwhile
+
+        uint32_t nowMs = Kernel::Clock::now().time_since_epoch().count();
+
+        if (detector.add(nowMs, valid, (float)dist) && stateCb) {
+            stateCb(detector.is_occupied());
+        }
+
+        if (running) {
+            nextPing.attach(callback(this, &OccupancyMonitor::ping), current_period());
+        }
+
+        measuring = false;
+    }
+
+    /**
+     * @brief           Helper function to get the time until the next measurement
+     *
+     * @return          The active period if something is detected or present, the idle period otherwise
+     */
+    std::chrono::milliseconds current_period() const {
+        return (detector.is_occupied() || detector.is_settling()) ? activePeriod : idlePeriod;
+    }
+};
+
+#endif //__OCCUPANCYMONITOR_H__
@@ -0,0 +1,143 @@
+#include "P2Quantile.h"
+
+// Constructors
+
+P2Quantile::P2Quantile(float probability)
+        : probability(probability)
+{
+
+    reset();
+}
+
+// Public Methods
+
+void
+P2Quantile::add(float value) {
+
+    // while fewer than five distances have been added, insert the distance into the sorted heights
+    // once the fifth distance is added, the heights become the initial markers at positions 0 to 4
+    //
+    // afterwards, find the cell in which the distance falls (extending the extreme markers if it lies outside them)
+    // and shift the positions of all markers after the cell, then advance the desired positions of all markers
+    // each inner marker that is off its desired position by at least one (and can move without colliding with a neighbour) is moved by one
+
+    uint8_t k;
+
+    if (count < MARKERS) {
+
+        for (k = count; k > 0 && heights[k - 1] > value; --k) {
+            heights[k] = heights[k - 1];
+        }
+        heights[k] = value;
+
+        ++count;
+        return;
+    }
+
+    if (value < heights[0]) {
+
+        heights[0]  = value;
+        k           = 0;
+    }
+    else if (value >= heights[MARKERS - 1]) {
+
+        heights[MARKERS - 1]    = value;
+        k                       = MARKERS - 2;
+    }
+    else {
+        for (k = 0; k < MARKERS - 2 && value >= heights[k + 1]; ++k) {
+        }
+    }
+
+    ++count;
+
+    for (uint8_t i = k + 1; i < MARKERS; ++i) {
+        ++positions[i];
+    }
+    for (uint8_t i = 0; i < MARKERS; ++i) {
+        desired[i] += increments[i];
+    }
+
+    for (uint8_t i = 1; i < MARKERS - 1; ++i) {
+
+        float offset = desired[i] - positions[i];
+
+        if (offset >= 1.0f && positions[i + 1] - positions[i] > 1) {
+            move_marker(i, 1);
+        }
+        else if (offset <= -1.0f && positions[i - 1] - positions[i] < -1) {
+            move_marker(i, -1);
+        }
+    }
+}
+
+float
+P2Quantile::get() const {
+
+    // while fewer than five distances have been added, the heights are the sorted distances, so return the exact quantile (nearest rank)
+    // afterwards, the middle marker tracks the quantile
+
+    if (count == 0) {
+        return 0;
+    }
+    if (count < MARKERS) {
+        return heights[(uint8_t)(probability * (count - 1) + 0.5f)];
+    }
+    return heights[2];
+}
+
+uint32_t
+P2Quantile::get_count() const {
+
+    return count;
+}
+
+void
+P2Quantile::reset() {
+
+    count = 0;
+
+    for (uint8_t i = 0; i < MARKERS; ++i) {
+
+        heights[i]      = 0;
+        positions[i]    = i;
+    }
+
+    desired[0]      = 0;
+    desired[1]      = 2 * probability;
+    desired[2]      = 4 * probability;
+    desired[3]      = 2 + 2 * probability;
+    desired[4]      = 4;
+
+    increments[0]   = 0;
+    increments[1]   = probability / 2;
+    increments[2]   = probability;
+    increments[3]   = (1 + probability) / 2;
+    increments[4]   = 1;
+}
+
+// Private Methods
+
+void
+P2Quantile::move_marker(uint8_t i, int32_t d) {
+
+    // predict the new height with the parabola through the marker and its neighbours
+    // if the prediction does not lie strictly between the neighbours, fall back to linear interpolation towards the neighbour in the direction of the move
+
+    float   height;
+    float   below;
+    float   above;
+
+    below   = (heights[i] - heights[i - 1]) / (positions[i] - positions[i - 1]);
+    above   = (heights[i + 1] - heights[i]) / (positions[i + 1] - positions[i]);
+
+    height  = heights[i] + (float)d / (positions[i + 1] - positions[i - 1])
+                            * ((positions[i] - positions[i - 1] + d) * above + (positions[i + 1] - positions[i] - d) * below);
+
+    if (height <= heights[i - 1] || height >= heights[i + 1]) {
+        height = heights[i] + d * (heights[i + d] - heights[i]) / (positions[i + d] - positions[i]);
+    }
+
+    heights[i]      = height;
+    positions[i]   += d;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file                    P2Quantile.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Streaming estimate of a quantile of the distances measured by a sensor
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __P2QUANTILE_H__
+#define __P2QUANTILE_H__
+
+#include <cstdint>
+
+/**
+ * @brief                   Class that estimates a quantile of a stream of distances in constant time and memory per sample
+ *
+ * @remarks                 Uses the P-Square algorithm (Jain and Chlamtac), which tracks the minimum, the maximum, the quantile and two
+ *                          intermediate quantiles using five markers, whose heights are adjusted with piecewise-parabolic interpolation
+ * @remarks                 The estimate is exact while fewer than five distances have been added
+ * @remarks                 The class does not depend on MBed OS, so the same estimates can be computed on a host
+ */
+class P2Quantile {
+
+    /** Number of markers used by the algorithm */
+    static constexpr uint8_t MARKERS = 5;
+
+    /** Quantile being estimated (between 0 and 1) */
+    float           probability;
+
+    /** Number of distances added */
+    uint32_t        count {0};
+    /** Heights of the markers (the first distances, sorted, while fewer than five have been added) */
+    float           heights[MARKERS];
+    /** Actual positions of the markers */
+    int32_t         positions[MARKERS];
+    /** Desired positions of the markers */
+    float           desired[MARKERS];
+    /** Increments of the desired positions per distance */
+    float           increments[MARKERS];
+
+public:
+
+    /**
+     * @brief               Construct a new P2Quantile object
+     *
+     * @param probability   Quantile to estimate, between 0 and 1 (for example, 0.95 for the 95th percentile)
+     */
+    explicit P2Quantile(float probability);
+
+    /**
+     * @brief               Adds a distance to the estimate
+     *
+     * @param value         Distance to add
+     */
+    void            add(float value);
+
+    /**
+     * @brief               Get the estimate of the quantile
+     *
+     * @return              Estimate of the quantile (0 if no distance has been added)
+     */
+    float           get() const;
+
+    /**
+     * @brief               Get the number of distances added since the last reset
+     *
+     * @return              Number of distances
+     */
+    uint32_t        get_count() const;
+
+    /**
+     * @brief               Discards all added distances
+     */
+    void            reset();
+
+private:
+
+    /**
+     * @brief           Helper function to move a marker by one position towards its desired position, and adjust its height
+     *
+     * @param i         Index of the marker (one of the three inner markers)
+     * @param d         Direction of the move (+1 or -1)
+     */
+    void            move_marker(uint8_t i, int32_t d);
+};
+
+#endif //__P2QUANTILE_H__
@@ -0,0 +1,193 @@
+/**
+ * @file                    PolarConverter.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Conversion of the distances measured by a ring of sensors into Cartesian points, using trigonometric tables computed at compile-time
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __POLARCONVERTER_H__
+#define __POLARCONVERTER_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief                   Pose at which a sensor is mounted
+ */
+struct SensorMount {
+
+    /** Position of the sensor along the x axis (in the unit of the distances that are converted) */
+    float           x;
+    /** Position of the sensor along the y axis (in the unit of the distances that are converted) */
+    float           y;
+    /** Direction in which the sensor points, in degrees counter-clockwise from the x axis */
+    float           angle;
+};
+
+/**
+ * @brief                   Computes a cosine at compile-time
+ *
+ * @remarks                 The angle is reduced to [-180, 180] degrees and 20 terms of the Taylor series are summed,
+ *                          which is accurate to well below the precision of a float
+ *
+ * @param degrees           Angle in degrees
+ *
+ * @return                  Cosine of the angle
+ */
+constexpr double
+polar_cos_degrees(double degrees) {
+
+    constexpr double PI = 3.14159265358979323846;
+
+    double  x       = 0;
+    double  term    = 1.0;
+    double  sum     = 1.0;
+
+    while (degrees > 180.0) {
+        degrees -= 360.0;
+    }
+    while (degrees < -180.0) {
+        degrees += 360.0;
+    }
+
+    x = degrees * PI / 180.0;
+
+    for (int k = 1; k <= 20; ++k) {
+
+        term   *= -x * x / ((2 * k - 1) * (2 * k));
+        sum    += term;
+    }
+
+    return sum;
+}
+
+/**
+ * @brief                   Rounds to the nearest integer at compile-time (halves are rounded away from zero)
+ *
+ * @param value             Value to round
+ *
+ * @return                  Nearest integer
+ */
+constexpr int32_t
+polar_round(double value) {
+
+    return (int32_t)(value < 0 ? value - 0.5 : value + 0.5);
+}
+
+/**
+ * @brief                   Trigonometric tables and rounded offsets of a table of mounts, computed at compile-time (see PolarConverter)
+ *
+ * @tparam N                Number of sensors
+ * @tparam Mounts           Table of the mount of each sensor
+ */
+template <size_t N, const SensorMount (&Mounts)[N]>
+struct PolarTables {
+
+    /** Cosine of the angle of each mount */
+    float           cos[N] {};
+    /** Sine of the angle of each mount */
+    float           sin[N] {};
+    /** Cosine of the angle of each mount as a Q15 fixed-point value */
+    int32_t         cosQ15[N] {};
+    /** Sine of the angle of each mount as a Q15 fixed-point value */
+    int32_t         sinQ15[N] {};
+    /** Position of each mount along the x axis, rounded to an integer */
+    int32_t         x[N] {};
+    /** Position of each mount along the y axis, rounded to an integer */
+    int32_t         y[N] {};
+
+    /**
+     * @brief               Computes the tables
+     */
+    constexpr PolarTables() {
+
+        for (size_t i = 0; i < N; ++i) {
+
+            double c = polar_cos_degrees(Mounts[i].angle);
+            double s = polar_cos_degrees(Mounts[i].angle - 90.0);
+
+            cos[i]      = (float)c;
+            sin[i]      = (float)s;
+            cosQ15[i]   = polar_round(c * 32'768.0);
+            sinQ15[i]   = polar_round(s * 32'768.0);
+            x[i]        = polar_round(Mounts[i].x);
+            y[i]        = polar_round(Mounts[i].y);
+        }
+    }
+};
+
+/**
+ * @brief                   Class template that converts a whole scan of distances into Cartesian points in one pass
+ *
+ * @remarks                 The sines and cosines of the mounting angles are computed at compile-time from the table of mounts,
+ *                          so no trigonometric function is called at run-time, and each point costs two multiply-adds
+ * @remarks                 Points are written to separate x and y arrays (structure of arrays), so that the compiler can vectorize the loop
+ * @remarks                 The floating point variant suits the Centimetres unit policy, while the fixed-point variant (Q15 tables and integer
+ *                          arithmetic only) suits the Millimetres unit policy on MCUs without an FPU, in which case the mounts should be given in millimetres
+ * @remarks                 The class does not depend on MBed OS
+ *
+ * @tparam N                Number of sensors
+ * @tparam Mounts           Table of the mount of each sensor (must have static storage duration, typically a constexpr array)
+ */
+template <size_t N, const SensorMount (&Mounts)[N]>
+class PolarConverter {
+
+    static_assert(N > 0, "PolarConverter requires at least one sensor");
+
+    /** Tables computed at compile-time */
+    static constexpr PolarTables<N, Mounts> TABLES {};
+
+public:
+
+    /**
+     * @brief               Converts a scan of floating point distances into points
+     *
+     * @remarks             A failed measurement should be passed as a distance of 0, which places its point at the mount of the sensor
+     *
+     * @param dist          Distance measured by each sensor
+     * @param x             Location to store the x coordinate of each point
+     * @param y             Location to store the y coordinate of each point
+     */
+    static void convert(const float (&dist)[N], float (&x)[N], float (&y)[N]) {
+
+        for (size_t i = 0; i < N; ++i) {
+
+            x[i] = Mounts[i].x + dist[i] * TABLES.cos[i];
+            y[i] = Mounts[i].y + dist[i] * TABLES.sin[i];
+        }
+    }
+
+    /**
+     * @brief               Converts a scan of integer distances into points, using only integer arithmetic
+     *
+     * @remarks             Each coordinate is rounded to the nearest integer, and distances of up to 65535 do not overflow
+     *
+     * @param dist          Distance measured by each sensor
+     * @param x             Location to store the x coordinate of each point
+     * @param y             Location to store the y coordinate of each point
+     */
+    static void convert(const uint32_t (&dist)[N], int32_t (&x)[N], int32_t (&y)[N]) {
+
+        for (size_t i = 0; i < N; ++i) {
+
+            x[i] = TABLES.x[i] + (((int32_t)dist[i] * TABLES.cosQ15[i] + (1 << 14)) >> 15);
+            y[i] = TABLES.y[i] + (((int32_t)dist[i] * TABLES.sinQ15[i] + (1 << 14)) >> 15);
+        }
+    }
+
+    /**
+     * @brief               Get the number of sensors
+     *
+     * @return              Number of sensors
+     */
+    static constexpr size_t size() { return N; }
+};
+
+// the tables are odr-used by convert(), so they need a definition outside the class before C++17 (MBed OS builds with gnu++14)
+template <size_t N, const SensorMount (&Mounts)[N]>
+constexpr PolarTables<N, Mounts> PolarConverter<N, Mounts>::TABLES;
+
+#endif //__POLARCONVERTER_H__
@@ -0,0 +1,159 @@
+/**
+ * @file                    QuantileMonitor.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Attaches streaming quantile estimates to the measurements of an HCSR04 sensor
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __QUANTILEMONITOR_H__
+#define __QUANTILEMONITOR_H__
+
+#include "mbed.h"
+#include "P2Quantile.h"
+
+/**
+ * @brief                   Quantiles of the distances measured during one period of a QuantileMonitor
+ */
+struct QuantileSummary {
+
+    /** Number of valid distances measured during the period */
+    uint32_t        count;
+    /** Number of failed measurements during the period */
+    uint32_t        invalidCount;
+    /** Estimate of the lower quantile (0 if no distance was measured) */
+    float           low;
+    /** Estimate of the median (0 if no distance was measured) */
+    float           median;
+    /** Estimate of the upper quantile (0 if no distance was measured) */
+    float           high;
+};
+
+/**
+ * @brief                   Class that estimates a lower quantile, the median and an upper quantile of the measurements of a sensor,
+ *                          and exports them once per period
+ *
+ * @remarks                 Pass the callback returned by QuantileMonitor::input() to BasicHCSR04::do_measurement() or
+ *                          BasicHCSR04::start_measurement_periodic() (or call QuantileMonitor::on_measurement() from an existing callback)
+ * @remarks                 Each quantile is estimated by a P2Quantile object, so the memory used does not depend on the number of measurements
+ * @remarks                 A period is only completed when a measurement is reported after it has elapsed, so the sensor should be measured periodically
+ *
+ * @tparam T                Type in which the sensor reports distances (see BasicHCSR04::value_type)
+ */
+template <typename T = float>
+class QuantileMonitor {
+
+    /** Length of a period */
+    std::chrono::milliseconds   period;
+    /** Point in time at which the current period ends (unset till the first measurement) */
+    Kernel::Clock::time_point   periodEnd {};
+
+    /** Estimate of the lower quantile */
+    P2Quantile      low;
+    /** Estimate of the median */
+    P2Quantile      median;
+    /** Estimate of the upper quantile */
+    P2Quantile      high;
+    /** Number of failed measurements during the current period */
+    uint32_t        invalidCount {0};
+
+    /** Callback when a period is completed */
+    Callback<void(const QuantileSummary &)> summaryCb;
+
+public:
+
+    /**
+     * @brief               Construct a new QuantileMonitor object
+     *
+     * @param period        Length of a period (for example, 1 minute)
+     * @param cb            Callback when a period is completed, with the quantiles of the period as argument
+     * @param lowP          Lower quantile to estimate (between 0 and 1)
+     * @param highP         Upper quantile to estimate (between 0 and 1)
+     */
+    QuantileMonitor(std::chrono::milliseconds period, const Callback<void(const QuantileSummary &)> &cb, float lowP = 0.05f, float highP = 0.95f)
+            : period(period)
+            , low(lowP)
+            , median(0.5f)
+            , high(highP)
+            , summaryCb(cb)
+    {
+    }
+
+    /**
+     * @brief               Adds a measurement to the estimates, and exports them first if the current period has elapsed
+     *
+     * @remarks             The callback is called on the thread on which the measurement is reported
+     *
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param valid         Whether the measurement was successful
+     * @param dist          Measured distance
+     */
+    void on_measurement(bool valid, T dist) {
+
+        // the first measurement starts the first period
+        // a measurement reported after the period has elapsed exports the period, and is the first of the next one
+
+        Kernel::Clock::time_point now = Kernel::Clock::now();
+
+        if (periodEnd == Kernel::Clock::time_point {}) {
+            periodEnd = now + period;
+        }
+        else if (now >= periodEnd) {
+
+            if (summaryCb) {
+                summaryCb(get_summary());
+            }
+
+            reset();
+            periodEnd = now + period;
+        }
+
+        if (!valid) {
+
+            ++invalidCount;
+            return;
+        }
+
+        low.add((float)dist);
+        median.add((float)dist);
+        high.add((float)dist);
+    }
+
+    /**
+     * @brief               Get a callback that feeds measurements into this object
+     *
+     * @return              Callback with the signature of the callbacks of BasicHCSR04
+     */
+    Callback<void(bool, T)> input() {
+        return callback(this, &QuantileMonitor::on_measurement);
+    }
+
+    /**
+     * @brief               Get the quantiles of the measurements of the current period so far
+     *
+     * @attention           Must be called on the thread on which the measurements are reported (for example, from the summary callback)
+     *
+     * @return              Quantiles of the current period
+     */
+    QuantileSummary get_summary() const {
+        return {median.get_count(), invalidCount, low.get(), median.get(), high.get()};
+    }
+
+    /**
+     * @brief               Discards the measurements of the current period
+     *
+     * @attention           Must be called on the thread on which the measurements are reported
+     */
+    void reset() {
+
+        low.reset();
+        median.reset();
+        high.reset();
+        invalidCount = 0;
+    }
+};
+
+#endif //__QUANTILEMONITOR_H__
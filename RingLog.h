@@ -0,0 +1,516 @@
+/**
+ * @file                    RingLog.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Circular log of records on a block device, to persist the measurements of HCSR04 sensors
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __RINGLOG_H__
+#define __RINGLOG_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "SampleFrame.h"
+
+/** Marker at the start of every page of the log ("HCLG") */
+constexpr uint32_t  RING_LOG_MAGIC          = 0x474C4348;
+/** Size of the header of a page in bytes (magic, sequence number, length of the payload and CRC) */
+constexpr size_t    RING_LOG_HEADER_SIZE    = 12;
+/** Error returned by RingLog::mount() if the page size does not fit the geometry of the device or region */
+constexpr int       RING_LOG_ERROR_GEOMETRY = -1;
+
+/**
+ * @brief                   Outcome of RingLog::append()
+ */
+enum class RingLogAppend : uint8_t {
+
+    /** The record was added to the current page */
+    APPENDED,
+    /** The record was added to a new page, after the previous page was sealed and must be written with RingLog::write_pending() */
+    SEALED,
+    /** The record was dropped, as the current page is full and the previous one has not been written yet */
+    DROPPED
+};
+
+/**
+ * @brief                   Class that persists variable-sized records in a circular log on a block device
+ *
+ * @remarks                 Records are batched in RAM into pages of PageSize bytes, and every page is programmed once, so the device is only
+ *                          written in whole pages
+ * @remarks                 The log is written strictly in a circle over the erase blocks of the region, each block being erased right before its
+ *                          first page is written (dropping the oldest pages), so every block is erased once per lap of the log and wear is spread
+ *                          evenly. The position is recovered by RingLog::mount(), so the circle continues across restarts instead of starting over
+ * @remarks                 Every page starts with a header holding a sequence number and the CRC of the page, a page that was torn by a reset
+ *                          fails its CRC and is skipped, and the log continues after it
+ * @remarks                 Two page buffers are used, so that RingLog::append() only copies the record and never waits for the device: a full
+ *                          page is sealed and written by RingLog::write_pending() (for example, on another thread) while the next page fills
+ * @remarks                 The class does not depend on MBed OS, the device only needs the methods of mbed::BlockDevice that are used
+ *                          (read(), program(), erase(), get_erase_size(), get_program_size(), get_erase_value() and size())
+ *
+ * @tparam Device           Type of the block device (mbed::BlockDevice on the device, or a file-backed stand-in on a host)
+ * @tparam PageSize         Size of a page in bytes (a multiple of the program size that divides the erase size)
+ */
+template <typename Device, size_t PageSize = 256>
+class RingLog {
+
+    static_assert(PageSize > RING_LOG_HEADER_SIZE + 1 && PageSize - RING_LOG_HEADER_SIZE <= UINT16_MAX, "Invalid page size");
+
+    /** Device on which the log is stored */
+    Device          &device;
+    /** Address of the start of the region of the log */
+    uint64_t        start;
+    /** Size of the region of the log in bytes (0 for the rest of the device) */
+    uint64_t        regionSize;
+
+    /** Size of an erase block in bytes */
+    uint64_t        blockSize {0};
+    /** Number of pages in an erase block */
+    uint32_t        pagesPerBlock {0};
+    /** Number of pages in the region */
+    uint32_t        pageCount {0};
+    /** Value of an erased byte */
+    uint8_t         erasedValue {0xFF};
+
+    /** Index of the page written next */
+    uint32_t        nextPage {0};
+    /** Sequence number of the page sealed next */
+    uint32_t        sequence {1};
+
+    /** Page buffers, one being filled while the other is written */
+    uint8_t         pages[2][PageSize];
+    /** Index of the page buffer being filled */
+    uint8_t         active {0};
+    /** Number of bytes used in the page buffer being filled (including the header) */
+    size_t          fill {RING_LOG_HEADER_SIZE};
+    /** Whether the other page buffer is sealed and waiting to be written */
+    std::atomic<bool>   pending {false};
+
+    /** Number of records dropped */
+    uint32_t        droppedCount {0};
+    /** Number of bytes of records appended (not including the length of each record) */
+    uint64_t        appendedBytes {0};
+    /** Number of bytes programmed */
+    uint64_t        programmedBytes {0};
+    /** Number of erase blocks erased */
+    uint32_t        eraseCount {0};
+
+public:
+
+    /**
+     * @brief               Construct a new RingLog object
+     *
+     * @remarks             The log must be mounted before it is used
+     *
+     * @param device        Initialized block device (must remain valid while the object is used)
+     * @param start         Address of the start of the region of the log (a multiple of the erase size)
+     * @param size          Size of the region of the log in bytes (a multiple of the erase size, 0 for the rest of the device)
+     */
+    explicit RingLog(Device &device, uint64_t start = 0, uint64_t size = 0)
+            : device(device)
+            , start(start)
+            , regionSize(size)
+    {
+    }
+
+    /**
+     * @brief               Finds the end of the log on the device, so that it continues after the newest page
+     *
+     * @remarks             Reads the first page of every erase block to find the newest block, then the pages of that block
+     *
+     * @attention           Must be called before any other method, and not concurrently with them
+     *
+     * @return              0 if successful, RING_LOG_ERROR_GEOMETRY if the page size does not fit the device or region, or the error of the device
+     */
+    int mount() {
+
+        // the newest erase block is the one whose first page has the newest sequence number (compared with wrap-around)
+        // pages within a block are written in order, so the next page is the one after the last page of that block that is not blank
+        // (a torn page is not blank, so it is skipped), and the next block is used if the newest one is full
+        // if no page is valid, the log starts at the beginning of the region
+
+        uint64_t    programSize;
+        uint32_t    newestBlock;
+        uint32_t    newestSequence;
+        uint32_t    pageSequence;
+        bool        found;
+        int         err;
+
+        blockSize   = device.get_erase_size();
+        programSize = device.get_program_size();
+        regionSize  = (regionSize == 0) ? device.size() - start : regionSize;
+        erasedValue = (device.get_erase_value() < 0) ? 0xFF : device.get_erase_value();
+
+        if (blockSize == 0 || programSize == 0 || PageSize % programSize != 0 || blockSize % PageSize != 0 || start % blockSize != 0 ||
+            regionSize % blockSize != 0 || regionSize / blockSize < 2) {
+            return RING_LOG_ERROR_GEOMETRY;
+        }
+
+        pagesPerBlock   = blockSize / PageSize;
+        pageCount       = regionSize / PageSize;
+
+        found           = false;
+        newestBlock     = 0;
+        newestSequence  = 0;
+
+        for (uint32_t block = 0; block < pageCount / pagesPerBlock; ++block) {
+
+            if ((err = device.read(pages[0], page_address(block * pagesPerBlock), PageSize)) != 0) {
+                return err;
+            }
+
+            if (check_page(pages[0], &pageSequence, nullptr) && (!found || (int32_t)(pageSequence - newestSequence) > 0)) {
+
+                found           = true;
+                newestBlock     = block;
+                newestSequence  = pageSequence;
+            }
+        }
+
+        nextPage = 0;
+        sequence = 1;
+
+        if (found) {
+
+            nextPage = (newestBlock + 1) * pagesPerBlock;
+
+            for (uint32_t page = newestBlock * pagesPerBlock; page < (newestBlock + 1) * pagesPerBlock; ++page) {
+
+                if ((err = device.read(pages[0], page_address(page), PageSize)) != 0) {
+                    return err;
+                }
+
+                if (check_page(pages[0], &pageSequence, nullptr) && (int32_t)(pageSequence - newestSequence) > 0) {
+                    newestSequence = pageSequence;
+                }
+                if (!is_blank(pages[0])) {
+                    nextPage = page + 1;
+                }
+            }
+
+            nextPage %= pageCount;
+            sequence = newestSequence + 1;
+        }
+
+        active  = 0;
+        fill    = RING_LOG_HEADER_SIZE;
+        pending.store(false);
+
+        return 0;
+    }
+
+    /**
+     * @brief               Adds a record to the current page, sealing the page first if the record does not fit in it
+     *
+     * @remarks             Only copies the record, so it can be called from the measurement thread without waiting for the device
+     *
+     * @attention           It is unsafe to call this method (or RingLog::seal()) from multiple threads concurrently
+     *
+     * @param record        Bytes of the record
+     * @param size          Size of the record in bytes (at most the size of the payload of a page, minus one)
+     *
+     * @return              Whether the record was appended, and whether a page was sealed (which must then be written with RingLog::write_pending())
+     */
+    RingLogAppend append(const void *record, uint8_t size) {
+
+        // each record is stored as its size followed by its bytes
+        // if it does not fit, the current page is sealed (if the other page buffer is free), and the record starts the next page
+
+        RingLogAppend result = RingLogAppend::APPENDED;
+
+        if (size == 0 || RING_LOG_HEADER_SIZE + 1u + size > PageSize) {
+
+            ++droppedCount;
+            return RingLogAppend::DROPPED;
+        }
+
+        if (fill + 1 + size > PageSize) {
+
+            if (!seal()) {
+
+                ++droppedCount;
+                return RingLogAppend::DROPPED;
+            }
+            result = RingLogAppend::SEALED;
+        }
+
+        pages[active][fill] = size;
+        memcpy(&pages[active][fill + 1], record, size);
+
+        fill            += 1 + size;
+        appendedBytes   += size;
+
+        return result;
+    }
+
+    /**
+     * @brief               Seals the current page, even if it is not full (for example, before a planned shutdown)
+     *
+     * @attention           It is unsafe to call this method (or RingLog::append()) from multiple threads concurrently
+     *
+     * @return              true if a page was sealed and must be written with RingLog::write_pending(), false if the current page is empty or
+     *                      the previous page has not been written yet
+     */
+    bool seal() {
+
+        // complete the header of the page (the unused bytes are left as they are, the length in the header bounds the records)
+        // then hand the page over to the writer, and continue with the other page buffer
+
+        uint8_t     *page;
+        uint16_t    length;
+        uint16_t    crc;
+
+        if (fill == RING_LOG_HEADER_SIZE || pending.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        page    = pages[active];
+        length  = fill - RING_LOG_HEADER_SIZE;
+
+        put_u32(page, RING_LOG_MAGIC);
+        put_u32(page + 4, sequence++);
+        page[8] = length & 0xFF;
+        page[9] = length >> 8;
+
+        crc         = crc16_ccitt(page + RING_LOG_HEADER_SIZE, length, crc16_ccitt(page, 10));
+        page[10]    = crc & 0xFF;
+        page[11]    = crc >> 8;
+
+        active  ^= 1;
+        fill    = RING_LOG_HEADER_SIZE;
+        pending.store(true, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief               Writes the sealed page (if any) to the device, erasing its erase block first if it is the first page of the block
+     *
+     * @remarks             Blocks for as long as the device takes, so it should be called from a thread that does not measure
+     *
+     * @attention           It is unsafe to call this method from multiple threads concurrently, it can be called concurrently with
+     *                      RingLog::append() and RingLog::seal()
+     *
+     * @remarks             If the erase block can not be erased, the whole block is skipped (its pages were not erased, so programming them
+     *                      would only produce pages that fail their CRC), and the next page starts the following block
+     *
+     * @return              0 if successful (or nothing was pending), or the error of the device (the page is dropped)
+     */
+    int write_pending() {
+
+        // only successful erases and programs are counted, so that the statistics describe what reached the device
+        // a page whose program failed is skipped (it fails its CRC), the log continues with the next page of the block
+
+        const uint8_t   *page;
+        int             err;
+
+        if (!pending.load(std::memory_order_acquire)) {
+            return 0;
+        }
+
+        page = pages[active ^ 1];
+
+        if (nextPage % pagesPerBlock == 0) {
+
+            if ((err = device.erase(page_address(nextPage), blockSize)) != 0) {
+
+                nextPage = (nextPage + pagesPerBlock) % pageCount;
+                pending.store(false, std::memory_order_release);
+
+                return err;
+            }
+            ++eraseCount;
+        }
+
+        if ((err = device.program(page, page_address(nextPage), PageSize)) == 0) {
+            programmedBytes += PageSize;
+        }
+
+        nextPage = (nextPage + 1) % pageCount;
+        pending.store(false, std::memory_order_release);
+
+        return err;
+    }
+
+    /**
+     * @brief               Reads all records in the log, from the oldest to the newest
+     *
+     * @remarks             Pages that fail their CRC (torn by a reset) and pages older than the ones before them (left over from a previous
+     *                      lap) are skipped, pages that are not written yet are not read
+     *
+     * @attention           Must not be called concurrently with RingLog::write_pending()
+     *
+     * @param cb            Function called with the bytes and size of each record, void cb(const uint8_t *record, uint8_t size)
+     *
+     * @return              0 if successful, or the error of the device
+     */
+    template <typename F>
+    int read(F &&cb) const {
+
+        // the oldest page is at the start of the erase block after the next page, or at the next page itself if it starts a block
+        // (which is erased only when it is written)
+
+        uint8_t     buffer[PageSize];
+        uint32_t    page;
+        uint32_t    pageSequence;
+        uint32_t    lastSequence;
+        uint16_t    length;
+        bool        first;
+        int         err;
+
+        page    = (nextPage % pagesPerBlock == 0) ? nextPage : (nextPage / pagesPerBlock + 1) * pagesPerBlock % pageCount;
+        first   = true;
+
+        lastSequence = 0;
+
+        do {
+
+            if ((err = device.read(buffer, page_address(page), PageSize)) != 0) {
+                return err;
+            }
+
+            if (check_page(buffer, &pageSequence, &length) && (first || (int32_t)(pageSequence - lastSequence) > 0)) {
+
+                for (size_t i = RING_LOG_HEADER_SIZE; i < RING_LOG_HEADER_SIZE + length; i += 1 + buffer[i]) {
+                    cb(&buffer[i + 1], buffer[i]);
+                }
+
+                first           = false;
+                lastSequence    = pageSequence;
+            }
+
+            page = (page + 1) % pageCount;
+
+        } while (page != nextPage);
+
+        return 0;
+    }
+
+    /**
+     * @brief               Checks whether a sealed page is waiting to be written
+     *
+     * @return              true if a page is pending, false otherwise
+     */
+    bool has_pending() const {
+        return pending.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief               Get the number of records dropped
+     *
+     * @return              Number of records dropped because the writer fell behind (or that were too large)
+     */
+    uint32_t get_dropped_count() const {
+        return droppedCount;
+    }
+
+    /**
+     * @brief               Get the number of bytes of records appended
+     *
+     * @return              Number of bytes appended
+     */
+    uint64_t get_appended_bytes() const {
+        return appendedBytes;
+    }
+
+    /**
+     * @brief               Get the number of bytes programmed, to compute the write amplification together with RingLog::get_appended_bytes()
+     *
+     * @return              Number of bytes programmed
+     */
+    uint64_t get_programmed_bytes() const {
+        return programmedBytes;
+    }
+
+    /**
+     * @brief               Get the number of erase blocks erased
+     *
+     * @return              Number of erases
+     */
+    uint32_t get_erase_count() const {
+        return eraseCount;
+    }
+
+private:
+
+    /**
+     * @brief           Helper function to get the address of a page on the device
+     */
+    uint64_t page_address(uint32_t page) const {
+        return start + (uint64_t)page * PageSize;
+    }
+
+    /**
+     * @brief           Helper function to check whether every byte of a page is erased
+     */
+    bool is_blank(const uint8_t *page) const {
+
+        for (size_t i = 0; i < PageSize; ++i) {
+
+            if (page[i] != erasedValue) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief           Helper function to check the header and CRC of a page
+     *
+     * @param page      Bytes of the page
+     * @param seq       Location to store the sequence number of the page
+     * @param length    Location to store the length of the payload (may be nullptr)
+     *
+     * @return          true if the page is valid, false otherwise
+     */
+    static bool check_page(const uint8_t *page, uint32_t *seq, uint16_t *length) {
+
+        uint16_t    payload;
+        uint16_t    crc;
+
+        if (get_u32(page) != RING_LOG_MAGIC) {
+            return false;
+        }
+
+        payload = page[8] | (page[9] << 8);
+        if (payload > PageSize - RING_LOG_HEADER_SIZE) {
+            return false;
+        }
+
+        crc = crc16_ccitt(page + RING_LOG_HEADER_SIZE, payload, crc16_ccitt(page, 10));
+        if (page[10] != (crc & 0xFF) || page[11] != (crc >> 8)) {
+            return false;
+        }
+
+        *seq = get_u32(page + 4);
+        if (length != nullptr) {
+            *length = payload;
+        }
+        return true;
+    }
+
+    /**
+     * @brief           Helper function to write a 32-bit value in little-endian order
+     */
+    static void put_u32(uint8_t *out, uint32_t value) {
+
+        out[0] = value & 0xFF;
+        out[1] = (value >> 8) & 0xFF;
+        out[2] = (value >> 16) & 0xFF;
+        out[3] = value >> 24;
+    }
+
+    /**
+     * @brief           Helper function to read a 32-bit value in little-endian order
+     */
+    static uint32_t get_u32(const uint8_t *in) {
+        return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+    }
+};
+
+#endif //__RINGLOG_H__
@@ -0,0 +1,214 @@
+/**
+ * @file                    RingLogMonitor.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Persists the measurements of HCSR04 sensors in a circular log on a block device
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __RINGLOGMONITOR_H__
+#define __RINGLOGMONITOR_H__
+
+#include "mbed.h"
+#include "RingLog.h"
+#include "SampleFrame.h"
+
+/** Size of a measurement stored by RingLogMonitor in bytes (sensor id, 32-bit timestamp in milliseconds, 16-bit distance in millimetres) */
+constexpr uint8_t   RING_LOG_SAMPLE_SIZE    = 7;
+
+/**
+ * @brief                   Class that stores the measurements of one or more sensors in a RingLog on a block device
+ *
+ * @remarks                 Pass the callback returned by RingLogMonitor::input() to BasicHCSR04::do_measurement() or
+ *                          BasicHCSR04::start_measurement_periodic() (or call RingLogMonitor::on_measurement() from an existing callback)
+ * @remarks                 Each measurement is stored as RING_LOG_SAMPLE_SIZE bytes in little-endian order (distance SAMPLE_DISTANCE_INVALID for a
+ *                          failed measurement), timestamped using Kernel::Clock when it is reported
+ * @remarks                 The measurement thread only copies the measurement into the current page, full pages are written to the device by
+ *                          an event on the given queue, so the measurements never wait for the device (if the device falls behind, measurements
+ *                          are dropped and counted instead)
+ * @remarks                 If the event can not be posted (the queue is full), it is posted again by the next measurement, so a full queue only
+ *                          delays the write instead of stopping the log
+ *
+ * @tparam PageSize         Size of a page of the log in bytes (see RingLog)
+ * @tparam T                Type in which the sensors report distances, float (centimetres) or uint32_t (millimetres)
+ */
+template <size_t PageSize = 256, typename T = float>
+class RingLogMonitor {
+
+    /** Log on the block device */
+    RingLog<BlockDevice, PageSize>  log;
+    /** Queue on which pages are written to the device */
+    EventQueue      *queue;
+    /** Mutex to serialize appending measurements from multiple sensors, and posting the write of the sealed page */
+    Mutex           appendLock;
+    /** Whether the write of the sealed page is posted to the queue and has not started yet */
+    bool            writeQueued {false};
+    /** Number of failed writes of pages to the device */
+    uint32_t        writeErrorCount {0};
+    /** Most recent error of the device (0 if no write has failed) */
+    int             lastError {0};
+
+public:
+
+    /**
+     * @brief               Construct a new RingLogMonitor object
+     *
+     * @param device        Initialized block device (must remain valid while the object is used)
+     * @param queue         Queue on which pages are written to the device, which must be dispatched by a thread that does not measure
+     * @param start         Address of the start of the region of the log (a multiple of the erase size)
+     * @param size          Size of the region of the log in bytes (a multiple of the erase size, 0 for the rest of the device)
+     */
+    explicit RingLogMonitor(BlockDevice &device, EventQueue *queue = mbed_event_queue(), uint64_t start = 0, uint64_t size = 0)
+            : log(device, start, size)
+            , queue(queue)
+    {
+    }
+
+    /**
+     * @brief               Finds the end of the log on the device (see RingLog::mount())
+     *
+     * @attention           Must be called before any measurement is reported
+     *
+     * @return              0 if successful, or an error
+     */
+    int mount() {
+        return log.mount();
+    }
+
+    /**
+     * @brief               Adds a measurement to the log
+     *
+     * @attention           Can not call this method from ISR context
+     *
+     * @param sensorId      Identifier of the sensor
+     * @param valid         Whether the measurement was successful
+     * @param dist          Measured distance
+     */
+    void on_measurement(uint8_t sensorId, bool valid, T dist) {
+
+        // pack the measurement, append it and post the write of the page that it sealed (if any)
+        // if a sealed page is still waiting because its write could not be posted before, post it again
+
+        uint8_t     record[RING_LOG_SAMPLE_SIZE];
+        uint32_t    timeMs;
+        uint32_t    distanceMm;
+
+        timeMs      = Kernel::Clock::now().time_since_epoch().count();
+        distanceMm  = valid ? sample_to_millimetres(dist) : SAMPLE_DISTANCE_INVALID;
+        distanceMm  = (distanceMm < SAMPLE_DISTANCE_INVALID) ? distanceMm : SAMPLE_DISTANCE_INVALID - (valid ? 1 : 0);
+
+        record[0] = sensorId;
+        record[1] = timeMs & 0xFF;
+        record[2] = (timeMs >> 8) & 0xFF;
+        record[3] = (timeMs >> 16) & 0xFF;
+        record[4] = timeMs >> 24;
+        record[5] = distanceMm & 0xFF;
+        record[6] = distanceMm >> 8;
+
+        appendLock.lock();
+
+        log.append(record, RING_LOG_SAMPLE_SIZE);
+        post_write();
+
+        appendLock.unlock();
+    }
+
+    /**
+     * @brief               Get a callback that logs the measurements of a sensor
+     *
+     * @param sensorId      Identifier of the sensor in the log
+     *
+     * @return              Callback with the signature of the callbacks of BasicHCSR04
+     */
+    Callback<void(bool, T)> input(uint8_t sensorId) {
+        return [this, sensorId](bool valid, T dist) {
+            on_measurement(sensorId, valid, dist);
+        };
+    }
+
+    /**
+     * @brief               Writes the measurements of the current page to the device, even if the page is not full (for example, before a
+     *                      planned shutdown)
+     *
+     * @attention           Can not call this method from ISR context
+     */
+    void flush() {
+
+        appendLock.lock();
+
+        log.seal();
+        post_write();
+
+        appendLock.unlock();
+    }
+
+    /**
+     * @brief               Get the number of pages that could not be written to the device (their measurements are lost)
+     *
+     * @return              Number of failed writes
+     */
+    uint32_t get_write_error_count() const {
+        return writeErrorCount;
+    }
+
+    /**
+     * @brief               Get the most recent error of the device
+     *
+     * @return              Error returned by the device (see BlockDevice), 0 if no write has failed
+     */
+    int get_last_error() const {
+        return lastError;
+    }
+
+    /**
+     * @brief               Get the underlying log, for example to read it back or to get its statistics
+     *
+     * @return              Reference to the log
+     */
+    RingLog<BlockDevice, PageSize> &get_log() {
+        return log;
+    }
+
+private:
+
+    /**
+     * @brief               Helper function to post the write of the sealed page to the queue, unless there is none or it is already posted
+     *
+     * @remarks             Must be called with appendLock held
+     */
+    void post_write() {
+
+        if (writeQueued || !log.has_pending()) {
+            return;
+        }
+
+        writeQueued = queue->call(this, &RingLogMonitor::write_pending) != 0;
+    }
+
+    /**
+     * @brief               Helper function to write the sealed page on the queue, and count the errors of the device
+     */
+    void write_pending() {
+
+        // clear the flag once the write has completed, and post the write of a page that was sealed in the meantime (its own post was skipped)
+
+        int err;
+
+        if ((err = log.write_pending()) != 0) {
+
+            ++writeErrorCount;
+            lastError = err;
+        }
+
+        appendLock.lock();
+
+        writeQueued = false;
+        post_write();
+
+        appendLock.unlock();
+    }
+};
+
+#endif //__RINGLOGMONITOR_H__
@@ -0,0 +1,246 @@
+/**
+ * @file                    RollingMinMax.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Minimum and maximum of the distances measured by a sensor over a sliding window of time
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __ROLLINGMINMAX_H__
+#define __ROLLINGMINMAX_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief                   Class that tracks the minimum and maximum of the distances measured within a sliding window of time
+ *
+ * @remarks                 Each extreme is tracked using a monotonic deque (stored in a fixed-capacity ring buffer), so that updates take
+ *                          amortized constant time instead of scanning all the distances within the window
+ * @remarks                 If more than Capacity distances fall within the window, the oldest ones are dropped early
+ * @remarks                 The extremes are published after each update into one of two slots, alternately, so that any number of threads (or
+ *                          ISRs) can query them without locking while a single thread updates them, and a reader never waits for the writer
+ * @remarks                 The class does not depend on MBed OS, timestamps are supplied by the caller
+ *
+ * @tparam Capacity         Maximum number of distances held by each deque
+ */
+template <size_t Capacity>
+class RollingMinMax {
+
+    static_assert(Capacity > 0, "RollingMinMax requires a capacity of at least one distance");
+
+    /**
+     * @brief               Distance along with the time at which it was measured
+     */
+    struct Sample {
+
+        /** Time at which the distance was measured (in milliseconds) */
+        uint32_t    timeMs;
+        /** Measured distance */
+        float       value;
+    };
+
+    /**
+     * @brief               Double-ended queue of samples stored in a fixed-capacity ring buffer
+     */
+    struct Deque {
+
+        /** Storage of the samples */
+        Sample      samples[Capacity];
+        /** Index of the oldest sample */
+        size_t      head {0};
+        /** Number of samples */
+        size_t      count {0};
+
+        Sample      &front() { return samples[head]; }
+        Sample      &back() { return samples[(head + count - 1) % Capacity]; }
+        void        pop_front() { head = (head + 1) % Capacity; --count; }
+        void        pop_back() { --count; }
+        void        push_back(const Sample &sample) { samples[(head + count) % Capacity] = sample; ++count; }
+    };
+
+    /** Length of the window in milliseconds */
+    uint32_t        windowMs;
+
+    /** Candidates for the minimum, with increasing values from front to back */
+    Deque           minDeque;
+    /** Candidates for the maximum, with decreasing values from front to back */
+    Deque           maxDeque;
+
+    /**
+     * @brief               Extremes published for readers
+     */
+    struct Extremes {
+
+        /** Minimum */
+        std::atomic<float>  min {0};
+        /** Maximum */
+        std::atomic<float>  max {0};
+        /** Whether the window contained any distance */
+        std::atomic<bool>   valid {false};
+    };
+
+    /** Slots of the published extremes, publication k is written to slot k % 2 */
+    Extremes        slots[2];
+    /** Number of the most recent publication that was started */
+    std::atomic<uint32_t>   started {0};
+    /** Number of the most recent publication that was completed */
+    std::atomic<uint32_t>   completed {0};
+
+public:
+
+    /**
+     * @brief               Construct a new RollingMinMax object
+     *
+     * @param windowMs      Length of the window in milliseconds
+     */
+    explicit RollingMinMax(uint32_t windowMs)
+            : windowMs(windowMs)
+    {
+    }
+
+    /**
+     * @brief               Adds a distance to the window, and drops the ones that have left it
+     *
+     * @remarks             Timestamps must not decrease, and are allowed to wrap around
+     *
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param timeMs        Time at which the distance was measured (in milliseconds)
+     * @param value         Measured distance
+     */
+    void add(uint32_t timeMs, float value) {
+
+        // a new distance makes all older candidates that are not better obsolete, as they leave the window first
+        // if a deque is full, its oldest candidate is dropped early to make space
+
+        expire_deques(timeMs);
+
+        while (minDeque.count > 0 && minDeque.back().value >= value) {
+            minDeque.pop_back();
+        }
+        while (maxDeque.count > 0 && maxDeque.back().value <= value) {
+            maxDeque.pop_back();
+        }
+
+        if (minDeque.count == Capacity) {
+            minDeque.pop_front();
+        }
+        if (maxDeque.count == Capacity) {
+            maxDeque.pop_front();
+        }
+
+        minDeque.push_back({timeMs, value});
+        maxDeque.push_back({timeMs, value});
+
+        publish();
+    }
+
+    /**
+     * @brief               Drops the distances that have left the window without adding a new one (for example, after a failed measurement)
+     *
+     * @attention           It is unsafe to call this method from multiple threads concurrently, or concurrently with RollingMinMax::add()
+     *
+     * @param nowMs         Current time (in milliseconds)
+     */
+    void expire(uint32_t nowMs) {
+
+        expire_deques(nowMs);
+        publish();
+    }
+
+    /**
+     * @brief               Get the minimum and maximum of the distances within the window, as of the most recent update
+     *
+     * @remarks             A reader that interrupts the writer (an ISR or a higher-priority thread) reads the slot that the writer is not
+     *                      writing, so it always completes in a single pass, even if the writer was interrupted in the middle of an update
+     * @remarks             A reader is only repeated if the writer completed an update and started overwriting the slot being read while
+     *                      the reader was preempted, so it never waits for the writer to make progress
+     *
+     * @attention           This function can be called from any thread or ISR context, concurrently with the updates
+     *
+     * @param min           Location to store the minimum
+     * @param max           Location to store the maximum
+     *
+     * @return              true if the window contains any distance, false otherwise (nothing is stored)
+     */
+    bool get(float *min, float *max) const {
+
+        // read the slot of the most recent completed publication
+        // the slot is only overwritten by the publication two after it, so the read is consistent unless that one has started meanwhile
+
+        uint32_t    number;
+        float       minValue;
+        float       maxValue;
+        bool        valid;
+
+        do {
+
+            number      = completed.load(std::memory_order_acquire);
+
+            const Extremes &slot = slots[number & 1];
+
+            minValue    = slot.min.load(std::memory_order_relaxed);
+            maxValue    = slot.max.load(std::memory_order_relaxed);
+            valid       = slot.valid.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+        } while ((int32_t)(started.load(std::memory_order_relaxed) - number) >= 2);
+
+        if (!valid) {
+            return false;
+        }
+
+        *min = minValue;
+        *max = maxValue;
+        return true;
+    }
+
+private:
+
+    /**
+     * @brief           Helper function to drop the candidates that have left the window
+     *
+     * @param nowMs     Current time (in milliseconds)
+     */
+    void expire_deques(uint32_t nowMs) {
+
+        while (minDeque.count > 0 && (uint32_t)(nowMs - minDeque.front().timeMs) > windowMs) {
+            minDeque.pop_front();
+        }
+        while (maxDeque.count > 0 && (uint32_t)(nowMs - maxDeque.front().timeMs) > windowMs) {
+            maxDeque.pop_front();
+        }
+    }
+
+    /**
+     * @brief           Helper function to publish the extremes (the front of each deque) for readers
+     */
+    void publish() {
+
+        // announce the publication before writing its slot, so that a reader of the same slot (two publications ago) notices the overwrite
+        // then write the slot that readers are not directed to, and direct them to it once it is complete
+        // only this thread writes the counters, so a plain load and store suffice (no read-modify-write is needed)
+
+        uint32_t number = completed.load(std::memory_order_relaxed) + 1;
+        Extremes &slot  = slots[number & 1];
+
+        started.store(number, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.valid.store(minDeque.count > 0, std::memory_order_relaxed);
+        if (minDeque.count > 0) {
+
+            slot.min.store(minDeque.front().value, std::memory_order_relaxed);
+            slot.max.store(maxDeque.front().value, std::memory_order_relaxed);
+        }
+
+        completed.store(number, std::memory_order_release);
+    }
+};
+
+#endif //__ROLLINGMINMAX_H__
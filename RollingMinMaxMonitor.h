@@ -0,0 +1,84 @@
+/**
+ * @file                    RollingMinMaxMonitor.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Attaches a sliding-window minimum and maximum to the measurements of an HCSR04 sensor
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __ROLLINGMINMAXMONITOR_H__
+#define __ROLLINGMINMAXMONITOR_H__
+
+#include "mbed.h"
+#include "RollingMinMax.h"
+
+/**
+ * @brief                   Class that tracks the minimum and maximum of the measurements of a sensor over a sliding window of time
+ *
+ * @remarks                 Pass the callback returned by RollingMinMaxMonitor::input() to BasicHCSR04::do_measurement() or
+ *                          BasicHCSR04::start_measurement_periodic() (or call RollingMinMaxMonitor::on_measurement() from an existing callback)
+ * @remarks                 Measurements are timestamped using Kernel::Clock when they are reported
+ *
+ * @tparam Capacity         Maximum number of measurements tracked within the window (see RollingMinMax)
+ * @tparam T                Type in which the sensor reports distances (see BasicHCSR04::value_type)
+ */
+template <size_t Capacity, typename T = float>
+class RollingMinMaxMonitor {
+
+    /** Extremes of the measurements */
+    RollingMinMax<Capacity> extremes;
+
+public:
+
+    /**
+     * @brief               Construct a new RollingMinMaxMonitor object
+     *
+     * @param window        Length of the window
+     */
+    explicit RollingMinMaxMonitor(std::chrono::milliseconds window)
+            : extremes(window.count())
+    {
+    }
+
+    /**
+     * @brief               Adds a measurement to the window (a failed measurement only drops the measurements that have left it)
+     *
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param valid         Whether the measurement was successful
+     * @param dist          Measured distance
+     */
+    void on_measurement(bool valid, T dist) {
+
+        uint32_t nowMs = Kernel::Clock::now().time_since_epoch().count();
+
+        valid ? extremes.add(nowMs, (float)dist) : extremes.expire(nowMs);
+    }
+
+    /**
+     * @brief               Get a callback that feeds measurements into this object
+     *
+     * @return              Callback with the signature of the callbacks of BasicHCSR04
+     */
+    Callback<void(bool, T)> input() {
+        return callback(this, &RollingMinMaxMonitor::on_measurement);
+    }
+
+    /**
+     * @brief               Get the minimum and maximum of the measurements within the window (see RollingMinMax::get())
+     *
+     * @attention           This function can be called from any thread or ISR context, without locking
+     *
+     * @param min           Location to store the minimum
+     * @param max           Location to store the maximum
+     *
+     * @return              true if the window contains any measurement, false otherwise
+     */
+    bool get(float *min, float *max) const {
+        return extremes.get(min, max);
+    }
+};
+
+#endif //__ROLLINGMINMAXMONITOR_H__
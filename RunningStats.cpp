@@ -0,0 +1,98 @@
+#include "RunningStats.h"
+
+// Constructors
+
+RunningStats::RunningStats(uint32_t windowSize)
+        : windowSize(windowSize)
+{
+}
+
+// Public Methods
+
+bool
+RunningStats::add(float value) {
+
+    // update the count, and the mean and sum of squared differences using Welford's algorithm
+    // (using the difference from the old and the new mean avoids the cancellation of the naive sum-of-squares method)
+    // update the extremes, which are initialized by the first distance
+
+    float delta;
+
+    ++count;
+
+    delta   = value - mean;
+    mean   += delta / count;
+    m2     += delta * (value - mean);
+
+    if (count == 1 || value < min) {
+        min = value;
+    }
+    if (count == 1 || value > max) {
+        max = value;
+    }
+
+    return complete_window();
+}
+
+bool
+RunningStats::add_invalid() {
+
+    ++invalidCount;
+    return complete_window();
+}
+
+RunningSummary
+RunningStats::get_summary() const {
+
+    RunningSummary summary;
+
+    summary.count           = count;
+    summary.invalidCount    = invalidCount;
+    summary.mean            = mean;
+    summary.variance        = (count > 1) ? m2 / (count - 1) : 0.0f;
+    summary.min             = min;
+    summary.max             = max;
+
+    return summary;
+}
+
+RunningSummary
+RunningStats::get_window_summary() const {
+
+    return lastWindow;
+}
+
+void
+RunningStats::reset() {
+
+    restart();
+    lastWindow = RunningSummary {};
+}
+
+// Private Methods
+
+bool
+RunningStats::complete_window() {
+
+    // in tumbling-window mode, once the window holds windowSize measurements, save its summary and start a new one
+
+    if (windowSize == 0 || count + invalidCount < windowSize) {
+        return false;
+    }
+
+    lastWindow = get_summary();
+    restart();
+
+    return true;
+}
+
+void
+RunningStats::restart() {
+
+    count           = 0;
+    invalidCount    = 0;
+    mean            = 0;
+    m2              = 0;
+    min             = 0;
+    max             = 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file                    RunningStats.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Streaming statistics of the distances measured by a sensor
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __RUNNINGSTATS_H__
+#define __RUNNINGSTATS_H__
+
+#include <cstdint>
+
+/**
+ * @brief                   Summary of the distances accumulated by a RunningStats object
+ */
+struct RunningSummary {
+
+    /** Number of valid distances accumulated */
+    uint32_t        count;
+    /** Number of failed measurements (timeouts, faults) seen */
+    uint32_t        invalidCount;
+    /** Mean of the distances (0 if no distance was accumulated) */
+    float           mean;
+    /** Sample variance of the distances (0 if fewer than two distances were accumulated) */
+    float           variance;
+    /** Smallest distance (0 if no distance was accumulated) */
+    float           min;
+    /** Largest distance (0 if no distance was accumulated) */
+    float           max;
+};
+
+/**
+ * @brief                   Class that accumulates the mean, variance, minimum and maximum of a stream of distances in constant time and memory per sample
+ *
+ * @remarks                 The mean and variance are updated using Welford's algorithm, which is numerically stable even for long streams
+ * @remarks                 In cumulative mode (window size of 0), all distances since the last reset are accumulated,
+ *                          while in tumbling-window mode, the statistics are restarted after every windowSize measurements
+ * @remarks                 The class does not depend on MBed OS, so the same statistics can be computed on a host
+ */
+class RunningStats {
+
+    /** Number of measurements (valid or not) per window, 0 for cumulative mode */
+    uint32_t        windowSize;
+
+    /** Number of valid distances accumulated in the current window */
+    uint32_t        count {0};
+    /** Number of failed measurements seen in the current window */
+    uint32_t        invalidCount {0};
+    /** Running mean of the current window */
+    float           mean {0};
+    /** Running sum of squared differences from the mean of the current window */
+    float           m2 {0};
+    /** Smallest distance of the current window */
+    float           min {0};
+    /** Largest distance of the current window */
+    float           max {0};
+
+    /** Summary of the most recently completed window */
+    RunningSummary  lastWindow {};
+
+public:
+
+    /**
+     * @brief               Construct a new RunningStats object
+     *
+     * @param windowSize    Number of measurements (valid or not) per tumbling window, 0 to accumulate cumulatively
+     */
+    explicit RunningStats(uint32_t windowSize = 0);
+
+    /**
+     * @brief               Accumulates a distance
+     *
+     * @param value         Distance to accumulate
+     *
+     * @return              true if the distance completed a tumbling window (see RunningStats::get_window_summary()), false otherwise
+     */
+    bool            add(float value);
+
+    /**
+     * @brief               Counts a failed measurement
+     *
+     * @return              true if the measurement completed a tumbling window (see RunningStats::get_window_summary()), false otherwise
+     */
+    bool            add_invalid();
+
+    /**
+     * @brief               Get the summary of the distances accumulated so far (the current window in tumbling-window mode)
+     *
+     * @return              Summary of the accumulated distances
+     */
+    RunningSummary  get_summary() const;
+
+    /**
+     * @brief               Get the summary of the most recently completed tumbling window
+     *
+     * @return              Summary of the window (all zeroes if no window has been completed or in cumulative mode)
+     */
+    RunningSummary  get_window_summary() const;
+
+    /**
+     * @brief               Discards all accumulated distances and the summary of the last window
+     */
+    void            reset();
+
+private:
+
+    /**
+     * @brief           Helper function to complete the current window if it is full
+     *
+     * @return          true if the window was completed, false otherwise
+     */
+    bool            complete_window();
+
+    /**
+     * @brief           Helper function to restart the statistics of the current window
+     */
+    void            restart();
+};
+
+#endif //__RUNNINGSTATS_H__
@@ -0,0 +1,184 @@
+#include "SampleFrame.h"
+
+/** CRC-16/CCITT-FALSE of each value of a nibble (polynomial 0x1021), so that the CRC is computed four bits at a time with a 32 byte table */
+static const uint16_t   CRC16_NIBBLE_TABLE[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// Functions
+
+uint16_t
+crc16_ccitt(const uint8_t *data, size_t length, uint16_t crc) {
+
+    // process the high nibble, then the low nibble of every byte
+
+    for (size_t i = 0; i < length; ++i) {
+
+        crc = (crc << 4) ^ CRC16_NIBBLE_TABLE[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ CRC16_NIBBLE_TABLE[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+
+    return crc;
+}
+
+size_t
+sample_frame_encode(const SampleRecord &record, uint8_t *out) {
+
+    // pack the fields and append their CRC
+    // COBS-encode the bytes: each zero byte is replaced by the distance to the next one, stored in the code byte in front of the block
+    // (a frame is far shorter than the 254 bytes after which COBS needs an extra code byte)
+    // finally, terminate the frame with the delimiter
+
+    uint8_t     payload[SAMPLE_PAYLOAD_SIZE + 2];
+    uint16_t    crc;
+    uint8_t     *code;
+    uint8_t     *dst;
+
+    payload[0]  = record.sensorId;
+    payload[1]  = record.sequence & 0xFF;
+    payload[2]  = record.sequence >> 8;
+    payload[3]  = record.deltaMs & 0xFF;
+    payload[4]  = record.deltaMs >> 8;
+    payload[5]  = record.distanceMm & 0xFF;
+    payload[6]  = record.distanceMm >> 8;
+
+    crc         = crc16_ccitt(payload, SAMPLE_PAYLOAD_SIZE);
+    payload[7]  = crc & 0xFF;
+    payload[8]  = crc >> 8;
+
+    code    = out;
+    dst     = out + 1;
+    *code   = 1;
+
+    for (uint8_t byte : payload) {
+
+        if (byte == 0) {
+
+            code    = dst++;
+            *code   = 1;
+        }
+        else {
+
+            *dst++ = byte;
+            ++*code;
+        }
+    }
+
+    *dst++ = 0;
+    return dst - out;
+}
+
+bool
+sample_frame_decode(const uint8_t *frame, size_t length, SampleRecord *record) {
+
+    // undo the COBS encoding, where each code byte gives the distance to the next (implicit) zero byte
+    // the frame must decode into exactly the payload and its CRC, and the CRC must match
+
+    uint8_t     payload[SAMPLE_PAYLOAD_SIZE + 2];
+    size_t      decoded;
+    size_t      i;
+    uint16_t    crc;
+
+    decoded = 0;
+    i       = 0;
+
+    while (i < length) {
+
+        uint8_t code = frame[i++];
+
+        if (code == 0 || i + code - 1 > length) {
+            return false;
+        }
+
+        for (uint8_t j = 1; j < code; ++j) {
+
+            if (decoded == sizeof(payload) || frame[i] == 0) {
+                return false;
+            }
+            payload[decoded++] = frame[i++];
+        }
+
+        if (i < length) {
+
+            if (decoded == sizeof(payload)) {
+                return false;
+            }
+            payload[decoded++] = 0;
+        }
+    }
+
+    if (decoded != sizeof(payload)) {
+        return false;
+    }
+
+    crc = crc16_ccitt(payload, SAMPLE_PAYLOAD_SIZE);
+    if (payload[7] != (crc & 0xFF) || payload[8] != (crc >> 8)) {
+        return false;
+    }
+
+    record->sensorId    = payload[0];
+    record->sequence    = payload[1] | (payload[2] << 8);
+    record->deltaMs     = payload[3] | (payload[4] << 8);
+    record->distanceMm  = payload[5] | (payload[6] << 8);
+
+    return true;
+}
+
+uint32_t
+sample_to_millimetres(float dist) {
+
+    return (dist <= 0) ? 0 : (dist >= SAMPLE_DISTANCE_INVALID / 10.0f) ? SAMPLE_DISTANCE_INVALID : (uint32_t)(dist * 10 + 0.5f);
+}
+
+uint32_t
+sample_to_millimetres(uint32_t dist) {
+
+    return dist;
+}
+
+// Public Methods
+
+bool
+SampleFrameDecoder::push(uint8_t byte, SampleRecord *record) {
+
+    // collect bytes till the delimiter, discarding the frame if it grows longer than any valid frame
+    // at the delimiter, decode the collected bytes (empty frames, such as repeated delimiters, are ignored) and start the next frame
+
+    bool decodedOk;
+
+    if (byte != 0) {
+
+        if (length == sizeof(buffer)) {
+            overflow = true;
+        }
+        else {
+            buffer[length++] = byte;
+        }
+        return false;
+    }
+
+    decodedOk = false;
+
+    if (overflow) {
+        ++errorCount;
+    }
+    else if (length > 0) {
+
+        decodedOk = sample_frame_decode(buffer, length, record);
+        if (!decodedOk) {
+            ++errorCount;
+        }
+    }
+
+    length      = 0;
+    overflow    = false;
+
+    return decodedOk;
+}
+
+uint32_t
+SampleFrameDecoder::get_error_count() const {
+
+    return errorCount;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file                    SampleFrame.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Compact binary frames to stream the measurements of HCSR04 sensors over a serial link
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __SAMPLEFRAME_H__
+#define __SAMPLEFRAME_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/** Distance stored in a record for a failed measurement */
+constexpr uint16_t  SAMPLE_DISTANCE_INVALID     = 0xFFFF;
+/** Size of the packed fields of a record in bytes */
+constexpr size_t    SAMPLE_PAYLOAD_SIZE         = 7;
+/** Largest size of an encoded frame in bytes (payload, CRC, COBS overhead and delimiter) */
+constexpr size_t    SAMPLE_FRAME_MAX_SIZE       = SAMPLE_PAYLOAD_SIZE + 2 + 1 + 1;
+
+/**
+ * @brief                   Measurement of a sensor, as carried by a frame
+ */
+struct SampleRecord {
+
+    /** Identifier of the sensor */
+    uint8_t         sensorId;
+    /** Sequence number of the frame in the stream, used to detect lost frames */
+    uint16_t        sequence;
+    /** Time since the previous frame in the stream in milliseconds (saturates at 65535) */
+    uint16_t        deltaMs;
+    /** Measured distance in millimetres (SAMPLE_DISTANCE_INVALID for a failed measurement) */
+    uint16_t        distanceMm;
+};
+
+/**
+ * @brief                   Computes the CRC-16/CCITT-FALSE of a sequence of bytes
+ *
+ * @param data              Bytes to compute the CRC of
+ * @param length            Number of bytes
+ * @param crc               CRC of the preceding bytes, to compute the CRC incrementally
+ *
+ * @return                  CRC of the bytes
+ */
+uint16_t            crc16_ccitt(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief                   Encodes a record into a frame
+ *
+ * @remarks                 The fields are packed in little-endian order (sensor id, sequence, delta, distance), followed by the CRC of the
+ *                          payload, and the whole is COBS-encoded while it is written, so that the frame contains no zero byte except for the
+ *                          delimiter that terminates it
+ * @remarks                 The frame is written directly into the output (no intermediate buffer)
+ *
+ * @param record            Record to encode
+ * @param out               Location to write the frame to, at least SAMPLE_FRAME_MAX_SIZE bytes
+ *
+ * @return                  Number of bytes written, including the delimiter
+ */
+size_t              sample_frame_encode(const SampleRecord &record, uint8_t *out);
+
+/**
+ * @brief                   Decodes a frame into a record
+ *
+ * @param frame             COBS-encoded bytes of the frame, without the delimiter
+ * @param length            Number of bytes
+ * @param record            Location to store the decoded record
+ *
+ * @return                  true if the frame is well-formed and its CRC matches, false otherwise (nothing is stored)
+ */
+bool                sample_frame_decode(const uint8_t *frame, size_t length, SampleRecord *record);
+
+/**
+ * @brief                   Converts a distance in centimetres (as reported with the Centimetres unit policy) into the millimetres stored in a record
+ *
+ * @param dist              Distance in centimetres
+ *
+ * @return                  Distance rounded to the nearest millimetre, SAMPLE_DISTANCE_INVALID if it does not fit into a record
+ */
+uint32_t            sample_to_millimetres(float dist);
+
+/**
+ * @brief                   Passes through a distance that is already in millimetres (as reported with the Millimetres unit policy)
+ *
+ * @param dist              Distance in millimetres
+ *
+ * @return                  The same distance
+ */
+uint32_t            sample_to_millimetres(uint32_t dist);
+
+/**
+ * @brief                   Class that splits a stream of bytes into frames and decodes them
+ *
+ * @remarks                 Resynchronizes at the next delimiter after a corrupted or truncated frame
+ */
+class SampleFrameDecoder {
+
+    /** Bytes of the frame being received */
+    uint8_t         buffer[SAMPLE_FRAME_MAX_SIZE];
+    /** Number of bytes of the frame received so far */
+    size_t          length {0};
+    /** Whether the frame being received is longer than any valid frame */
+    bool            overflow {false};
+    /** Number of frames that were discarded */
+    uint32_t        errorCount {0};
+
+public:
+
+    /**
+     * @brief               Feeds a byte of the stream
+     *
+     * @param byte          Received byte
+     * @param record        Location to store the record if the byte completes a valid frame
+     *
+     * @return              true if a record was decoded, false otherwise
+     */
+    bool            push(uint8_t byte, SampleRecord *record);
+
+    /**
+     * @brief               Get the number of frames that were discarded (corrupted, truncated or too long)
+     *
+     * @return              Number of discarded frames
+     */
+    uint32_t        get_error_count() const;
+};
+
+#endif //__SAMPLEFRAME_H__
@@ -0,0 +1,207 @@
+/**
+ * @file                    SampleStreamer.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Streams the measurements of HCSR04 sensors over a serial link as compact binary frames
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __SAMPLESTREAMER_H__
+#define __SAMPLESTREAMER_H__
+
+#include "mbed.h"
+#include "SampleFrame.h"
+
+/**
+ * @brief                   Class that encodes the measurements of one or more sensors into frames (see SampleFrame.h) and writes them to a serial link
+ *
+ * @remarks                 Pass the callback returned by SampleStreamer::input() to BasicHCSR04::do_measurement() or
+ *                          BasicHCSR04::start_measurement_periodic() (or call SampleStreamer::push() from an existing callback), and call
+ *                          SampleStreamer::flush() periodically from a low priority thread
+ * @remarks                 Frames are encoded directly into a ring of bytes that is always written contiguously (a frame that does not fit before the
+ *                          end of the ring is started at its beginning instead), so SampleStreamer::flush() hands the ring itself to the serial link
+ *                          with at most two writes and no intermediate copies
+ * @remarks                 Frames are dropped (and counted) instead of blocking the measurement when the ring is full, and still consume their
+ *                          sequence numbers, so that the receiver sees them as lost frames
+ *
+ * @tparam Capacity         Size of the ring in bytes (each frame takes at most SAMPLE_FRAME_MAX_SIZE bytes)
+ */
+template <size_t Capacity = 256>
+class SampleStreamer {
+
+    static_assert(Capacity > 2 * SAMPLE_FRAME_MAX_SIZE, "The ring must hold at least two frames");
+
+    /** Encoded frames waiting to be written */
+    uint8_t         ring[Capacity];
+    /** Index at which the next frame is encoded */
+    size_t          head {0};
+    /** Index of the first byte that has not been written yet */
+    size_t          tail {0};
+    /** End of the bytes before the beginning of the ring was reused (Capacity when it was not) */
+    size_t          wrap {Capacity};
+
+    /** Sequence number of the next frame (queued or dropped) */
+    uint16_t        sequence {0};
+    /** Point in time at which the previous frame was encoded (unset till the first frame) */
+    Kernel::Clock::time_point   lastTime {};
+    /** Number of frames dropped because the ring was full */
+    uint32_t        droppedCount {0};
+
+    /** Mutex to serialize pushing frames and updating the indices */
+    Mutex           ringLock;
+
+public:
+
+    /**
+     * @brief               Encodes a measurement into a frame
+     *
+     * @attention           Can not call this method from ISR context
+     *
+     * @param sensorId      Identifier of the sensor
+     * @param valid         Whether the measurement was successful
+     * @param distanceMm    Measured distance in millimetres (saturates below SAMPLE_DISTANCE_INVALID)
+     *
+     * @return              true if the frame was queued, false if it was dropped
+     */
+    bool push(uint8_t sensorId, bool valid, uint32_t distanceMm) {
+
+        // make sure that a frame of the largest size fits contiguously, starting from the beginning of the ring if the end is too short
+        // (the ring is never filled completely, so that head == tail always means that it is empty)
+        // a dropped frame still consumes its sequence number, so that a gap in the sequence reports the frames dropped here as well as those
+        // lost on the link, while the time of the previous queued frame is kept, so that the delta of the next one spans the dropped frames
+
+        SampleRecord                record;
+        Kernel::Clock::time_point   now;
+        uint32_t                    deltaMs;
+
+        ringLock.lock();
+
+        if (head == tail) {
+
+            head = tail = 0;
+            wrap = Capacity;
+        }
+
+        if (head >= tail && Capacity - head < SAMPLE_FRAME_MAX_SIZE && tail > SAMPLE_FRAME_MAX_SIZE) {
+
+            wrap = head;
+            head = 0;
+        }
+
+        if ((head >= tail && Capacity - head < SAMPLE_FRAME_MAX_SIZE) || (head < tail && tail - head <= SAMPLE_FRAME_MAX_SIZE)) {
+
+            ++droppedCount;
+            ++sequence;
+            ringLock.unlock();
+            return false;
+        }
+
+        now     = Kernel::Clock::now();
+        deltaMs = (lastTime == Kernel::Clock::time_point {}) ? 0 : (now - lastTime).count();
+
+        record.sensorId     = sensorId;
+        record.sequence     = sequence++;
+        record.deltaMs      = (deltaMs < UINT16_MAX) ? deltaMs : UINT16_MAX;
+        record.distanceMm   = !valid ? SAMPLE_DISTANCE_INVALID : (distanceMm < SAMPLE_DISTANCE_INVALID) ? distanceMm : SAMPLE_DISTANCE_INVALID - 1;
+
+        lastTime    = now;
+        head        += sample_frame_encode(record, ring + head);
+
+        ringLock.unlock();
+        return true;
+    }
+
+    /**
+     * @brief               Get a callback that streams the measurements of a sensor
+     *
+     * @tparam T            Type in which the sensor reports distances, float (centimetres) or uint32_t (millimetres)
+     *
+     * @param sensorId      Identifier of the sensor in the frames
+     *
+     * @return              Callback with the signature of the callbacks of BasicHCSR04
+     */
+    template <typename T = float>
+    Callback<void(bool, T)> input(uint8_t sensorId) {
+        return [this, sensorId](bool valid, T dist) {
+            push(sensorId, valid, sample_to_millimetres(dist));
+        };
+    }
+
+    /**
+     * @brief               Writes the queued frames to a serial link
+     *
+     * @remarks             The bytes are handed to the serial link straight from the ring, measurements can be pushed concurrently as the
+     *                      ring is only locked to read and update the indices
+     * @remarks             If the serial link is non-blocking and accepts fewer bytes, the rest are written by the next call
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param serial        Serial link to write to (for example, a BufferedSerial)
+     *
+     * @return              Number of bytes written
+     */
+    size_t flush(FileHandle &serial) {
+
+        // write the bytes before the wrap point first (if the beginning of the ring was reused), then those from the beginning
+        // the bytes between the tail and the head are never touched by SampleStreamer::push(), so they are written without holding the lock
+
+        size_t total = 0;
+
+        for (;;) {
+
+            size_t  start;
+            size_t  end;
+            ssize_t written;
+
+            ringLock.lock();
+            start   = tail;
+            end     = (head >= tail) ? head : wrap;
+            ringLock.unlock();
+
+            if (start == end) {
+                break;
+            }
+
+            written = serial.write(ring + start, end - start);
+            if (written <= 0) {
+                break;
+            }
+
+            ringLock.lock();
+            tail += written;
+
+            if (tail == head) {
+
+                head = tail = 0;
+                wrap = Capacity;
+            }
+            else if (tail == wrap) {
+
+                tail = 0;
+                wrap = Capacity;
+            }
+            ringLock.unlock();
+
+            total += written;
+            if ((size_t)written < end - start) {
+                break;
+            }
+        }
+
+        return total;
+    }
+
+    /**
+     * @brief               Get the number of frames dropped because the ring was full
+     *
+     * @return              Number of dropped frames
+     */
+    uint32_t get_dropped_count() const {
+        return droppedCount;
+    }
+};
+
+#endif //__SAMPLESTREAMER_H__
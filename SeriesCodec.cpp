@@ -0,0 +1,175 @@
+#include "SeriesCodec.h"
+
+/**
+ * @brief                   Maps a signed value to an unsigned one, so that values close to zero are small (0, -1, 1, -2 ... to 0, 1, 2, 3 ...)
+ */
+static inline uint64_t
+zigzag_encode(int64_t value) {
+
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+/**
+ * @brief                   Inverse of zigzag_encode()
+ */
+static inline int64_t
+zigzag_decode(uint64_t value) {
+
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Constructors
+
+SeriesEncoder::SeriesEncoder(uint8_t *buffer, size_t capacity)
+        : buffer(buffer)
+        , capacity(capacity)
+{
+}
+
+SeriesDecoder::SeriesDecoder(const uint8_t *buffer, size_t length)
+        : buffer(buffer)
+        , length(length)
+{
+}
+
+// Public Methods
+
+bool
+SeriesEncoder::add(uint32_t timeMs, bool valid, uint32_t distance) {
+
+    // refuse the sample unless the largest possible encoding fits, so that a sample is never split across blocks
+    // the interval and its change are computed with wrapping unsigned arithmetic, and reinterpreted as signed differences
+    // (the first sample of a block is stored against zero, so its timestamp is stored in full)
+    // the distance field is the zigzag difference from the previous valid distance shifted left by one, or just the failure bit
+
+    uint32_t delta;
+
+    if (capacity - length < SERIES_MAX_SAMPLE_SIZE) {
+        return false;
+    }
+
+    delta = timeMs - prevTime;
+
+    put_varint(zigzag_encode((int32_t)(delta - prevDelta)));
+
+    if (valid) {
+
+        put_varint(zigzag_encode((int64_t)distance - prevDistance) << 1);
+        prevDistance = distance;
+    }
+    else {
+        put_varint(1);
+    }
+
+    prevTime    = timeMs;
+    prevDelta   = (count == 0) ? 0 : delta;
+    ++count;
+
+    return true;
+}
+
+const uint8_t *
+SeriesEncoder::data() const {
+
+    return buffer;
+}
+
+size_t
+SeriesEncoder::size() const {
+
+    return length;
+}
+
+uint32_t
+SeriesEncoder::get_count() const {
+
+    return count;
+}
+
+void
+SeriesEncoder::reset() {
+
+    length          = 0;
+    count           = 0;
+    prevTime        = 0;
+    prevDelta       = 0;
+    prevDistance    = 0;
+}
+
+bool
+SeriesDecoder::next(uint32_t *timeMs, bool *valid, uint32_t *distance) {
+
+    // mirror SeriesEncoder::add(), the first sample of the block is the one decoded at position 0
+
+    uint64_t    timeField;
+    uint64_t    distanceField;
+    uint32_t    delta;
+    bool        first;
+
+    if (position == length || corrupted) {
+        return false;
+    }
+
+    first = (position == 0);
+
+    if (!get_varint(&timeField) || !get_varint(&distanceField)) {
+
+        corrupted = true;
+        return false;
+    }
+
+    delta       = prevDelta + (uint32_t)zigzag_decode(timeField);
+    prevTime    += delta;
+    prevDelta   = first ? 0 : delta;
+
+    if ((distanceField & 1) == 0) {
+        prevDistance += (uint32_t)zigzag_decode(distanceField >> 1);
+    }
+
+    *timeMs     = prevTime;
+    *valid      = (distanceField & 1) == 0;
+    *distance   = *valid ? prevDistance : 0;
+
+    return true;
+}
+
+bool
+SeriesDecoder::is_corrupted() const {
+
+    return corrupted;
+}
+
+// Private methods
+
+void
+SeriesEncoder::put_varint(uint64_t value) {
+
+    while (value >= 0x80) {
+
+        buffer[length++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+}
+
+bool
+SeriesDecoder::get_varint(uint64_t *value) {
+
+    // a varint longer than the encoder ever produces is treated as corruption
+
+    uint8_t shift;
+
+    *value = 0;
+
+    for (shift = 0; position < length && shift < 7 * 5; shift += 7) {
+
+        uint8_t byte = buffer[position++];
+
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file                    SeriesCodec.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Streaming compression of the timestamped measurements of a sensor, to store them compactly
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __SERIESCODEC_H__
+#define __SERIESCODEC_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/** Largest number of bytes a single sample is encoded into */
+constexpr size_t    SERIES_MAX_SAMPLE_SIZE  = 10;
+
+/**
+ * @brief                   Class that compresses a series of timestamped measurements of a sensor into a block of bytes
+ *
+ * @remarks                 Each timestamp is stored as the zigzag-varint of its delta-of-delta (the change of the interval between measurements),
+ *                          so a sensor measured at a fixed rate costs one byte per timestamp
+ * @remarks                 Each distance is stored as the zigzag-varint of its difference from the previous valid distance, shifted left by one
+ *                          with the lowest bit marking a failed measurement (which stores no distance), so slowly changing distances cost one or
+ *                          two bytes
+ * @remarks                 The first sample of a block stores its timestamp and distance against zero, so every block can be decoded on its own
+ * @remarks                 The encoder writes into a buffer provided by the caller (for example, a page that is then written to flash), and
+ *                          otherwise uses a fixed amount of memory
+ * @remarks                 The class does not depend on MBed OS, so the same encoding can be produced and decoded on a host
+ */
+class SeriesEncoder {
+
+    /** Buffer into which samples are encoded */
+    uint8_t         *buffer;
+    /** Size of the buffer in bytes */
+    size_t          capacity;
+    /** Number of bytes used */
+    size_t          length {0};
+    /** Number of samples encoded */
+    uint32_t        count {0};
+
+    /** Timestamp of the previous sample in milliseconds */
+    uint32_t        prevTime {0};
+    /** Interval between the previous two samples in milliseconds */
+    uint32_t        prevDelta {0};
+    /** Distance of the previous valid sample */
+    uint32_t        prevDistance {0};
+
+public:
+
+    /**
+     * @brief               Construct a new SeriesEncoder object
+     *
+     * @param buffer        Buffer into which samples are encoded (must remain valid while the object is used)
+     * @param capacity      Size of the buffer in bytes
+     */
+    SeriesEncoder(uint8_t *buffer, size_t capacity);
+
+    /**
+     * @brief               Encodes a sample
+     *
+     * @remarks             Timestamps may wrap around, as only their differences are stored
+     *
+     * @param timeMs        Timestamp of the measurement in milliseconds
+     * @param valid         Whether the measurement was successful
+     * @param distance      Measured distance (for example, in millimetres), ignored if the measurement failed
+     *
+     * @return              true if the sample was encoded, false if the buffer may not have room for it (the block is full)
+     */
+    bool            add(uint32_t timeMs, bool valid, uint32_t distance);
+
+    /**
+     * @brief               Get the encoded bytes
+     *
+     * @return              Pointer to the start of the buffer
+     */
+    const uint8_t   *data() const;
+
+    /**
+     * @brief               Get the number of encoded bytes
+     *
+     * @return              Number of bytes used in the buffer
+     */
+    size_t          size() const;
+
+    /**
+     * @brief               Get the number of samples encoded
+     *
+     * @return              Number of samples in the block
+     */
+    uint32_t        get_count() const;
+
+    /**
+     * @brief               Discards the encoded samples and starts a new block in the same buffer
+     */
+    void            reset();
+
+private:
+
+    /**
+     * @brief           Helper function to append an unsigned varint (7 bits per byte, least significant first)
+     *
+     * @param value     Value to append
+     */
+    void            put_varint(uint64_t value);
+};
+
+/**
+ * @brief                   Class that decodes a block of samples produced by a SeriesEncoder
+ */
+class SeriesDecoder {
+
+    /** Encoded bytes */
+    const uint8_t   *buffer;
+    /** Number of encoded bytes */
+    size_t          length;
+    /** Index of the next byte to decode */
+    size_t          position {0};
+    /** Whether the block ended in the middle of a sample */
+    bool            corrupted {false};
+
+    /** Timestamp of the previous sample in milliseconds */
+    uint32_t        prevTime {0};
+    /** Interval between the previous two samples in milliseconds */
+    uint32_t        prevDelta {0};
+    /** Distance of the previous valid sample */
+    uint32_t        prevDistance {0};
+
+public:
+
+    /**
+     * @brief               Construct a new SeriesDecoder object
+     *
+     * @param buffer        Encoded bytes (must remain valid while the object is used)
+     * @param length        Number of encoded bytes
+     */
+    SeriesDecoder(const uint8_t *buffer, size_t length);
+
+    /**
+     * @brief               Decodes the next sample
+     *
+     * @param timeMs        Location to store the timestamp of the measurement in milliseconds
+     * @param valid         Location to store whether the measurement was successful
+     * @param distance      Location to store the measured distance (0 if the measurement failed)
+     *
+     * @return              true if a sample was decoded, false at the end of the block (or if it is corrupted)
+     */
+    bool            next(uint32_t *timeMs, bool *valid, uint32_t *distance);
+
+    /**
+     * @brief               Get whether the block ended in the middle of a sample
+     *
+     * @return              true if the block is corrupted or truncated, false otherwise
+     */
+    bool            is_corrupted() const;
+
+private:
+
+    /**
+     * @brief           Helper function to read an unsigned varint
+     *
+     * @param value     Location to store the value
+     *
+     * @return          true if a complete varint was read, false otherwise
+     */
+    bool            get_varint(uint64_t *value);
+};
+
+#endif //__SERIESCODEC_H__
@@ -0,0 +1,28 @@
+#include "SpeedOfSound.h"
+
+#include <cmath>
+
+/** Temperature of 0 degrees Celsius in Kelvin */
+constexpr float     ZERO_CELSIUS_KELVIN     = 273.15f;
+/** Atmospheric pressure at sea level in Pascal */
+constexpr float     STANDARD_PRESSURE       = 101'325.0f;
+/** Coefficients of the Magnus formula for the saturation vapour pressure of water (in Pascal and degrees Celsius) */
+constexpr float     MAGNUS_PRESSURE         = 610.94f;
+constexpr float     MAGNUS_SLOPE            = 17.625f;
+constexpr float     MAGNUS_OFFSET           = 243.04f;
+/** Increase in the speed of sound per unit of mole fraction of water vapour, and its change with temperature (Cramer, 1993) */
+constexpr float     VAPOUR_COEFFICIENTS[]   = {51.471935f, 0.1495874f, -0.000782f};
+
+float
+speed_of_sound(float celsius, float relativeHumidity) {
+
+    // the speed of sound in an ideal gas is proportional to the square root of its absolute temperature
+    // water vapour is lighter than dry air, so humid air carries sound slightly faster, by an amount proportional to the mole fraction of
+    // the vapour, which is the relative humidity times the saturation vapour pressure (which grows steeply with temperature)
+
+    float   saturation  = MAGNUS_PRESSURE * expf(MAGNUS_SLOPE * celsius / (celsius + MAGNUS_OFFSET));
+    float   vapour      = relativeHumidity / 100.0f * saturation / STANDARD_PRESSURE;
+    float   gain        = VAPOUR_COEFFICIENTS[0] + (VAPOUR_COEFFICIENTS[1] + VAPOUR_COEFFICIENTS[2] * celsius) * celsius;
+
+    return SPEED_OF_SOUND_0C * sqrtf(1.0f + celsius / ZERO_CELSIUS_KELVIN) + gain * vapour;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file                    SpeedOfSound.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Model of the speed of sound in air, used to compensate the distances measured by HCSR04 sensors
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __SPEEDOFSOUND_H__
+#define __SPEEDOFSOUND_H__
+
+/** Speed of sound in dry air at 0 degrees Celsius (in metres per second) */
+constexpr float     SPEED_OF_SOUND_0C           = 331.3f;
+/** Speed of sound assumed when no temperature is known, corresponding to dry air at about 20 degrees Celsius (in metres per second) */
+constexpr float     SPEED_OF_SOUND_DEFAULT      = 343.0f;
+
+/**
+ * @brief                   Calculates the speed of sound in air
+ *
+ * @remarks                 Uses the ideal gas model for the temperature, with a correction proportional to the mole fraction of water vapour
+ *                          for the humidity, which is accurate to within about 0.1% between -10 and 45 degrees Celsius at any humidity at
+ *                          sea level (see tools/sound-check)
+ * @remarks                 Takes an exponential for the humidity, so it is meant to be called when the temperature changes, not per sample
+ * @remarks                 Does not depend on MBed OS, so that it can be checked against reference values on a host
+ *
+ * @param celsius           Temperature of the air in degrees Celsius
+ * @param relativeHumidity  Relative humidity of the air in percent (0 to 100)
+ *
+ * @return                  Speed of sound in metres per second
+ */
+float               speed_of_sound(float celsius, float relativeHumidity = 0.0f);
+
+#endif //__SPEEDOFSOUND_H__
@@ -0,0 +1,95 @@
+/**
+ * @file                    StatsMonitor.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Attaches streaming statistics to the measurements of an HCSR04 sensor
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __STATSMONITOR_H__
+#define __STATSMONITOR_H__
+
+#include "mbed.h"
+#include "RunningStats.h"
+
+/**
+ * @brief                   Class that accumulates running statistics of the measurements of a sensor, and reports a summary once per window
+ *
+ * @remarks                 Pass the callback returned by StatsMonitor::input() to BasicHCSR04::do_measurement() or BasicHCSR04::start_measurement_periodic()
+ *                          (or call StatsMonitor::on_measurement() from an existing callback) to attach the monitor to a sensor
+ *
+ * @tparam T                Type in which the sensor reports distances (see BasicHCSR04::value_type)
+ */
+template <typename T = float>
+class StatsMonitor {
+
+    /** Statistics of the measurements */
+    RunningStats    stats;
+    /** Callback when a window is completed */
+    Callback<void(const RunningSummary &)> summaryCb;
+
+public:
+
+    /**
+     * @brief               Construct a new StatsMonitor object
+     *
+     * @param windowSize    Number of measurements (valid or not) per window, 0 to accumulate cumulatively (the callback is then never called)
+     * @param cb            Callback when a window is completed, with the summary of the window as argument
+     */
+    StatsMonitor(uint32_t windowSize, const Callback<void(const RunningSummary &)> &cb)
+            : stats(windowSize)
+            , summaryCb(cb)
+    {
+    }
+
+    /**
+     * @brief               Accumulates a measurement, and calls the callback if it completes a window
+     *
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @param valid         Whether the measurement was successful
+     * @param dist          Measured distance
+     */
+    void on_measurement(bool valid, T dist) {
+
+        bool windowComplete;
+
+        windowComplete = valid ? stats.add((float)dist) : stats.add_invalid();
+        if (windowComplete && summaryCb) {
+            summaryCb(stats.get_window_summary());
+        }
+    }
+
+    /**
+     * @brief               Get a callback that feeds measurements into this object
+     *
+     * @return              Callback with the signature of the callbacks of BasicHCSR04
+     */
+    Callback<void(bool, T)> input() {
+        return callback(this, &StatsMonitor::on_measurement);
+    }
+
+    /**
+     * @brief               Get the summary of the measurements accumulated so far (the current window in tumbling-window mode)
+     *
+     * @attention           Must be called on the thread on which the measurements are reported (for example, from the summary callback)
+     *
+     * @return              Summary of the accumulated measurements
+     */
+    RunningSummary get_summary() const {
+        return stats.get_summary();
+    }
+
+    /**
+     * @brief               Discards all accumulated measurements
+     *
+     * @attention           Must be called on the thread on which the measurements are reported
+     */
+    void reset() {
+        stats.reset();
+    }
+};
+
+#endif //__STATSMONITOR_H__
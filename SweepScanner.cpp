@@ -0,0 +1,192 @@
+#include "SweepScanner.h"
+#include "SpeedOfSound.h"
+
+/** Period of the PWM signal of the servo */
+constexpr auto      SERVO_PERIOD    = 20ms;
+
+// Constructors
+
+SweepScanner::SweepScanner(PinName trig, PinName echo, PinName servoPin, const SweepConfig &config, PolarSample *samples, size_t count,
+                           const Callback<void(const PolarSample *, size_t)> &cb)
+        : capture(trig, echo)
+        , servo(servoPin)
+        , config(config)
+        , samples(samples)
+        , count(count)
+        , servoAngle(config.startAngle)
+        , sweepCb(cb)
+{
+
+    servo.period_ms(SERVO_PERIOD.count());
+    move_servo(config.startAngle);
+}
+
+SweepScanner::~SweepScanner() {
+
+    // stop sweeping and cancel the sweep in progress (if any), wait for it to drain, then terminate the thread
+
+    if (!dispatch.is_running()) {
+        return;
+    }
+
+    continuous = false;
+    capture.cancel();
+    dispatch.drain();
+
+    finalize();
+}
+
+// Public Methods
+
+bool
+SweepScanner::initialize() {
+
+    // start the thread, and allow captures again if they were cancelled by the destructor of a previous run
+
+    if (!dispatch.start()) {
+        return false;
+    }
+
+    capture.resume();
+    return true;
+}
+
+bool
+SweepScanner::finalize() {
+
+    // return if a sweep is pending; otherwise stop the thread
+
+    if (busy) {
+        return false;
+    }
+
+    return dispatch.stop();
+}
+
+bool
+SweepScanner::do_sweep() {
+
+    // return if a sweep is pending or the object is not initialized; move forward otherwise
+    // mark the object busy before posting, so that the sweep can never complete before the flag is set
+
+    if (busy || !dispatch.is_running() || count < 2) {
+        return false;
+    }
+
+    busy = true;
+    if (dispatch.get_queue().call(this, &SweepScanner::sweep) == 0) {
+
+        busy = false;
+        return false;
+    }
+
+    return true;
+}
+
+bool
+SweepScanner::start_sweeping() {
+
+    continuous = true;
+    if (!do_sweep()) {
+
+        continuous = false;
+        return false;
+    }
+
+    return true;
+}
+
+void
+SweepScanner::stop_sweeping() {
+
+    continuous = false;
+}
+
+bool
+SweepScanner::is_busy() const {
+
+    return busy;
+}
+
+void
+SweepScanner::set_temperature(float celsius, float relativeHumidity) {
+
+    unit.set_speed_of_sound(speed_of_sound(celsius, relativeHumidity));
+}
+
+// Private methods
+
+void
+SweepScanner::sweep() {
+
+    // visit the samples in the direction of this sweep, the servo is already commanded to the first one (or is moved there now)
+    // for each sample, wait till the servo has arrived and settled, and ping the sensor
+    // a fault usually belongs to the direction of its sample (no echo from open space), so the back-off it started is cleared before each ping,
+    // which records the fault for that sample alone instead of reporting every later sample as backing off
+    // an edge storm is the exception, its echo interrupt stays disabled till its own back-off has passed, so the samples swept meanwhile
+    // report it as backing off
+    // as soon as the echo is received, command the servo to the next angle, so that it turns while this result is stored
+    //
+    // once complete, call the callback, reverse the direction and enqueue the next sweep when sweeping continuously
+
+    Kernel::Clock::time_point   readyTime;
+    size_t                      first;
+    uint32_t                    pulse;
+
+    first       = reverse ? count - 1 : 0;
+    readyTime   = Kernel::Clock::now() + move_servo(angle_of(first)) + config.settle;
+
+    for (size_t step = 0; step < count; ++step) {
+
+        size_t          index = reverse ? count - 1 - step : step;
+        HCSR04Status    status;
+
+        ThisThread::sleep_until(readyTime);
+
+        capture.clear_backoff();
+        status = capture.capture(&pulse);
+
+        if (step + 1 < count) {
+            readyTime = Kernel::Clock::now() + move_servo(angle_of(reverse ? index - 1 : index + 1)) + config.settle;
+        }
+
+        samples[index].angle    = angle_of(index);
+        samples[index].distance = (status == HCSR04Status::OK) ? unit.from_pulse(pulse) : 0.0f;
+        samples[index].status   = status;
+    }
+
+    reverse = !reverse;
+
+    if (sweepCb) {
+        sweepCb(samples, count);
+    }
+
+    if (continuous && dispatch.get_queue().call(this, &SweepScanner::sweep) != 0) {
+        return;
+    }
+
+    continuous  = false;
+    busy        = false;
+}
+
+std::chrono::milliseconds
+SweepScanner::move_servo(float angle) {
+
+    // map the angle linearly onto the pulse width of the servo
+    // estimate the travel time from the distance turned
+
+    float   travel;
+
+    servo.pulsewidth_us(config.servoMinPulseUs + (int)((config.servoMaxPulseUs - config.servoMinPulseUs) * angle / config.servoRange));
+
+    travel      = (angle > servoAngle) ? angle - servoAngle : servoAngle - angle;
+    servoAngle  = angle;
+
+    return std::chrono::milliseconds((int)(travel * config.msPerDegree + 0.5f));
+}
+
+float
+SweepScanner::angle_of(size_t index) const {
+
+    return config.startAngle + (config.endAngle - config.startAngle) * index / (count - 1);
+}
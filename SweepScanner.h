@@ -0,0 +1,221 @@
+/**
+ * @file                    SweepScanner.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Scans the surroundings with an HCSR04 sensor mounted on a servo, producing arrays of polar ranges
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __SWEEPSCANNER_H__
+#define __SWEEPSCANNER_H__
+
+#include <cstddef>
+
+#include "mbed.h"
+#include "DispatchThread.h"
+#include "EchoCapture.h"
+#include "HCSR04Units.h"
+
+/**
+ * @brief                   Range measured in one direction of a sweep
+ */
+struct PolarSample {
+
+    /** Angle of the servo in degrees */
+    float           angle;
+    /** Measured distance in centimetres (0 if the measurement failed) */
+    float           distance;
+    /** Outcome of the measurement */
+    HCSR04Status    status;
+};
+
+/**
+ * @brief                   Configuration of the sweep and of the servo of a SweepScanner
+ */
+struct SweepConfig {
+
+    /** Angle of the first sample in degrees */
+    float           startAngle {0};
+    /** Angle of the last sample in degrees */
+    float           endAngle {180};
+    /** Time for the mount to stop vibrating once the servo has reached an angle, before pinging */
+    std::chrono::milliseconds settle {20ms};
+    /** Time taken by the servo to turn by one degree, in milliseconds (about 2 for common hobby servos) */
+    float           msPerDegree {2.0f};
+    /** Width of the servo pulse at 0 degrees in microseconds */
+    uint16_t        servoMinPulseUs {1'000};
+    /** Width of the servo pulse at servoRange degrees in microseconds */
+    uint16_t        servoMaxPulseUs {2'000};
+    /** Range of the servo in degrees */
+    float           servoRange {180};
+};
+
+/**
+ * @brief                   Class that sweeps a sensor across a range of angles using a servo, and fills a caller-provided array of polar ranges
+ *
+ * @remarks                 The servo is commanded to the next angle as soon as the echo of the current ping has been received, so it turns
+ *                          while the result is converted and stored, and the next ping waits only for the rest of the travel and settle time
+ * @remarks                 A sweep takes about count * (travel per step + settle + ping) milliseconds, where a ping takes about 12ms plus
+ *                          the round trip of the echo
+ * @remarks                 Sample i of the array always holds the angle startAngle + i * (endAngle - startAngle) / (count - 1), while continuous
+ *                          sweeps alternate their direction to avoid returning the servo to the start
+ * @remarks                 Every sample is pinged, a fault (for example no echo from a direction with nothing in range) is only recorded in the
+ *                          status of its own sample, instead of making the capture back off for the rest of the sweep
+ * @remarks                 All sweeps run on a single thread owned by the object, and the callback is called on it once a sweep is complete
+ */
+class SweepScanner {
+
+    /** Capture of the echo pulse of the sensor */
+    EchoCapture     capture;
+    /** Conversion of the width of the pulse into a distance */
+    Centimetres     unit;
+    /** PWM output driving the servo */
+    PwmOut          servo;
+    /** Configuration of the sweep and servo */
+    SweepConfig     config;
+
+    /** Array filled by each sweep */
+    PolarSample     *samples;
+    /** Number of samples per sweep */
+    size_t          count;
+    /** Angle to which the servo was most recently commanded */
+    float           servoAngle;
+    /** Whether the next sweep runs from the end angle to the start angle */
+    bool            reverse {false};
+
+    /** Whether a sweep is pending or in progress */
+    volatile bool   busy {false};
+    /** Whether another sweep is started once the current one completes */
+    volatile bool   continuous {false};
+
+    /** Callback when a sweep is complete */
+    Callback<void(const PolarSample *, size_t)> sweepCb;
+
+    /** Thread and queue on which sweeps run (declared last, so that it is stopped before the state it uses is destroyed) */
+    DispatchThread  dispatch;
+
+public:
+
+    /**
+     * @brief               Construct a new SweepScanner object, moving the servo to the start angle
+     *
+     * @param trig          Microcontroller Pin to which the Trig Pin of the sensor is connected
+     * @param echo          Microcontroller Pin to which the Echo Pin of the sensor is connected
+     * @param servoPin      Microcontroller Pin (with PWM) to which the signal of the servo is connected
+     * @param config        Configuration of the sweep and servo
+     * @param samples       Array filled by each sweep, which must outlive the object
+     * @param count         Number of samples per sweep (at least 2)
+     * @param cb            Callback when a sweep is complete, with the array and its size as arguments
+     */
+    SweepScanner(PinName trig, PinName echo, PinName servoPin, const SweepConfig &config, PolarSample *samples, size_t count,
+                 const Callback<void(const PolarSample *, size_t)> &cb);
+
+    SweepScanner(const SweepScanner &) = delete;
+    SweepScanner    &operator=(const SweepScanner &) = delete;
+
+    /**
+     * @brief               Destroy the SweepScanner object, stopping and finalizing it first if required
+     *
+     * @remarks             A sweep in progress is cancelled (its callback is still called)
+     *
+     * @attention           Can not call this method from ISR context
+     */
+    ~SweepScanner();
+
+    /**
+     * @brief               Initializes the object by allocating and starting the thread on which sweeps run (see HCSR04::initialize())
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully allocated and started, false otherwise
+     */
+    bool            initialize();
+
+    /**
+     * @brief               Finalizes the object by stopping and freeing the thread (see HCSR04::finalize())
+     *
+     * @remarks             The object can not be finalized while a sweep is pending or in progress
+     *
+     * @attention           Can not call this method from ISR context
+     * @attention           It is unsafe to call this method from multiple threads concurrently
+     *
+     * @return              true if the thread was successfully stopped and freed, false otherwise
+     */
+    bool            finalize();
+
+    /**
+     * @brief               Asynchronously performs a single sweep and returns immediately
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if the sweep could be enqueued, false if a sweep is already pending or in progress
+     */
+    bool            do_sweep();
+
+    /**
+     * @brief               Starts sweeping continuously, back and forth, and returns immediately
+     *
+     * @remarks             The array is overwritten by the next sweep as soon as the callback returns, so it should be processed (or copied) in the callback
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if sweeping could be started, false if a sweep is already pending or in progress
+     */
+    bool            start_sweeping();
+
+    /**
+     * @brief               Stops sweeping continuously once the current sweep is complete
+     *
+     * @attention           This function can be called from ISR context
+     */
+    void            stop_sweeping();
+
+    /**
+     * @brief               Checks if a sweep is pending or in progress
+     *
+     * @attention           This function can be called from ISR context
+     *
+     * @return              true if a sweep is pending or in progress, false otherwise
+     */
+    bool            is_busy() const;
+
+    /**
+     * @brief               Updates the temperature (and optionally humidity) of the air (see BasicHCSR04::set_temperature())
+     *
+     * @attention           This function can be called from ISR context, and while sweeping
+     *
+     * @param celsius           Temperature of the air in degrees Celsius
+     * @param relativeHumidity  Relative humidity of the air in percent (0 to 100)
+     */
+    void            set_temperature(float celsius, float relativeHumidity = 0.0f);
+
+private:
+
+    /**
+     * @brief           Performs a sweep, calls the callback, and enqueues the next sweep when sweeping continuously
+     */
+    void            sweep();
+
+    /**
+     * @brief           Helper function to command the servo to an angle
+     *
+     * @param angle     Angle in degrees
+     *
+     * @return          Time the servo takes to reach the angle from the previous one
+     */
+    std::chrono::milliseconds move_servo(float angle);
+
+    /**
+     * @brief           Helper function to get the angle of a sample
+     *
+     * @param index     Index of the sample
+     *
+     * @return          Angle in degrees
+     */
+    float           angle_of(size_t index) const;
+};
+
+#endif //__SWEEPSCANNER_H__
@@ -0,0 +1,240 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host benchmark of the RAM and the per-sample overhead of HCSR04Array against N independent HCSR04 objects
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#include "mbed.h"
+#include "HCSR04.h"
+#include "HCSR04Array.h"
+#include "MbedHost.h"
+#include "SimulatedHCSR04.h"
+
+/** Distance to the simulated targets in centimetres */
+constexpr float     TARGET_CM           = 100.0f;
+/** Number of scans (each measuring every sensor once) timed in each configuration */
+constexpr uint32_t  ROUNDS              = 100;
+
+constexpr HCSR04Pins PINS_1[] = {{D0, D1}};
+constexpr HCSR04Pins PINS_2[] = {{D0, D1}, {D2, D3}};
+constexpr HCSR04Pins PINS_4[] = {{D0, D1}, {D2, D3}, {D4, D5}, {D6, D7}};
+constexpr HCSR04Pins PINS_8[] = {{D0, D1}, {D2, D3}, {D4, D5}, {D6, D7}, {D8, D9}, {D10, D11}, {D12, D13}, {D14, D15}};
+
+/**
+ * @brief                   RAM and time taken by a set of sensors
+ */
+struct SetCost {
+
+    /** Bytes of the objects, the pins they allocate and the stacks of their threads */
+    uint64_t        ramBytes;
+    /** Number of threads started by the set */
+    uint32_t        threads;
+    /** Host time per measured sample in microseconds */
+    double          hostUsPerSample;
+    /** Virtual time per measured sample in microseconds */
+    double          virtualUsPerSample;
+};
+
+/**
+ * @brief                   Handler of the array, which wakes up the main thread once every sensor of a scan is measured
+ */
+struct ScanHandler {
+
+    /** Semaphore released for each measurement */
+    static Semaphore    *measured;
+
+    static void
+    on_measurement(size_t, bool, float) {
+
+        measured->release();
+    }
+};
+
+Semaphore *ScanHandler::measured = nullptr;
+
+/**
+ * @brief                   Simulates a sensor on each pair of pins in the table, with a target in range
+ */
+template <size_t N>
+static void
+simulate(const HCSR04Pins (&pins)[N], std::unique_ptr<SimulatedHCSR04> (&simulated)[N]) {
+
+    for (size_t i = 0; i < N; ++i) {
+
+        simulated[i].reset(new SimulatedHCSR04(pins[i].trig, pins[i].echo));
+        simulated[i]->set_distance(TARGET_CM);
+    }
+}
+
+/**
+ * @brief                   Scans an HCSR04Array repeatedly, and times each scan from the request to the last result
+ *
+ * @tparam N                Number of sensors
+ * @tparam Pins             Table of the pins of the sensors
+ *
+ * @param baseStackBytes    Stack held by threads other than those of the array
+ * @param baseThreads       Number of threads other than those of the array
+ */
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+static SetCost
+bench_array(uint64_t baseStackBytes, uint32_t baseThreads) {
+
+    // the array allocates nothing on the heap, so its RAM is the object itself and the stack of its thread
+
+    using Array = HCSR04Array<N, Pins, ScanHandler>;
+
+    Semaphore   measured(0, N);
+    SetCost     cost {};
+    double      hostUs;
+    uint64_t    virtualUs;
+
+    ScanHandler::measured = &measured;
+
+    Array sensors;
+    sensors.initialize();
+
+    cost.ramBytes   = sizeof(Array) + mbed_host::get_thread_stack_bytes() - baseStackBytes;
+    cost.threads    = mbed_host::get_thread_count() - baseThreads;
+
+    hostUs      = 0;
+    virtualUs   = 0;
+
+    for (uint32_t round = 0; round < ROUNDS; ++round) {
+
+        uint64_t startUs    = mbed_host::now_us();
+        auto     hostStart  = std::chrono::steady_clock::now();
+
+        sensors.do_scan();
+        for (size_t i = 0; i < N; ++i) {
+            measured.acquire();
+        }
+
+        hostUs      += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - hostStart).count();
+        virtualUs   += mbed_host::now_us() - startUs;
+    }
+
+    sensors.finalize();
+
+    cost.hostUsPerSample    = hostUs / (ROUNDS * N);
+    cost.virtualUsPerSample = (double)virtualUs / (ROUNDS * N);
+
+    return cost;
+}
+
+/**
+ * @brief                   Measures N independent HCSR04 objects one after the other repeatedly, and times each round the same way as a scan
+ *
+ * @param pins              Table of the pins of the sensors
+ * @param baseStackBytes    Stack held by threads other than those of the sensors
+ * @param baseThreads       Number of threads other than those of the sensors
+ */
+template <size_t N>
+static SetCost
+bench_independent(const HCSR04Pins (&pins)[N], uint64_t baseStackBytes, uint32_t baseThreads) {
+
+    // each object allocates its trigger and echo pins on the heap (see EchoCapture), which is counted with the object
+    // each sensor is only requested once the previous one has reported, so that the sensors are never pinged together, as in a scan
+
+    std::unique_ptr<HCSR04> sensors[N];
+    Semaphore               measured(0, 1);
+    SetCost                 cost {};
+    double                  hostUs;
+    uint64_t                virtualUs;
+
+    for (size_t i = 0; i < N; ++i) {
+
+        sensors[i].reset(new HCSR04(pins[i].trig, pins[i].echo));
+        sensors[i]->initialize();
+    }
+
+    cost.ramBytes   = N * (sizeof(HCSR04) + sizeof(DigitalOut) + sizeof(InterruptIn)) + mbed_host::get_thread_stack_bytes() - baseStackBytes;
+    cost.threads    = mbed_host::get_thread_count() - baseThreads;
+
+    hostUs      = 0;
+    virtualUs   = 0;
+
+    for (uint32_t round = 0; round < ROUNDS; ++round) {
+
+        uint64_t startUs    = mbed_host::now_us();
+        auto     hostStart  = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < N; ++i) {
+
+            sensors[i]->do_measurement([&measured](bool, float) { measured.release(); });
+            measured.acquire();
+        }
+
+        hostUs      += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - hostStart).count();
+        virtualUs   += mbed_host::now_us() - startUs;
+    }
+
+    for (size_t i = 0; i < N; ++i) {
+        sensors[i]->finalize();
+    }
+
+    cost.hostUsPerSample    = hostUs / (ROUNDS * N);
+    cost.virtualUsPerSample = (double)virtualUs / (ROUNDS * N);
+
+    return cost;
+}
+
+/**
+ * @brief                   Benchmarks both layouts for N sensors and prints a row for each
+ */
+template <size_t N, const HCSR04Pins (&Pins)[N]>
+static void
+compare(uint64_t baseStackBytes, uint32_t baseThreads) {
+
+    // the simulated sensors outlive both sets, and are only destroyed once their last echo has been driven
+
+    std::unique_ptr<SimulatedHCSR04>    simulated[N];
+    SetCost                             array;
+    SetCost                             independent;
+
+    simulate(Pins, simulated);
+
+    array       = bench_array<N, Pins>(baseStackBytes, baseThreads);
+    independent = bench_independent(Pins, baseStackBytes, baseThreads);
+
+    printf("%2zu  array         %6llu bytes (%3zu per sensor)  %u thread(s)   %7.2f us host   %6.0f us virtual per sample\n", N,
+           (unsigned long long)array.ramBytes, HCSR04Array<N, Pins, ScanHandler>::PER_SENSOR_BYTES, array.threads, array.hostUsPerSample,
+           array.virtualUsPerSample);
+    printf("%2zu  independent   %6llu bytes                   %u thread(s)   %7.2f us host   %6.0f us virtual per sample\n", N,
+           (unsigned long long)independent.ramBytes, independent.threads, independent.hostUsPerSample, independent.virtualUsPerSample);
+
+    for (size_t i = 0; i < N; ++i) {
+        while (!simulated[i]->is_idle()) {
+            ThisThread::sleep_for(1ms);
+        }
+    }
+}
+
+int
+main() {
+
+    // sizes are those of the host build, so they show how the RAM scales with N rather than the exact bytes on a target
+    // the virtual time per sample is dominated by the capture itself, which is the same in both layouts
+
+    uint64_t    baseStackBytes;
+    uint32_t    baseThreads;
+
+    baseStackBytes  = mbed_host::get_thread_stack_bytes();
+    baseThreads     = mbed_host::get_thread_count();
+
+    printf(" N  layout        RAM (objects, pins and thread stacks)\n");
+
+    compare<1, PINS_1>(baseStackBytes, baseThreads);
+    compare<2, PINS_2>(baseStackBytes, baseThreads);
+    compare<4, PINS_4>(baseStackBytes, baseThreads);
+    compare<8, PINS_8>(baseStackBytes, baseThreads);
+
+    return 0;
+}
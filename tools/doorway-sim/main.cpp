@@ -0,0 +1,213 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host simulation of people crossing a doorway watched by a DoorwayCounter, checking the counts against the crossings
+ *                          at several walking speeds
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "mbed.h"
+#include "DoorwayCounter.h"
+#include "MbedHost.h"
+#include "SimulatedHCSR04.h"
+
+/** Pin of the trigger line of sensor 0 (outside) */
+constexpr PinName   TRIG0_PIN           = D2;
+/** Pin of the echo line of sensor 0 (outside) */
+constexpr PinName   ECHO0_PIN           = D3;
+/** Pin of the trigger line of sensor 1 (inside) */
+constexpr PinName   TRIG1_PIN           = D4;
+/** Pin of the echo line of sensor 1 (inside) */
+constexpr PinName   ECHO1_PIN           = D5;
+
+/** Distance between the two beams in centimetres */
+constexpr float     BEAM_SPACING_CM     = 10.0f;
+/** Depth of a person along the direction of walking in centimetres */
+constexpr float     BODY_DEPTH_CM       = 30.0f;
+/** Distance measured across the doorway to a person in a beam in centimetres */
+constexpr float     PERSON_CM           = 40.0f;
+/** Distance measured across the empty doorway (to the opposite jamb) in centimetres */
+constexpr float     JAMB_CM             = 90.0f;
+/** Distance below which a beam is interrupted in centimetres */
+constexpr float     BLOCK_CM            = 70.0f;
+/** Distance from the midpoint of the beams at which a walk starts and ends in centimetres */
+constexpr float     WALK_REACH_CM       = 80.0f;
+/** Time between the end of a walk and the start of the next one */
+constexpr uint64_t  WALK_GAP_US         = 1'000'000;
+/** Number of walks in each direction at each speed */
+constexpr uint32_t  WALKS               = 25;
+/** Speeds at which people walk through the doorway in metres per second */
+constexpr float     SPEEDS[]            = {0.5f, 1.0f, 1.5f, 2.0f, 3.0f};
+/** Fastest walking speed at which every crossing must be counted correctly, in metres per second */
+constexpr float     MAX_EXACT_SPEED     = 1.5f;
+
+/**
+ * @brief                   Walk of a person through the doorway, along an axis on which sensor 0 is at -BEAM_SPACING_CM / 2 and sensor 1 at
+ *                          +BEAM_SPACING_CM / 2
+ */
+struct Walk {
+
+    /** Virtual time at which the person is WALK_REACH_CM from the midpoint of the beams */
+    uint64_t        startUs;
+    /** Speed of the person in centimetres per microsecond */
+    float           cmPerUs;
+    /** Whether the person walks from the outside (sensor 0) inwards */
+    bool            inward;
+    /** Whether the person turns back at the midpoint of the beams, crossing neither way */
+    bool            turnBack;
+};
+
+/**
+ * @brief                   Get the position of a person on the axis of the doorway
+ *
+ * @param walk              Walk of the person
+ * @param nowUs             Virtual time
+ * @param position          Location to store the position in centimetres
+ *
+ * @return                  true if the person is in the doorway at that time, false otherwise
+ */
+static bool
+position_of(const Walk &walk, uint64_t nowUs, float *position) {
+
+    // a person that turns back walks to the midpoint and retraces their steps, which is as long as crossing
+
+    float   walked;
+
+    if (nowUs < walk.startUs) {
+        return false;
+    }
+
+    walked = walk.cmPerUs * (nowUs - walk.startUs);
+
+    if (walked > 2 * WALK_REACH_CM) {
+        return false;
+    }
+
+    if (walk.turnBack && walked > WALK_REACH_CM) {
+        walked = 2 * WALK_REACH_CM - walked;
+    }
+
+    *position = walk.inward ? walked - WALK_REACH_CM : WALK_REACH_CM - walked;
+    return true;
+}
+
+/**
+ * @brief                   Get the distance measured by a sensor at a point in time
+ *
+ * @param walks             Walks through the doorway, in order
+ * @param beamCm            Position of the beam of the sensor on the axis of the doorway
+ * @param nowUs             Virtual time
+ *
+ * @return                  Distance to a person in the beam, or to the opposite jamb
+ */
+static float
+distance_of(const std::vector<Walk> &walks, float beamCm, uint64_t nowUs) {
+
+    float   position;
+
+    for (const Walk &walk : walks) {
+
+        if (position_of(walk, nowUs, &position) && std::fabs(position - beamCm) < BODY_DEPTH_CM / 2) {
+            return PERSON_CM;
+        }
+    }
+
+    return JAMB_CM;
+}
+
+/**
+ * @brief                   Counts the crossings of people walking through the doorway one at a time at a given speed
+ *
+ * @param speed             Walking speed in metres per second
+ * @param turnBack          Whether every person turns back at the midpoint of the beams
+ * @param inCount           Location to store the number of crossings counted inwards
+ * @param outCount          Location to store the number of crossings counted outwards
+ */
+static void
+run_walks(float speed, bool turnBack, uint32_t *inCount, uint32_t *outCount) {
+
+    // people walk alternately inwards and outwards, one at a time, starting once the counter is running
+    // the simulated sensors are destroyed only once their last echo has been driven
+
+    std::vector<Walk>   walks;
+    SimulatedHCSR04     outside(TRIG0_PIN, ECHO0_PIN);
+    SimulatedHCSR04     inside(TRIG1_PIN, ECHO1_PIN);
+    float               cmPerUs;
+    uint64_t            startUs;
+    uint64_t            walkUs;
+
+    cmPerUs = speed * 100.0f / 1'000'000.0f;
+    walkUs  = (uint64_t)(2 * WALK_REACH_CM / cmPerUs);
+    startUs = mbed_host::now_us() + WALK_GAP_US;
+
+    for (uint32_t i = 0; i < 2 * WALKS; ++i) {
+        walks.push_back({startUs + i * (walkUs + WALK_GAP_US), cmPerUs, i % 2 == 0, turnBack});
+    }
+
+    outside.set_distance([&walks](uint64_t nowUs) { return distance_of(walks, -BEAM_SPACING_CM / 2, nowUs); });
+    inside.set_distance([&walks](uint64_t nowUs) { return distance_of(walks, BEAM_SPACING_CM / 2, nowUs); });
+
+    {
+        DoorwayCounter counter(TRIG0_PIN, ECHO0_PIN, TRIG1_PIN, ECHO1_PIN, BLOCK_CM, nullptr);
+
+        counter.initialize();
+        counter.start();
+
+        ThisThread::sleep_for(std::chrono::microseconds(2 * WALKS * (walkUs + WALK_GAP_US) + WALK_GAP_US));
+
+        *inCount    = counter.get_in_count();
+        *outCount   = counter.get_out_count();
+    }
+
+    while (!outside.is_idle() || !inside.is_idle()) {
+        ThisThread::sleep_for(1ms);
+    }
+}
+
+int
+main() {
+
+    // each sensor is pinged every other DOORWAY_MIN_PING_PERIOD, so a fast walker may cross both beams between two pings of a sensor
+    // every crossing must be counted at ordinary walking speeds, and people that turn back must not be counted
+
+    bool    ok;
+
+    ok = true;
+
+    printf("ping period %lld ms, beams %.0f cm apart, %u people each way per speed\n", (long long)DOORWAY_MIN_PING_PERIOD.count(),
+           BEAM_SPACING_CM, WALKS);
+    printf("speed (m/s)    in   counted    out   counted\n");
+
+    for (float speed : SPEEDS) {
+
+        uint32_t inCount;
+        uint32_t outCount;
+
+        run_walks(speed, false, &inCount, &outCount);
+        printf("%8.1f     %5u   %7u  %5u   %7u\n", speed, WALKS, inCount, WALKS, outCount);
+
+        if (speed <= MAX_EXACT_SPEED) {
+            ok = ok && inCount == WALKS && outCount == WALKS;
+        }
+    }
+
+    {
+        uint32_t inCount;
+        uint32_t outCount;
+
+        run_walks(1.0f, true, &inCount, &outCount);
+        printf("turning back     %5u   %7u  %5u   %7u\n", 0u, inCount, 0u, outCount);
+
+        ok = ok && inCount == 0 && outCount == 0;
+    }
+
+    printf("%s\n", ok ? "counts match" : "COUNTS DO NOT MATCH");
+    return ok ? 0 : 1;
+}
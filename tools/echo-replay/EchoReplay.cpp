@@ -0,0 +1,118 @@
+#include "EchoReplay.h"
+
+#include "MbedHost.h"
+
+// Constructors
+
+EchoReplay::EchoReplay(PinName trig, PinName echo, std::vector<EchoTrace> traces)
+        : trigPin(trig)
+        , echoPin(echo)
+        , traces(std::move(traces))
+{
+
+    mbed_host::on_pin_write(trigPin, this, [this](int level) { on_trigger(level); });
+}
+
+EchoReplay::~EchoReplay() {
+
+    mbed_host::remove_pin_listeners(trigPin, this);
+}
+
+// Public Methods
+
+void
+EchoReplay::start(uint64_t firstStartUs) {
+
+    // the edges before the first capture are replayed relative to its start
+
+    if (!traces.empty()) {
+        schedule_edges(traces[0], false, traces[0].startUs, firstStartUs);
+    }
+}
+
+void
+EchoReplay::on_capture(const EchoTrace &trace) {
+
+    // the next recorded capture collected its edges from the end of this one, so they are replayed relative to now
+
+    replayed.push_back(trace);
+
+    if (++position < traces.size()) {
+        schedule_edges(traces[position], false, traces[position - 1].endUs, mbed_host::now_us());
+    }
+}
+
+const std::vector<EchoTrace> &
+EchoReplay::get_traces() const {
+
+    return traces;
+}
+
+const std::vector<EchoTrace> &
+EchoReplay::get_replayed() const {
+
+    return replayed;
+}
+
+bool
+EchoReplay::is_finished() const {
+
+    return position >= traces.size();
+}
+
+// Private methods
+
+void
+EchoReplay::on_trigger(int level) {
+
+    // the end of the replayed trigger pulse stands in for the end of the recorded one
+    // if the recorded capture did not ping the sensor, there is nothing to answer the trigger with
+
+    bool falling = triggerHigh && level == 0;
+
+    triggerHigh = (level != 0);
+
+    if (falling && position < traces.size() && traces[position].triggerUs != 0) {
+        schedule_edges(traces[position], true, traces[position].triggerUs, mbed_host::now_us());
+    }
+}
+
+void
+EchoReplay::schedule_edges(const EchoTrace &trace, bool afterTrigger, uint32_t recordedUs, uint64_t virtualUs) {
+
+    // an edge belongs after the trigger if the sensor was pinged and the edge did not come before the end of the trigger pulse
+    // edges are lost while the interrupt of the echo line is disabled (edge storm), so before the edges preceding the trigger, the
+    // level that the first of them implies is restored, and at the start of the capture, the level that the capture read
+    // edges that would fall before the current virtual time are replayed right away, in order
+
+    uint8_t stored = echo_trace_stored_edges(trace);
+    bool    levelRestored = afterTrigger;
+
+    for (uint8_t i = 0; i < stored; ++i) {
+
+        bool    rising  = (trace.risingMask >> i) & 1;
+        bool    after   = trace.triggerUs != 0 && (int32_t)(trace.edgesUs[i] - trace.triggerUs) >= 0;
+
+        if (after != afterTrigger) {
+            continue;
+        }
+
+        if (!levelRestored) {
+
+            schedule_level(virtualUs, !rising);
+            levelRestored = true;
+        }
+
+        schedule_level(virtualUs + (int32_t)(trace.edgesUs[i] - recordedUs), rising);
+    }
+
+    if (!afterTrigger) {
+        schedule_level(virtualUs + (int32_t)(trace.startUs - recordedUs), trace.startLevel);
+    }
+}
+
+void
+EchoReplay::schedule_level(int64_t atUs, int level) {
+
+    mbed_host::schedule_at((atUs < 0) ? 0 : (uint64_t)atUs, [this, level]() { mbed_host::set_pin(echoPin, level); });
+}
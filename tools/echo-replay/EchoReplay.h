@@ -0,0 +1,124 @@
+/**
+ * @file                    EchoReplay.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Replay of recorded echo timings on the emulated pins of a sensor, so that they run through EchoCapture itself
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __ECHOREPLAY_H__
+#define __ECHOREPLAY_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "mbed.h"
+#include "EchoTrace.h"
+
+/**
+ * @brief                   Class that drives the echo pin of an emulated sensor with the edges recorded by EchoCapture::set_recorder(), in step
+ *                          with the captures of the EchoCapture (or BasicHCSR04) that replays them
+ *
+ * @remarks                 The edges of a capture that came after its trigger are replayed relative to the end of the replayed trigger pulse, so
+ *                          that the width and timing of the echo are exact even though the trigger is not sent at exactly the recorded time
+ * @remarks                 The other edges (noise, and late echoes that arrived between captures) are replayed relative to the end of the previous
+ *                          capture, and the level of the line is restored where edges were lost (interrupt disabled after an edge storm)
+ * @remarks                 The capture that replays the edges must record its own timings into EchoReplay::on_capture(), which moves the replay
+ *                          on to the next recorded capture
+ */
+class EchoReplay {
+
+    /** Pin of the trigger line of the replaying capture */
+    PinName         trigPin;
+    /** Pin of the echo line of the replaying capture, driven by the replay */
+    PinName         echoPin;
+
+    /** Recorded timings */
+    std::vector<EchoTrace>  traces;
+    /** Timings recorded by the replaying capture */
+    std::vector<EchoTrace>  replayed;
+    /** Index of the recorded capture that is replayed next (or in progress) */
+    size_t          position {0};
+
+    /** Whether the trigger line is high */
+    bool            triggerHigh {false};
+
+public:
+
+    /**
+     * @brief               Construct a new EchoReplay object
+     *
+     * @param trig          Pin of the trigger line of the replaying capture
+     * @param echo          Pin of the echo line of the replaying capture
+     * @param traces        Recorded timings, in order
+     */
+    EchoReplay(PinName trig, PinName echo, std::vector<EchoTrace> traces);
+
+    EchoReplay(const EchoReplay &) = delete;
+    EchoReplay &operator=(const EchoReplay &) = delete;
+
+    /**
+     * @brief               Destroy the EchoReplay object, no longer listening to the trigger pin
+     *
+     * @attention           Must not be destroyed before the replay is finished (see EchoReplay::is_finished())
+     */
+    ~EchoReplay();
+
+    /**
+     * @brief               Starts the replay, with the first recorded capture starting at the given virtual time
+     *
+     * @param firstStartUs  Virtual time at which the replaying capture starts its first capture
+     */
+    void            start(uint64_t firstStartUs);
+
+    /**
+     * @brief               Recorder for the replaying capture (see EchoCapture::set_recorder()), which moves on to the next recorded capture
+     *
+     * @param trace         Timings of the replayed capture
+     */
+    void            on_capture(const EchoTrace &trace);
+
+    /**
+     * @brief               Get the recorded timings
+     */
+    const std::vector<EchoTrace>    &get_traces() const;
+
+    /**
+     * @brief               Get the timings of the replayed captures, in the same order as the recorded ones
+     */
+    const std::vector<EchoTrace>    &get_replayed() const;
+
+    /**
+     * @brief               Checks whether every recorded capture has been replayed
+     */
+    bool            is_finished() const;
+
+private:
+
+    /**
+     * @brief               Handler for writes to the trigger pin, which replays the edges that followed the recorded trigger
+     */
+    void            on_trigger(int level);
+
+    /**
+     * @brief               Schedules the edges of a recorded capture that came before or after its trigger
+     *
+     * @param trace         Recorded capture
+     * @param afterTrigger  Whether to schedule the edges after the trigger (otherwise those before it)
+     * @param recordedUs    Recorded time to which the edges are relative
+     * @param virtualUs     Virtual time that corresponds to recordedUs
+     */
+    void            schedule_edges(const EchoTrace &trace, bool afterTrigger, uint32_t recordedUs, uint64_t virtualUs);
+
+    /**
+     * @brief               Schedules a level of the echo line
+     *
+     * @param atUs          Virtual time of the level (replayed right away if it has passed)
+     * @param level         Level of the echo line
+     */
+    void            schedule_level(int64_t atUs, int level);
+};
+
+#endif //__ECHOREPLAY_H__
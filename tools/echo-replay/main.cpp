@@ -0,0 +1,349 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host tool that records the echo timings of a simulated sensor and replays them through EchoCapture, to reproduce
+ *                          faults and edge storms seen in the field on a host
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "mbed.h"
+#include "BasicHCSR04.h"
+#include "EchoReplay.h"
+#include "MbedHost.h"
+#include "SimulatedHCSR04.h"
+
+/** Pin of the trigger line of the emulated sensor */
+constexpr PinName   TRIG_PIN            = D2;
+/** Pin of the echo line of the emulated sensor */
+constexpr PinName   ECHO_PIN            = D3;
+/** Period of measurement of the recorded scenario */
+constexpr auto      RECORD_PERIOD       = 60ms;
+/** Duration of the recorded scenario */
+constexpr auto      RECORD_DURATION     = 10s;
+/** Interval at which the main thread checks whether the simulation or the replay is finished */
+constexpr auto      REPLAY_POLL         = 100ms;
+/** Time after the end of the last recorded capture at which an unfinished replay is given up, in microseconds */
+constexpr uint64_t  REPLAY_GRACE_US     = 1'000'000;
+
+using Sensor = BasicHCSR04<EchoCapture, Millimetres, HampelFilter<uint32_t, 7>>;
+
+/**
+ * @brief                   Result of a measurement, as reported to the callback
+ */
+struct Outcome {
+
+    bool                ok;
+    Millimetres::value_type dist;
+};
+
+/**
+ * @brief                   Runs a scenario with every fault that EchoCapture handles on a simulated sensor, and records the timings of each capture
+ *
+ * @remarks                 The target moves back and forth, and is interrupted by a burst of noise (edge storm), a missing sensor (stuck low), a
+ *                          lost echo (the 38ms pulse of a sensor that heard nothing), a shorted echo line (stuck high) and slow noise between pings
+ *
+ * @param traces            Location to store the recorded timings
+ * @param outcomes          Location to store the results of the measurements
+ * @param storms            Location to store the number of edge storms detected
+ */
+static void
+record_scenario(std::vector<EchoTrace> *traces, std::vector<Outcome> *outcomes, uint32_t *storms) {
+
+    SimulatedHCSR04 simulated(TRIG_PIN, ECHO_PIN);
+    Sensor          sensor(TRIG_PIN, ECHO_PIN);
+    uint64_t        startUs = mbed_host::now_us();
+
+    simulated.set_distance([startUs](uint64_t nowUs) { return 60.0f + 40.0f * sinf((nowUs - startUs) / 1e6f); });
+
+    mbed_host::schedule_at(startUs + 2'041'000, [&]() { simulated.inject_noise(40, 50); });
+    mbed_host::schedule_at(startUs + 3'500'000, [&]() { simulated.set_fault(SimulatedFault::STUCK_LOW); });
+    mbed_host::schedule_at(startUs + 4'500'000, [&]() { simulated.set_fault(SimulatedFault::NONE); });
+    mbed_host::schedule_at(startUs + 5'500'000, [&]() { simulated.set_distance(-1.0f); });
+    mbed_host::schedule_at(startUs + 6'000'000, [&]() { simulated.set_distance(80.0f); });
+    mbed_host::schedule_at(startUs + 7'000'000, [&]() { simulated.set_fault(SimulatedFault::STUCK_HIGH); });
+    mbed_host::schedule_at(startUs + 8'000'000, [&]() { simulated.set_fault(SimulatedFault::NONE); });
+    mbed_host::schedule_at(startUs + 8'500'000, [&]() { simulated.inject_noise(12, 7'000); });
+
+    sensor.get_capture().set_recorder([traces](const EchoTrace &trace) { traces->push_back(trace); });
+
+    sensor.initialize();
+    sensor.start_measurement_periodic(RECORD_PERIOD, [outcomes](bool ok, Millimetres::value_type dist) { outcomes->push_back({ok, dist}); });
+
+    ThisThread::sleep_for(RECORD_DURATION);
+
+    sensor.stop_measurement_periodic();
+    sensor.finalize();
+    *storms = sensor.get_edge_storm_count();
+
+    while (!simulated.is_idle()) {
+        ThisThread::sleep_for(REPLAY_POLL);
+    }
+}
+
+/**
+ * @brief                   Replays recorded timings through a fresh sensor, with the measurements requested at the recorded times
+ *
+ * @param traces            Recorded timings
+ * @param replayed          Location to store the timings of the replayed captures
+ * @param outcomes          Location to store the results of the replayed measurements
+ * @param storms            Location to store the number of edge storms detected
+ *
+ * @return                  Host time spent replaying in seconds
+ */
+static double
+replay_traces(const std::vector<EchoTrace> &traces, std::vector<EchoTrace> *replayed, std::vector<Outcome> *outcomes, uint32_t *storms) {
+
+    // the measurements are requested from interrupt context at the recorded start of each capture, so that the backoff and the
+    // edge-storm detection see the same timing as the recorded run
+    // if a measurement could not be requested, the replay never finishes, so it is given up a while after the last recorded capture
+
+    EchoReplay  replay(TRIG_PIN, ECHO_PIN, traces);
+    Sensor      sensor(TRIG_PIN, ECHO_PIN);
+    uint64_t    startUs = mbed_host::now_us() + 1'000;
+    uint64_t    giveUpUs = startUs + (uint32_t)(traces.back().endUs - traces[0].startUs) + REPLAY_GRACE_US;
+
+    sensor.get_capture().set_recorder(callback(&replay, &EchoReplay::on_capture));
+    sensor.initialize();
+
+    for (const EchoTrace &trace : traces) {
+
+        mbed_host::schedule_at(startUs + (uint32_t)(trace.startUs - traces[0].startUs), [&sensor, outcomes]() {
+            sensor.do_measurement([outcomes](bool ok, Millimetres::value_type dist) { outcomes->push_back({ok, dist}); });
+        });
+    }
+
+    auto hostStart = std::chrono::steady_clock::now();
+
+    replay.start(startUs);
+    while ((!replay.is_finished() || sensor.get_pending_measurement_count() > 0) && mbed_host::now_us() < giveUpUs) {
+        ThisThread::sleep_for(REPLAY_POLL);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+
+    sensor.finalize();
+    *replayed   = replay.get_replayed();
+    *storms     = sensor.get_edge_storm_count();
+
+    return seconds;
+}
+
+/**
+ * @brief                   Writes recorded timings to a file, packed one after the other
+ */
+static bool
+write_traces(const char *path, const std::vector<EchoTrace> &traces) {
+
+    uint8_t packed[ECHO_TRACE_MAX_PACKED_SIZE];
+    FILE    *file = fopen(path, "wb");
+    bool    ok;
+
+    if (file == nullptr) {
+        return false;
+    }
+
+    ok = true;
+    for (const EchoTrace &trace : traces) {
+
+        size_t size = echo_trace_pack(trace, packed);
+        ok = ok && fwrite(packed, 1, size, file) == size;
+    }
+
+    return (fclose(file) == 0) && ok;
+}
+
+/**
+ * @brief                   Reads timings written by write_traces() (or copied from a device)
+ */
+static bool
+read_traces(const char *path, std::vector<EchoTrace> *traces) {
+
+    std::vector<uint8_t>    data;
+    uint8_t                 chunk[4'096];
+    size_t                  read;
+    size_t                  offset;
+    FILE                    *file = fopen(path, "rb");
+
+    if (file == nullptr) {
+        return false;
+    }
+
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    fclose(file);
+
+    for (offset = 0; offset < data.size();) {
+
+        EchoTrace   trace;
+        size_t      size = echo_trace_unpack(data.data() + offset, data.size() - offset, &trace);
+
+        if (size == 0) {
+            return false;
+        }
+
+        traces->push_back(trace);
+        offset += size;
+    }
+
+    return !traces->empty();
+}
+
+/**
+ * @brief                   Get a short name of a status, for the report
+ */
+static const char *
+status_name(HCSR04Status status) {
+
+    switch (status) {
+        case HCSR04Status::OK:          return "ok";
+        case HCSR04Status::STUCK_LOW:   return "stuck low";
+        case HCSR04Status::STUCK_HIGH:  return "stuck high";
+        case HCSR04Status::BACKOFF:     return "backoff";
+        case HCSR04Status::EDGE_STORM:  return "edge storm";
+        case HCSR04Status::CANCELLED:   return "cancelled";
+        case HCSR04Status::REJECTED:    return "rejected";
+    }
+
+    return "?";
+}
+
+/**
+ * @brief                   Compares the replayed captures with the recorded ones and prints a report
+ *
+ * @return                  true if every capture had the same outcome, and the pulse widths match within a microsecond
+ */
+static bool
+compare_traces(const std::vector<EchoTrace> &traces, const std::vector<EchoTrace> &replayed) {
+
+    uint32_t    counts[(int)HCSR04Status::REJECTED + 1] = {};
+    uint32_t    mismatches;
+    uint32_t    maxPulseDiff;
+
+    mismatches      = (traces.size() == replayed.size()) ? 0 : 1;
+    maxPulseDiff    = 0;
+
+    for (size_t i = 0; i < traces.size() && i < replayed.size(); ++i) {
+
+        uint32_t diff = (uint32_t)std::abs((int64_t)traces[i].pulseUs - (int64_t)replayed[i].pulseUs);
+
+        maxPulseDiff = std::max(maxPulseDiff, diff);
+        ++counts[(int)traces[i].status];
+
+        if (traces[i].status != replayed[i].status || diff > 1) {
+
+            printf("capture %zu       recorded %s (%u us), replayed %s (%u us)\n", i, status_name(traces[i].status), traces[i].pulseUs,
+                   status_name(replayed[i].status), replayed[i].pulseUs);
+            ++mismatches;
+        }
+    }
+
+    printf("captures         %zu recorded, %zu replayed\n", traces.size(), replayed.size());
+    printf("outcomes        ");
+    for (int status = 0; status <= (int)HCSR04Status::REJECTED; ++status) {
+        if (counts[status] > 0) {
+            printf(" %s %u,", status_name((HCSR04Status)status), counts[status]);
+        }
+    }
+    printf(" %u mismatched\n", mismatches);
+    printf("pulse widths     differ by at most %u us\n", maxPulseDiff);
+
+    return mismatches == 0;
+}
+
+/**
+ * @brief                   Compares the distances reported by the replayed measurements and the edge storms detected with the recorded ones
+ */
+static bool
+compare_outcomes(const std::vector<Outcome> &recorded, const std::vector<Outcome> &replayed, uint32_t recordedStorms, uint32_t replayedStorms) {
+
+    uint32_t mismatches = (recorded.size() == replayed.size()) ? 0 : 1;
+
+    for (size_t i = 0; i < recorded.size() && i < replayed.size(); ++i) {
+        mismatches += recorded[i].ok != replayed[i].ok || (recorded[i].ok && recorded[i].dist != replayed[i].dist);
+    }
+
+    printf("distances        %zu recorded, %zu replayed, %u mismatched\n", recorded.size(), replayed.size(), mismatches);
+    printf("edge storms      %u recorded, %u replayed\n", recordedStorms, replayedStorms);
+
+    return mismatches == 0 && recordedStorms == replayedStorms;
+}
+
+int
+main(int argc, char **argv) {
+
+    // "record FILE" records the scenario, "replay FILE" replays a recording and checks that the captures have the same outcome
+    // without arguments, the scenario is recorded, written, read back and replayed, and the distances are compared as well
+
+    std::vector<EchoTrace>  traces;
+    std::vector<EchoTrace>  replayed;
+    std::vector<Outcome>    recordedOutcomes;
+    std::vector<Outcome>    replayedOutcomes;
+    uint32_t                recordedStorms = 0;
+    uint32_t                replayedStorms = 0;
+    const char              *path;
+    bool                    record;
+    bool                    replay;
+    double                  seconds;
+
+    if (argc == 3 && strcmp(argv[1], "record") == 0) {
+        record = true, replay = false;
+    }
+    else if (argc == 3 && strcmp(argv[1], "replay") == 0) {
+        record = false, replay = true;
+    }
+    else if (argc == 1) {
+        record = true, replay = true;
+    }
+    else {
+        fprintf(stderr, "usage: %s [record FILE | replay FILE]\n", argv[0]);
+        return 2;
+    }
+
+    path = (argc == 3) ? argv[2] : "echo-replay.bin";
+
+    if (record) {
+
+        record_scenario(&traces, &recordedOutcomes, &recordedStorms);
+        if (!write_traces(path, traces)) {
+
+            fprintf(stderr, "could not write %s\n", path);
+            return 1;
+        }
+        printf("recorded         %zu captures to %s\n", traces.size(), path);
+        traces.clear();
+    }
+
+    if (!replay) {
+        return 0;
+    }
+
+    if (!read_traces(path, &traces)) {
+
+        fprintf(stderr, "could not read %s\n", path);
+        return 1;
+    }
+
+    seconds = replay_traces(traces, &replayed, &replayedOutcomes, &replayedStorms);
+    printf("replay           %.1f us of host time per capture\n", seconds * 1e6 / traces.size());
+
+    bool ok = compare_traces(traces, replayed);
+
+    if (record) {
+        ok = compare_outcomes(recordedOutcomes, replayedOutcomes, recordedStorms, replayedStorms) && ok;
+    }
+    else {
+        printf("edge storms      %u replayed\n", replayedStorms);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host benchmark of the per-update cost of OccupancyGrid, fed by a ring of sensors in a simulated room, for several
+ *                          grid sizes and numbers of rays per beam
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "OccupancyGrid.h"
+
+/** Number of sensors in the ring */
+constexpr size_t    RING_SENSORS        = 8;
+/** Distance from the centre of the ring to each sensor in centimetres */
+constexpr float     RING_RADIUS_CM      = 10.0f;
+/** Distance from the centre of the ring to each side wall of the room in centimetres */
+constexpr float     SIDE_WALL_CM        = 150.0f;
+/** Distance from the centre of the ring to the front and back walls of the room in centimetres */
+constexpr float     FRONT_WALL_CM       = 100.0f;
+/** Length of the side of the area covered by each grid in centimetres */
+constexpr float     GRID_SPAN_CM        = 400.0f;
+/** Largest distance the sensors can measure in centimetres */
+constexpr float     MAX_RANGE_CM        = 400.0f;
+/** Standard deviation of the noise of a measured distance in centimetres */
+constexpr float     NOISE_CM            = 1.0f;
+/** One in this many measurements fails (no echo), and marks its beam free up to the maximum range */
+constexpr uint32_t  FAILURE_ODDS        = 20;
+/** Time between two measurements of the same sensor in milliseconds (20Hz) */
+constexpr uint32_t  PERIOD_MS           = 50;
+/** Number of measurements fed to each grid */
+constexpr size_t    READINGS            = 400'000;
+
+/** Pi, to convert degrees into radians */
+constexpr float     PI                  = 3.14159265f;
+
+/**
+ * @brief                   Timestamped measurement of a sensor of the ring
+ */
+struct Reading {
+
+    /** Index of the sensor */
+    uint8_t         sensor;
+    /** Time of the measurement in milliseconds */
+    uint32_t        timeMs;
+    /** Whether the measurement was successful */
+    bool            valid;
+    /** Measured distance in centimetres */
+    float           distance;
+};
+
+/**
+ * @brief                   Get the heading of a sensor of the ring, in degrees counter-clockwise from the direction of increasing columns
+ */
+static float
+heading_of(size_t sensor) {
+
+    return 360.0f * sensor / RING_SENSORS;
+}
+
+/**
+ * @brief                   Get the distance from a sensor of the ring to the first wall of the room along its heading
+ *
+ * @param sensor            Index of the sensor
+ *
+ * @return                  Distance in centimetres
+ */
+static float
+wall_distance(size_t sensor) {
+
+    // the sensor sits on the ring, and the nearest of the walls that its axis crosses is measured
+
+    float   dx      = std::cos(heading_of(sensor) * PI / 180);
+    float   dy      = std::sin(heading_of(sensor) * PI / 180);
+    float   x       = RING_RADIUS_CM * dx;
+    float   y       = RING_RADIUS_CM * dy;
+    float   nearest = MAX_RANGE_CM;
+
+    auto hit = [&nearest](float distance) {
+        if (distance > 0 && distance < nearest) {
+            nearest = distance;
+        }
+    };
+
+    if (std::fabs(dx) > 1e-6f) {
+        hit(((dx > 0 ? SIDE_WALL_CM : -SIDE_WALL_CM) - x) / dx);
+    }
+    if (std::fabs(dy) > 1e-6f) {
+        hit(((dy > 0 ? FRONT_WALL_CM : -FRONT_WALL_CM) - y) / dy);
+    }
+
+    return nearest;
+}
+
+/**
+ * @brief                   Generates the measurements of the ring, each sensor measured at PERIOD_MS in turn, with noise and occasional
+ *                          failures
+ *
+ * @return                  Measurements in the order they are made
+ */
+static std::vector<Reading>
+synthesize_readings() {
+
+    std::mt19937                    rng(1);
+    std::normal_distribution<float> noise(0, NOISE_CM);
+    std::vector<Reading>            readings(READINGS);
+
+    for (size_t i = 0; i < READINGS; ++i) {
+
+        uint8_t sensor  = (uint8_t)(i % RING_SENSORS);
+        bool    valid   = rng() % FAILURE_ODDS != 0;
+
+        readings[i] = {sensor, (uint32_t)(i / RING_SENSORS * PERIOD_MS + sensor * PERIOD_MS / RING_SENSORS), valid,
+                       valid ? wall_distance(sensor) + noise(rng) : 0.0f};
+    }
+
+    return readings;
+}
+
+/**
+ * @brief                   Feeds the measurements to a grid centred on the ring, and reports the time per update
+ *
+ * @tparam Cells            Number of columns and rows of the grid
+ * @tparam Rays             Number of rays per beam cone
+ *
+ * @param readings          Measurements of the ring
+ *
+ * @return                  true if every measurement updated the grid, false otherwise
+ */
+template <size_t Cells, size_t Rays>
+static bool
+run_grid(const std::vector<Reading> &readings) {
+
+    // the grid is allocated on the heap, as the larger grids do not fit on the stack
+    // the number of occupied cells is reported both as a check that the walls were mapped and to keep the updates from being optimised away
+
+    using Grid = OccupancyGrid<Cells, Cells, RING_SENSORS, Rays>;
+
+    std::unique_ptr<Grid>   grid(new Grid(GRID_SPAN_CM / Cells, MAX_RANGE_CM));
+    size_t                  updated;
+    size_t                  occupied;
+
+    for (size_t sensor = 0; sensor < RING_SENSORS; ++sensor) {
+
+        float angle = heading_of(sensor) * PI / 180;
+        grid->add_sensor(GRID_SPAN_CM / 2 + RING_RADIUS_CM * std::cos(angle), GRID_SPAN_CM / 2 - RING_RADIUS_CM * std::sin(angle), heading_of(sensor));
+    }
+
+    updated = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (const Reading &reading : readings) {
+        updated += grid->update(reading.sensor, reading.timeMs, reading.valid, reading.distance);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    occupied = 0;
+    for (size_t row = 0; row < Cells; ++row) {
+        for (size_t col = 0; col < Cells; ++col) {
+            occupied += grid->is_occupied(col, row);
+        }
+    }
+
+    printf("%4zu x %-4zu  %5.2f cm  %4zu   %10.1f   %8zu\n", Cells, Cells, GRID_SPAN_CM / Cells, Rays, seconds * 1e9 / readings.size(), occupied);
+
+    return updated == readings.size();
+}
+
+int
+main() {
+
+    // a ring of sensors at the centre of a room measures the walls around it, each sensor in turn at 20Hz
+    // every grid covers the same area, so a finer grid takes more steps along each ray, and more rays per beam take proportionally longer
+    // failed measurements walk their rays up to the maximum range (or the edge of the grid), so they cost the most
+
+    std::vector<Reading>    readings = synthesize_readings();
+    bool                    ok;
+
+    printf("%zu sensors, %zu updates (1 in %u failed), %.0f x %.0f cm room in a %.0f cm grid\n", RING_SENSORS, readings.size(), FAILURE_ODDS,
+           2 * SIDE_WALL_CM, 2 * FRONT_WALL_CM, GRID_SPAN_CM);
+    printf("grid         cell        rays    ns/update   occupied\n");
+
+    ok = run_grid<64, 1>(readings);
+    ok = run_grid<64, 5>(readings) && ok;
+    ok = run_grid<64, 9>(readings) && ok;
+    ok = run_grid<160, 1>(readings) && ok;
+    ok = run_grid<160, 5>(readings) && ok;
+    ok = run_grid<160, 9>(readings) && ok;
+
+    if (!ok) {
+        printf("MEASUREMENTS WERE REJECTED\n");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host benchmark of the time from a request to the start of its capture after an idle period (cold start) and
+ *                          between back-to-back measurements (warm start), and of the RAM held by idle sensors, in lazy and normal mode
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "mbed.h"
+#include "HCSR04.h"
+#include "MbedHost.h"
+#include "SimulatedHCSR04.h"
+
+/** Pin of the trigger line of the emulated sensor */
+constexpr PinName   TRIG_PIN            = D2;
+/** Pin of the echo line of the emulated sensor */
+constexpr PinName   ECHO_PIN            = D3;
+/** Distance to the simulated target in centimetres */
+constexpr float     TARGET_CM           = 100.0f;
+/** Time without measurements after which a lazy sensor frees its thread */
+constexpr auto      IDLE_TIMEOUT        = 200ms;
+/** Time between two measurements of a sensor that is polled occasionally (longer than IDLE_TIMEOUT, so every start is cold) */
+constexpr auto      COLD_INTERVAL       = 1s;
+/** Time between two measurements of a sensor that is polled back to back (shorter than IDLE_TIMEOUT, so every start is warm) */
+constexpr auto      WARM_INTERVAL       = 60ms;
+/** Number of measurements timed in each configuration */
+constexpr uint32_t  ROUNDS              = 200;
+
+/**
+ * @brief                   Time to the first result and RAM held between measurements, over the rounds of a configuration
+ */
+struct StartCost {
+
+    /** Mean virtual time from the request to the callback in microseconds */
+    double          virtualUs;
+    /** Median host time from the request to the rising edge of the trigger pulse in microseconds, which includes creating and starting
+     *  the thread of a cold start */
+    double          startHostUs;
+    /** Mean stack held by the sensor right before each request in bytes */
+    double          idleStackBytes;
+};
+
+/**
+ * @brief                   Get the median of samples
+ */
+static double
+median(std::vector<double> &samples) {
+
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+/**
+ * @brief                   Requests measurements at a fixed interval, and times each one from the request to the start of its capture and to
+ *                          its callback
+ *
+ * @param sensor            Sensor to measure with (initialized)
+ * @param interval          Time to wait before each request
+ * @param baseStackBytes    Stack held by threads other than those of the sensor
+ *
+ * @return                  Averaged costs
+ */
+static StartCost
+time_first_result(HCSR04 &sensor, std::chrono::milliseconds interval, uint64_t baseStackBytes) {
+
+    // the capture starts on the dispatch thread with the rising edge of the trigger pulse, which is noted by a listener on the trigger pin
+    // the host time to that edge leaves out the capture itself, which takes the same (virtual) time in every mode, and which the host
+    // spends emulating
+    // the median is reported, as the host time of a round is sometimes stretched by the scheduler of the host
+
+    Semaphore           done(0, 1);
+    uint64_t            endUs;
+    bool                triggered;
+    std::vector<double> startHostUs;
+    StartCost           cost {};
+
+    auto hostTriggered = std::chrono::steady_clock::now();
+
+    mbed_host::on_pin_write(TRIG_PIN, &cost, [&](int level) {
+
+        if (level != 0 && !triggered) {
+
+            hostTriggered   = std::chrono::steady_clock::now();
+            triggered       = true;
+        }
+    });
+
+    for (uint32_t round = 0; round < ROUNDS; ++round) {
+
+        ThisThread::sleep_for(interval);
+
+        cost.idleStackBytes += mbed_host::get_thread_stack_bytes() - baseStackBytes;
+
+        triggered = false;
+
+        uint64_t startUs    = mbed_host::now_us();
+        auto     hostStart  = std::chrono::steady_clock::now();
+
+        sensor.do_measurement([&](bool, float) {
+
+            endUs = mbed_host::now_us();
+            done.release();
+        });
+        done.acquire();
+
+        cost.virtualUs += endUs - startUs;
+        startHostUs.push_back(std::chrono::duration<double, std::micro>(hostTriggered - hostStart).count());
+    }
+
+    mbed_host::remove_pin_listeners(TRIG_PIN, &cost);
+
+    cost.virtualUs      /= ROUNDS;
+    cost.startHostUs    = median(startHostUs);
+    cost.idleStackBytes /= ROUNDS;
+
+    return cost;
+}
+
+/**
+ * @brief                   Prints the costs of a configuration
+ */
+static void
+print_cost(const char *name, const StartCost &cost) {
+
+    printf("%-16s %8.0f us virtual   %8.1f us host   %6.0f bytes\n", name, cost.virtualUs, cost.startHostUs, cost.idleStackBytes);
+}
+
+int
+main() {
+
+    // the shared event queue (which frees the idle thread of a lazy sensor) is started first, so that its stack is not counted
+    // the virtual time to the first result is dominated by the capture itself, which is the same in every mode, as the emulation does not
+    // charge virtual time for creating a thread
+    // the cost of a cold start is therefore the host time from the request to the start of the capture, which includes creating and
+    // starting the thread, against that of a warm start, which only wakes up the running thread
+
+    SimulatedHCSR04 simulated(TRIG_PIN, ECHO_PIN);
+    uint64_t        baseStackBytes;
+    double          initializeUs;
+    double          initializeLazyUs;
+    StartCost       normal;
+    StartCost       lazyCold;
+    StartCost       lazyWarm;
+
+    simulated.set_distance(TARGET_CM);
+
+    mbed_event_queue();
+    baseStackBytes = mbed_host::get_thread_stack_bytes();
+
+    {
+        HCSR04 sensor(TRIG_PIN, ECHO_PIN);
+
+        auto hostStart = std::chrono::steady_clock::now();
+        sensor.initialize();
+        initializeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - hostStart).count();
+
+        normal = time_first_result(sensor, COLD_INTERVAL, baseStackBytes);
+        sensor.finalize();
+    }
+
+    {
+        HCSR04 sensor(TRIG_PIN, ECHO_PIN);
+
+        auto hostStart = std::chrono::steady_clock::now();
+        sensor.initialize_lazy(IDLE_TIMEOUT);
+        initializeLazyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - hostStart).count();
+
+        lazyCold = time_first_result(sensor, COLD_INTERVAL, baseStackBytes);
+        lazyWarm = time_first_result(sensor, WARM_INTERVAL, baseStackBytes);
+        sensor.finalize();
+    }
+
+    printf("initialize       %8.1f us host (normal), %.1f us host (lazy)\n", initializeUs, initializeLazyUs);
+    printf("                    to the result      to the capture   stack held while idle\n");
+    print_cost("normal", normal);
+    print_cost("lazy, cold", lazyCold);
+    print_cost("lazy, warm", lazyWarm);
+    printf("cold start       capture started %.1f us host after the request, against %.1f us for a warm start\n", lazyCold.startHostUs,
+           lazyWarm.startHostUs);
+
+    return 0;
+}
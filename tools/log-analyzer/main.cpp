@@ -0,0 +1,470 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host tool to analyse logs of the binary frames streamed by SampleStreamer, in parallel across cores
+ *
+ * @remarks                 The measurements are processed by the same classes as on the device (HampelFilter, RunningStats, P2Quantile,
+ *                          OccupancyDetector), so the reported figures match those computed by firmware built the same way
+ * @remarks                 Frames carry distances rounded to whole millimetres, so the figures only match firmware whose sensors use the
+ *                          Millimetres unit policy (and HampelFilter<uint32_t, 7>), which processes the same values; with the Centimetres unit
+ *                          policy the firmware processes unrounded distances and its figures differ slightly
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "HCSR04Filters.h"
+#include "OccupancyDetector.h"
+#include "P2Quantile.h"
+#include "RunningStats.h"
+#include "SampleFrame.h"
+
+/** Number of sensor ids a frame can carry */
+constexpr size_t    MAX_SENSORS         = 256;
+/** Number of distances in the window of the Hampel filter */
+constexpr size_t    HAMPEL_WINDOW       = 7;
+/** Smallest part of a log decoded by one task, so that tiny logs are not split needlessly */
+constexpr size_t    MIN_CHUNK_SIZE      = 1 << 20;
+/** Number of chunks per thread, so that threads that finish early pick up more work */
+constexpr size_t    CHUNKS_PER_THREAD   = 4;
+
+/**
+ * @brief                   Decoded measurement of a sensor
+ */
+struct Sample {
+
+    /** Time of the measurement in milliseconds, relative to the start of its chunk */
+    uint32_t        timeMs;
+    /** Distance in millimetres (SAMPLE_DISTANCE_INVALID for a failed measurement) */
+    uint16_t        distanceMm;
+};
+
+/**
+ * @brief                   Measurements decoded from a contiguous part of a log
+ */
+struct Chunk {
+
+    /** First byte of the chunk (just after a delimiter, or the start of the log) */
+    const uint8_t   *begin;
+    /** Byte after the last byte of the chunk (just after a delimiter, or the end of the log) */
+    const uint8_t   *end;
+
+    /** Measurements of each sensor, in order */
+    std::vector<Sample> samples[MAX_SENSORS];
+    /** Sum of the time deltas of the frames of the chunk in milliseconds */
+    uint64_t        durationMs {0};
+    /** Number of frames decoded */
+    uint64_t        frames {0};
+    /** Number of frames missing according to the sequence numbers (within the chunk) */
+    uint64_t        lost {0};
+    /** Number of corrupted frames */
+    uint64_t        corrupted {0};
+    /** Sequence numbers of the first and last frames */
+    uint16_t        firstSequence {0};
+    uint16_t        lastSequence {0};
+};
+
+/**
+ * @brief                   Results of the analysis of a sensor
+ */
+struct SensorReport {
+
+    /** Summary of the filtered distances */
+    RunningSummary  summary {};
+    /** Median of the filtered distances */
+    float           median {0};
+    /** 95th percentile of the filtered distances */
+    float           p95 {0};
+    /** Number of spikes replaced by the Hampel filter */
+    uint32_t        spikes {0};
+    /** Number of times the sensor became occupied */
+    uint32_t        occupancies {0};
+    /** Total time for which the sensor was occupied in milliseconds */
+    uint64_t        occupiedMs {0};
+};
+
+/**
+ * @brief                   Options of the tool
+ */
+struct Options {
+
+    /** Number of worker threads */
+    unsigned        threads {std::thread::hardware_concurrency()};
+    /** Whether distances are passed through the Hampel filter before they are analysed */
+    bool            filter {true};
+    /** Thresholds and debounce settings of the occupancy detectors (distances in millimetres) */
+    OccupancyConfig occupancy {1'000, 1'200, 200, 2'000, 3, 3};
+};
+
+/**
+ * @brief                   Runs a task for every index from 0 to count - 1 on a pool of threads
+ *
+ * @param threads           Number of threads
+ * @param count             Number of tasks
+ * @param task              Function called with the index of each task
+ */
+template <typename Task>
+static void
+parallel_for(unsigned threads, size_t count, const Task &task) {
+
+    // the threads take the next index from a shared counter, so that the tasks do not need to take the same time
+
+    std::atomic<size_t>         next {0};
+    std::vector<std::thread>    pool;
+
+    for (unsigned t = 0; t < threads; ++t) {
+
+        pool.emplace_back([&]() {
+
+            for (size_t i = next++; i < count; i = next++) {
+                task(i);
+            }
+        });
+    }
+
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief                   Splits a log into chunks that start and end at frame boundaries
+ *
+ * @param data              Contents of the log
+ * @param size              Size of the log in bytes
+ * @param count             Desired number of chunks
+ *
+ * @return                  Chunks covering the whole log
+ */
+static std::vector<Chunk>
+split_log(const uint8_t *data, size_t size, size_t count) {
+
+    // move each nominal boundary forward to just after the next delimiter, so that no frame is split between two chunks
+
+    std::vector<Chunk>  chunks;
+    const uint8_t       *begin;
+    const uint8_t       *end;
+
+    begin = data;
+
+    for (size_t i = 1; i <= count && begin < data + size; ++i) {
+
+        end = (i == count) ? data + size : data + size / count * i;
+
+        if (end < begin) {
+            end = begin;
+        }
+
+        end = (const uint8_t *)memchr(end, 0, data + size - end);
+        end = (end == nullptr) ? data + size : end + 1;
+
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end   = end;
+
+        begin = end;
+    }
+
+    return chunks;
+}
+
+/**
+ * @brief                   Decodes the frames of a chunk
+ *
+ * @param chunk             Chunk to decode
+ */
+static void
+decode_chunk(Chunk &chunk) {
+
+    // timestamps are accumulated relative to the start of the chunk, the offsets of the chunks are known once all of them are decoded
+
+    SampleFrameDecoder  decoder;
+    SampleRecord        record;
+    uint64_t            timeMs;
+
+    timeMs = 0;
+
+    for (const uint8_t *byte = chunk.begin; byte < chunk.end; ++byte) {
+
+        if (!decoder.push(*byte, &record)) {
+            continue;
+        }
+
+        if (chunk.frames == 0) {
+            chunk.firstSequence = record.sequence;
+        }
+        else {
+            chunk.lost += (uint16_t)(record.sequence - chunk.lastSequence - 1);
+        }
+
+        timeMs              += record.deltaMs;
+        chunk.lastSequence  = record.sequence;
+        ++chunk.frames;
+
+        chunk.samples[record.sensorId].push_back({(uint32_t)timeMs, record.distanceMm});
+    }
+
+    chunk.durationMs    = timeMs;
+    chunk.corrupted     = decoder.get_error_count();
+}
+
+/**
+ * @brief                   Analyses the measurements of a sensor across all chunks, in order
+ *
+ * @param chunks            Decoded chunks
+ * @param offsets           Time at which each chunk starts in milliseconds
+ * @param sensor            Id of the sensor
+ * @param options           Options of the tool
+ *
+ * @return                  Results of the analysis
+ */
+static SensorReport
+analyse_sensor(const std::vector<Chunk> &chunks, const std::vector<uint64_t> &offsets, size_t sensor, const Options &options) {
+
+    // feed the measurements through the same pipeline as on the device, the filter first and then the statistics and detectors
+    // the filter works on floats holding whole millimetres, the median of the odd window is always one of them, so it replaces spikes
+    // by the same values as HampelFilter<uint32_t, HAMPEL_WINDOW> with the Millimetres unit policy
+    // the occupancy detector sees 32-bit timestamps that wrap around, the same as Kernel::Clock based timestamps on the device
+
+    HampelFilter<float, HAMPEL_WINDOW>  filter;
+    RunningStats                        stats;
+    P2Quantile                          median(0.5f);
+    P2Quantile                          p95(0.95f);
+    OccupancyDetector                   occupancy(options.occupancy);
+    SensorReport                        report;
+    uint64_t                            occupiedSince;
+
+    occupiedSince = 0;
+
+    for (size_t c = 0; c < chunks.size(); ++c) {
+
+        for (const Sample &sample : chunks[c].samples[sensor]) {
+
+            uint64_t    timeMs  = offsets[c] + sample.timeMs;
+            bool        valid   = sample.distanceMm != SAMPLE_DISTANCE_INVALID;
+            float       value   = sample.distanceMm;
+
+            if (valid) {
+
+                if (options.filter) {
+                    filter.apply(&value);
+                }
+
+                stats.add(value);
+                median.add(value);
+                p95.add(value);
+            }
+            else {
+                stats.add_invalid();
+            }
+
+            if (occupancy.add((uint32_t)timeMs, valid, value)) {
+
+                if (occupancy.is_occupied()) {
+
+                    occupiedSince = timeMs;
+                    ++report.occupancies;
+                }
+                else {
+                    report.occupiedMs += timeMs - occupiedSince;
+                }
+            }
+        }
+    }
+
+    report.summary  = stats.get_summary();
+    report.median   = median.get();
+    report.p95      = p95.get();
+    report.spikes   = filter.get_spike_count();
+
+    return report;
+}
+
+/**
+ * @brief                   Analyses a log and prints its report
+ *
+ * @param path              Path of the log
+ * @param options           Options of the tool
+ *
+ * @return                  true if the log could be read, false otherwise
+ */
+static bool
+analyse_log(const char *path, const Options &options) {
+
+    // map the log into memory, so that the threads decode it straight from the page cache
+    // decode the chunks in parallel, then compute the offset of each chunk from the durations of the ones before it
+    // finally, analyse the sensors in parallel, each one sequentially across the chunks (the detectors depend on the order of the measurements)
+
+    struct stat                 info;
+    int                         fd;
+    const uint8_t               *data;
+    std::vector<Chunk>          chunks;
+    std::vector<uint64_t>       offsets;
+    std::vector<size_t>         sensors;
+    std::vector<SensorReport>   reports;
+    uint64_t                    frames;
+    uint64_t                    lost;
+    uint64_t                    corrupted;
+    size_t                      chunkCount;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &info) != 0) {
+
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    if (info.st_size == 0) {
+
+        printf("%s: empty\n", path);
+        close(fd);
+        return true;
+    }
+
+    data = (const uint8_t *)mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+
+        perror(path);
+        return false;
+    }
+
+    madvise((void *)data, info.st_size, MADV_SEQUENTIAL);
+
+    auto start = std::chrono::steady_clock::now();
+
+    chunkCount  = (size_t)info.st_size / MIN_CHUNK_SIZE + 1;
+    chunkCount  = (chunkCount < options.threads * CHUNKS_PER_THREAD) ? chunkCount : options.threads * CHUNKS_PER_THREAD;
+    chunks      = split_log(data, info.st_size, chunkCount);
+
+    parallel_for(options.threads, chunks.size(), [&](size_t i) {
+        decode_chunk(chunks[i]);
+    });
+
+    auto decoded = std::chrono::steady_clock::now();
+
+    frames      = 0;
+    lost        = 0;
+    corrupted   = 0;
+
+    for (size_t c = 0; c < chunks.size(); ++c) {
+
+        offsets.push_back((c == 0) ? 0 : offsets[c - 1] + chunks[c - 1].durationMs);
+
+        if (c > 0 && chunks[c].frames > 0 && chunks[c - 1].frames > 0) {
+            lost += (uint16_t)(chunks[c].firstSequence - chunks[c - 1].lastSequence - 1);
+        }
+
+        frames      += chunks[c].frames;
+        lost        += chunks[c].lost;
+        corrupted   += chunks[c].corrupted;
+    }
+
+    for (size_t sensor = 0; sensor < MAX_SENSORS; ++sensor) {
+
+        for (const Chunk &chunk : chunks) {
+
+            if (!chunk.samples[sensor].empty()) {
+
+                sensors.push_back(sensor);
+                break;
+            }
+        }
+    }
+
+    reports.resize(sensors.size());
+
+    parallel_for(options.threads, sensors.size(), [&](size_t i) {
+        reports[i] = analyse_sensor(chunks, offsets, sensors[i], options);
+    });
+
+    auto end = std::chrono::steady_clock::now();
+
+    double decodeSeconds    = std::chrono::duration<double>(decoded - start).count();
+    double totalSeconds     = std::chrono::duration<double>(end - start).count();
+
+    printf("%s: %llu frames, %llu lost, %llu corrupted, %.1f s of data\n", path, (unsigned long long)frames, (unsigned long long)lost,
+           (unsigned long long)corrupted, (offsets.back() + chunks.back().durationMs) / 1000.0);
+    printf("%6s %10s %8s %9s %9s %7s %7s %7s %7s %7s %7s %10s\n", "sensor", "count", "invalid", "mean", "stddev", "min", "max", "median", "p95",
+           "spikes", "occupied", "occupied_s");
+
+    for (size_t i = 0; i < sensors.size(); ++i) {
+
+        const SensorReport &report = reports[i];
+
+        printf("%6zu %10u %8u %9.1f %9.1f %7.0f %7.0f %7.1f %7.1f %7u %7u %10.1f\n", sensors[i], report.summary.count, report.summary.invalidCount,
+               report.summary.mean, sqrtf(report.summary.variance), report.summary.min, report.summary.max, report.median, report.p95, report.spikes,
+               report.occupancies, report.occupiedMs / 1000.0);
+    }
+
+    printf("%zu chunks on %u threads, decoded in %.3f s, analysed in %.3f s (%.0f MB/s)\n", chunks.size(), options.threads, decodeSeconds,
+           totalSeconds - decodeSeconds, info.st_size / totalSeconds / 1e6);
+
+    munmap((void *)data, info.st_size);
+    return true;
+}
+
+int
+main(int argc, char **argv) {
+
+    // parse the options, then analyse every log given as argument
+
+    Options options;
+    int     arg;
+    bool    ok;
+
+    for (arg = 1; arg < argc && argv[arg][0] == '-'; ++arg) {
+
+        if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+            options.threads = atoi(argv[++arg]);
+        }
+        else if (strcmp(argv[arg], "--raw") == 0) {
+            options.filter = false;
+        }
+        else if (strcmp(argv[arg], "--enter") == 0 && arg + 1 < argc) {
+            options.occupancy.enterDistance = atof(argv[++arg]);
+        }
+        else if (strcmp(argv[arg], "--exit") == 0 && arg + 1 < argc) {
+            options.occupancy.exitDistance = atof(argv[++arg]);
+        }
+        else {
+            break;
+        }
+    }
+
+    if (arg == argc) {
+
+        fprintf(stderr, "usage: %s [-j THREADS] [--raw] [--enter MM] [--exit MM] LOG...\n", argv[0]);
+        return 1;
+    }
+
+    if (options.threads == 0) {
+        options.threads = 1;
+    }
+
+    ok = true;
+    for (; arg < argc; ++arg) {
+        ok = analyse_log(argv[arg], options) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
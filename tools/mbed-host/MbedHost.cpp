@@ -0,0 +1,1200 @@
+#include "MbedHost.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+
+using mbed_host::detail::FOREVER;
+using mbed_host::detail::Lock;
+
+namespace {
+
+/**
+ * @brief                   Emulated thread blocked on a condition
+ */
+struct Waiter {
+
+    /** Condition the thread waits for */
+    const std::function<bool()>     *ready;
+    /** Virtual time at which the thread stops waiting */
+    uint64_t        deadlineUs;
+    /** Whether the thread was woken up (and counted as running again) */
+    bool            woken;
+};
+
+/**
+ * @brief                   State of a pin
+ */
+struct PinState {
+
+    /** Level of the pin */
+    int             level {0};
+    /** Edge handlers of the InterruptIns on the pin, by owner */
+    std::list<std::pair<const void *, std::function<void(bool)>>>   handlers;
+    /** Functions called when a DigitalOut writes the pin, by owner */
+    std::list<std::pair<const void *, std::function<void(int)>>>    listeners;
+    /** Pulse width driven by a PwmOut in microseconds */
+    uint32_t        pwmPulsewidthUs {0};
+};
+
+/**
+ * @brief                   State of the emulation, protected by its mutex
+ */
+struct Emulation {
+
+    std::mutex      mutex;
+    /** Condition variable on which blocked threads wait to be woken up */
+    std::condition_variable     wakeup;
+
+    /** Current virtual time in microseconds */
+    uint64_t        nowUs {0};
+    /** Number of emulated threads that are not blocked (the thread of main() counts from the start) */
+    int             running {1};
+    /** Whether a thread is advancing virtual time and running interrupt handlers */
+    bool            advancing {false};
+    /** Whether the blocked threads must be re-evaluated once the interrupt handlers are done */
+    bool            notifyPending {false};
+
+    /** Functions to run in interrupt context, by virtual time and ID */
+    std::map<std::pair<uint64_t, uint64_t>, std::function<void()>>  scheduled;
+    /** Virtual time of each scheduled function, by ID */
+    std::map<uint64_t, uint64_t>    scheduledTimes;
+    /** ID of the next scheduled function */
+    uint64_t        nextScheduleId {1};
+
+    /** Blocked threads */
+    std::list<Waiter *>     waiters;
+    /** State of the pins */
+    std::map<int, PinState> pins;
+
+    /** ID of the next event posted to any event queue */
+    int             nextEventId {1};
+
+    /** Number of rtos::Thread objects that exist */
+    uint32_t        threadCount {0};
+    /** Stack size of all rtos::Thread objects that exist, in bytes */
+    uint64_t        threadStackBytes {0};
+};
+
+/** Whether the calling thread runs an interrupt handler */
+thread_local bool   isrActive {false};
+
+/**
+ * @brief                   Get the state of the emulation, which is never destroyed so that detached threads can outlive main()
+ */
+Emulation &
+emulation() {
+
+    static Emulation *state = new Emulation();
+    return *state;
+}
+
+/**
+ * @brief                   Wakes up the blocked threads whose condition holds or whose deadline has passed
+ */
+void
+wake_ready(Emulation &emu) {
+
+    // interrupt handlers at the same instant all run before any thread resumes, as on a microcontroller
+
+    if (emu.advancing) {
+
+        emu.notifyPending = true;
+        return;
+    }
+
+    for (Waiter *waiter : emu.waiters) {
+
+        if (!waiter->woken && ((*waiter->ready)() || waiter->deadlineUs <= emu.nowUs)) {
+
+            waiter->woken = true;
+            ++emu.running;
+        }
+    }
+
+    emu.wakeup.notify_all();
+}
+
+/**
+ * @brief                   Advances virtual time to the next deadline or scheduled function, and runs the functions that are due
+ */
+void
+advance(Emulation &emu, Lock &lock) {
+
+    // every thread is blocked, so the next thing that can happen is the earliest scheduled function or deadline
+    // if there is none, every thread waits forever, which is a deadlock of the emulated program
+
+    uint64_t next = FOREVER;
+
+    if (!emu.scheduled.empty()) {
+        next = emu.scheduled.begin()->first.first;
+    }
+    for (Waiter *waiter : emu.waiters) {
+
+        if (!waiter->woken) {
+            next = std::min(next, waiter->deadlineUs);
+        }
+    }
+
+    if (next == FOREVER) {
+
+        fprintf(stderr, "mbed-host: deadlock at %.6f s, every thread is blocked forever\n", emu.nowUs / 1e6);
+        abort();
+    }
+
+    emu.advancing   = true;
+    emu.nowUs       = std::max(emu.nowUs, next);
+
+    while (!emu.scheduled.empty() && emu.scheduled.begin()->first.first <= emu.nowUs) {
+
+        auto                    first   = emu.scheduled.begin();
+        std::function<void()>   isr     = std::move(first->second);
+
+        emu.scheduledTimes.erase(first->first.second);
+        emu.scheduled.erase(first);
+
+        lock.unlock();
+        mbed_host::detail::run_isr(isr);
+        lock.lock();
+    }
+
+    emu.advancing       = false;
+    emu.notifyPending   = false;
+
+    wake_ready(emu);
+}
+
+} // namespace
+
+// Emulation core
+
+Lock
+mbed_host::detail::lock() {
+
+    return Lock(emulation().mutex);
+}
+
+uint64_t
+mbed_host::detail::now_us(const Lock &) {
+
+    return emulation().nowUs;
+}
+
+bool
+mbed_host::detail::block(Lock &lock, const std::function<bool()> &ready, uint64_t deadlineUs) {
+
+    // the thread stops counting as running while it waits, and whoever wakes it up counts it again
+    // the last thread to block advances virtual time, the others wait to be woken up
+    // a condition that no longer holds when the thread resumes (another thread got there first) is waited for again
+
+    Emulation   &emu = emulation();
+    Waiter      waiter {&ready, deadlineUs, false};
+
+    for (;;) {
+
+        if (ready()) {
+            return true;
+        }
+        if (deadlineUs <= emu.nowUs) {
+            return false;
+        }
+
+        waiter.woken = false;
+        emu.waiters.push_back(&waiter);
+        --emu.running;
+
+        while (!waiter.woken) {
+
+            if (emu.running == 0 && !emu.advancing) {
+                advance(emu, lock);
+            }
+            else {
+                emu.wakeup.wait(lock);
+            }
+        }
+
+        emu.waiters.remove(&waiter);
+    }
+}
+
+void
+mbed_host::detail::notify(const Lock &) {
+
+    wake_ready(emulation());
+}
+
+uint64_t
+mbed_host::detail::schedule(const Lock &, uint64_t atUs, std::function<void()> isr) {
+
+    Emulation   &emu    = emulation();
+    uint64_t    id      = emu.nextScheduleId++;
+
+    atUs = std::max(atUs, emu.nowUs);
+
+    emu.scheduled.emplace(std::make_pair(atUs, id), std::move(isr));
+    emu.scheduledTimes.emplace(id, atUs);
+
+    return id;
+}
+
+void
+mbed_host::detail::unschedule(const Lock &, uint64_t id) {
+
+    Emulation   &emu    = emulation();
+    auto        time    = emu.scheduledTimes.find(id);
+
+    if (time != emu.scheduledTimes.end()) {
+
+        emu.scheduled.erase(std::make_pair(time->second, id));
+        emu.scheduledTimes.erase(time);
+    }
+}
+
+void
+mbed_host::detail::run_isr(const std::function<void()> &isr) {
+
+    bool wasActive = isrActive;
+
+    isrActive = true;
+    isr();
+    isrActive = wasActive;
+}
+
+bool
+mbed_host::detail::in_isr() {
+
+    return isrActive;
+}
+
+// Pins
+
+int
+mbed_host::detail::read_pin(PinName pin) {
+
+    Lock l = lock();
+    return emulation().pins[pin].level;
+}
+
+void
+mbed_host::detail::write_pin(PinName pin, int level) {
+
+    // the listeners are called without the lock, so that they can schedule the reaction of the hardware
+
+    std::list<std::pair<const void *, std::function<void(int)>>>    listeners;
+
+    if (pin == NC) {
+        return;
+    }
+
+    {
+        Lock        l       = lock();
+        PinState    &state  = emulation().pins[pin];
+
+        state.level = (level != 0);
+        listeners   = state.listeners;
+    }
+
+    for (auto &listener : listeners) {
+        listener.second(level != 0);
+    }
+}
+
+void
+mbed_host::detail::attach_pin(PinName pin, const void *owner, const std::function<void(bool rising)> &handler) {
+
+    Lock l = lock();
+    emulation().pins[pin].handlers.emplace_back(owner, handler);
+}
+
+void
+mbed_host::detail::detach_pin(PinName pin, const void *owner) {
+
+    Lock l = lock();
+    emulation().pins[pin].handlers.remove_if([owner](const std::pair<const void *, std::function<void(bool)>> &handler) {
+        return handler.first == owner;
+    });
+}
+
+void
+mbed_host::detail::set_pwm(PinName pin, uint32_t periodUs, uint32_t pulsewidthUs) {
+
+    (void)periodUs;
+
+    Lock l = lock();
+    emulation().pins[pin].pwmPulsewidthUs = pulsewidthUs;
+}
+
+// Functions for the host tools
+
+uint64_t
+mbed_host::now_us() {
+
+    Lock l = detail::lock();
+    return emulation().nowUs;
+}
+
+void
+mbed_host::schedule_at(uint64_t atUs, std::function<void()> isr) {
+
+    Lock l = detail::lock();
+    detail::schedule(l, atUs, std::move(isr));
+}
+
+void
+mbed_host::schedule_in(uint64_t delayUs, std::function<void()> isr) {
+
+    Lock l = detail::lock();
+    detail::schedule(l, emulation().nowUs + delayUs, std::move(isr));
+}
+
+void
+mbed_host::set_pin(PinName pin, int level) {
+
+    // only a change of level is an edge, the handlers are called without the lock as they take it themselves
+
+    std::list<std::pair<const void *, std::function<void(bool)>>> handlers;
+
+    {
+        Lock        l       = detail::lock();
+        PinState    &state  = emulation().pins[pin];
+
+        if (state.level == (level != 0)) {
+            return;
+        }
+
+        state.level = (level != 0);
+        handlers    = state.handlers;
+    }
+
+    for (auto &handler : handlers) {
+        detail::run_isr([&handler, level]() { handler.second(level != 0); });
+    }
+}
+
+int
+mbed_host::get_pin(PinName pin) {
+
+    return detail::read_pin(pin);
+}
+
+void
+mbed_host::on_pin_write(PinName pin, const void *owner, std::function<void(int level)> listener) {
+
+    Lock l = detail::lock();
+    emulation().pins[pin].listeners.emplace_back(owner, std::move(listener));
+}
+
+void
+mbed_host::remove_pin_listeners(PinName pin, const void *owner) {
+
+    Lock l = detail::lock();
+    emulation().pins[pin].listeners.remove_if([owner](const std::pair<const void *, std::function<void(int)>> &listener) {
+        return listener.first == owner;
+    });
+}
+
+uint32_t
+mbed_host::get_thread_count() {
+
+    Lock l = detail::lock();
+    return emulation().threadCount;
+}
+
+uint64_t
+mbed_host::get_thread_stack_bytes() {
+
+    Lock l = detail::lock();
+    return emulation().threadStackBytes;
+}
+
+uint32_t
+mbed_host::get_pwm_pulsewidth_us(PinName pin) {
+
+    Lock l = detail::lock();
+    return emulation().pins[pin].pwmPulsewidthUs;
+}
+
+// Drivers
+
+mbed::DigitalOut::DigitalOut(PinName pin, int value)
+        : pin(pin)
+{
+
+    mbed_host::detail::write_pin(pin, value);
+}
+
+void
+mbed::DigitalOut::write(int value) {
+
+    mbed_host::detail::write_pin(pin, value);
+}
+
+int
+mbed::DigitalOut::read() {
+
+    return mbed_host::detail::read_pin(pin);
+}
+
+int
+mbed::DigitalOut::is_connected() {
+
+    return pin != NC;
+}
+
+mbed::DigitalIn::DigitalIn(PinName pin, PinMode)
+        : pin(pin)
+{
+}
+
+int
+mbed::DigitalIn::read() {
+
+    return mbed_host::detail::read_pin(pin);
+}
+
+void
+mbed::DigitalIn::mode(PinMode) {
+}
+
+mbed::InterruptIn::InterruptIn(PinName pin, PinMode)
+        : pin(pin)
+{
+
+    mbed_host::detail::attach_pin(pin, this, [this](bool rising) { on_edge(rising); });
+}
+
+mbed::InterruptIn::~InterruptIn() {
+
+    mbed_host::detail::detach_pin(pin, this);
+}
+
+int
+mbed::InterruptIn::read() {
+
+    return mbed_host::detail::read_pin(pin);
+}
+
+void
+mbed::InterruptIn::mode(PinMode) {
+}
+
+void
+mbed::InterruptIn::rise(Callback<void()> func) {
+
+    Lock l = mbed_host::detail::lock();
+    riseHandler = std::move(func);
+}
+
+void
+mbed::InterruptIn::fall(Callback<void()> func) {
+
+    Lock l = mbed_host::detail::lock();
+    fallHandler = std::move(func);
+}
+
+void
+mbed::InterruptIn::enable_irq() {
+
+    Lock l = mbed_host::detail::lock();
+    irqEnabled = true;
+}
+
+void
+mbed::InterruptIn::disable_irq() {
+
+    Lock l = mbed_host::detail::lock();
+    irqEnabled = false;
+}
+
+void
+mbed::InterruptIn::on_edge(bool rising) {
+
+    Callback<void()> handler;
+
+    {
+        Lock l = mbed_host::detail::lock();
+
+        if (irqEnabled) {
+            handler = rising ? riseHandler : fallHandler;
+        }
+    }
+
+    if (handler) {
+        handler();
+    }
+}
+
+mbed::PwmOut::PwmOut(PinName pin)
+        : pin(pin)
+{
+
+    mbed_host::detail::set_pwm(pin, periodUs, pulsewidthUs);
+}
+
+void
+mbed::PwmOut::period(float seconds) {
+
+    period_us((int)(seconds * 1e6f));
+}
+
+void
+mbed::PwmOut::period_ms(int ms) {
+
+    period_us(ms * 1'000);
+}
+
+void
+mbed::PwmOut::period_us(int us) {
+
+    periodUs        = (uint32_t)us;
+    pulsewidthUs    = std::min(pulsewidthUs, periodUs);
+
+    mbed_host::detail::set_pwm(pin, periodUs, pulsewidthUs);
+}
+
+void
+mbed::PwmOut::pulsewidth(float seconds) {
+
+    pulsewidth_us((int)(seconds * 1e6f));
+}
+
+void
+mbed::PwmOut::pulsewidth_ms(int ms) {
+
+    pulsewidth_us(ms * 1'000);
+}
+
+void
+mbed::PwmOut::pulsewidth_us(int us) {
+
+    pulsewidthUs = std::min((uint32_t)us, periodUs);
+    mbed_host::detail::set_pwm(pin, periodUs, pulsewidthUs);
+}
+
+void
+mbed::PwmOut::write(float duty) {
+
+    pulsewidth_us((int)(std::min(std::max(duty, 0.0f), 1.0f) * periodUs));
+}
+
+float
+mbed::PwmOut::read() {
+
+    return (float)pulsewidthUs / periodUs;
+}
+
+void
+mbed::Timer::start() {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (!running) {
+
+        running = true;
+        startUs = mbed_host::detail::now_us(l);
+    }
+}
+
+void
+mbed::Timer::stop() {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (running) {
+
+        running     = false;
+        elapsedUs   += mbed_host::detail::now_us(l) - startUs;
+    }
+}
+
+void
+mbed::Timer::reset() {
+
+    Lock l = mbed_host::detail::lock();
+
+    elapsedUs   = 0;
+    startUs     = mbed_host::detail::now_us(l);
+}
+
+std::chrono::microseconds
+mbed::Timer::elapsed_time() const {
+
+    Lock l = mbed_host::detail::lock();
+    return std::chrono::microseconds(elapsedUs + (running ? mbed_host::detail::now_us(l) - startUs : 0));
+}
+
+mbed::Timeout::~Timeout() {
+
+    detach();
+}
+
+void
+mbed::Timeout::detach() {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (eventId != 0) {
+
+        mbed_host::detail::unschedule(l, eventId);
+        eventId = 0;
+    }
+}
+
+void
+mbed::Timeout::attach_us(Callback<void()> func, uint64_t delayUs) {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (eventId != 0) {
+        mbed_host::detail::unschedule(l, eventId);
+    }
+
+    handler = std::move(func);
+    eventId = mbed_host::detail::schedule(l, mbed_host::detail::now_us(l) + delayUs, [this]() { fire(); });
+}
+
+void
+mbed::Timeout::fire() {
+
+    // the handler may attach the timeout again, so it is called without the lock and after clearing the ID
+
+    Callback<void()> func;
+
+    {
+        Lock l = mbed_host::detail::lock();
+
+        eventId = 0;
+        func    = handler;
+    }
+
+    if (func) {
+        func();
+    }
+}
+
+mbed::BufferedSerial::BufferedSerial(PinName, PinName, int)
+{
+}
+
+ssize_t
+mbed::BufferedSerial::write(const void *buffer, size_t size) {
+
+    return (ssize_t)fwrite(buffer, 1, size, stdout);
+}
+
+ssize_t
+mbed::BufferedSerial::read(void *, size_t) {
+
+    return -11;
+}
+
+int
+mbed::BufferedSerial::set_blocking(bool) {
+
+    return 0;
+}
+
+// RTOS
+
+rtos::Kernel::Clock::time_point
+rtos::Kernel::Clock::now() {
+
+    return time_point(std::chrono::milliseconds(get_ms_count()));
+}
+
+uint64_t
+rtos::Kernel::get_ms_count() {
+
+    Lock l = mbed_host::detail::lock();
+    return mbed_host::detail::now_us(l) / 1'000;
+}
+
+rtos::Semaphore::Semaphore(int32_t count, uint16_t maxCount)
+        : count(count)
+        , maxCount(maxCount)
+{
+}
+
+void
+rtos::Semaphore::acquire() {
+
+    Lock l = mbed_host::detail::lock();
+
+    mbed_host::detail::block(l, [this]() { return count > 0; }, FOREVER);
+    --count;
+}
+
+bool
+rtos::Semaphore::try_acquire() {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (count == 0) {
+        return false;
+    }
+
+    --count;
+    return true;
+}
+
+bool
+rtos::Semaphore::try_acquire_for_us(uint64_t timeoutUs) {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (!mbed_host::detail::block(l, [this]() { return count > 0; }, mbed_host::detail::now_us(l) + timeoutUs)) {
+        return false;
+    }
+
+    --count;
+    return true;
+}
+
+rtos::osStatus
+rtos::Semaphore::release() {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (count >= maxCount) {
+        return osErrorResource;
+    }
+
+    ++count;
+    mbed_host::detail::notify(l);
+
+    return osOK;
+}
+
+void
+rtos::Mutex::lock() {
+
+    Lock l = mbed_host::detail::lock();
+
+    std::thread::id self = std::this_thread::get_id();
+
+    mbed_host::detail::block(l, [this, self]() { return depth == 0 || owner == self; }, FOREVER);
+
+    owner = self;
+    ++depth;
+}
+
+bool
+rtos::Mutex::trylock() {
+
+    Lock l = mbed_host::detail::lock();
+
+    std::thread::id self = std::this_thread::get_id();
+
+    if (depth != 0 && owner != self) {
+        return false;
+    }
+
+    owner = self;
+    ++depth;
+
+    return true;
+}
+
+void
+rtos::Mutex::unlock() {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (--depth == 0) {
+
+        owner = std::thread::id();
+        mbed_host::detail::notify(l);
+    }
+}
+
+uint32_t
+rtos::EventFlags::set(uint32_t flags) {
+
+    Lock l = mbed_host::detail::lock();
+
+    this->flags |= flags;
+    mbed_host::detail::notify(l);
+
+    return this->flags;
+}
+
+uint32_t
+rtos::EventFlags::clear(uint32_t flags) {
+
+    Lock l = mbed_host::detail::lock();
+
+    uint32_t previous = this->flags;
+
+    this->flags &= ~flags;
+    return previous;
+}
+
+uint32_t
+rtos::EventFlags::get() const {
+
+    Lock l = mbed_host::detail::lock();
+    return flags;
+}
+
+uint32_t
+rtos::EventFlags::wait_any(uint32_t flags, uint32_t millisec, bool clear) {
+
+    return wait(flags, millisec, clear, false);
+}
+
+uint32_t
+rtos::EventFlags::wait_all(uint32_t flags, uint32_t millisec, bool clear) {
+
+    return wait(flags, millisec, clear, true);
+}
+
+uint32_t
+rtos::EventFlags::wait(uint32_t flags, uint32_t millisec, bool clear, bool all) {
+
+    // on a timeout, osFlagsErrorTimeout is returned as in MBed OS
+
+    Lock l = mbed_host::detail::lock();
+
+    uint64_t    deadlineUs  = (millisec == 0xFFFFFFFF) ? FOREVER : mbed_host::detail::now_us(l) + millisec * 1'000ull;
+    auto        ready       = [this, flags, all]() { return all ? (this->flags & flags) == flags : (this->flags & flags) != 0; };
+
+    if (!mbed_host::detail::block(l, ready, deadlineUs)) {
+        return 0xFFFFFFFEu;
+    }
+
+    uint32_t result = this->flags;
+
+    if (clear) {
+        this->flags &= ~flags;
+    }
+    return result;
+}
+
+rtos::Thread::Thread(osPriority priority, uint32_t stack_size, unsigned char *, const char *name)
+        : priority(priority)
+        , stackSize(stack_size)
+        , threadName(name)
+{
+
+    // a thread of MBed OS allocates its stack when it is constructed, so that is when its memory is counted
+
+    Lock l = mbed_host::detail::lock();
+
+    ++emulation().threadCount;
+    emulation().threadStackBytes += stackSize;
+}
+
+rtos::Thread::~Thread() {
+
+    // MBed OS terminates a thread that is still running, which can not be done to a thread of the host
+
+    {
+        Lock l = mbed_host::detail::lock();
+
+        --emulation().threadCount;
+        emulation().threadStackBytes -= stackSize;
+    }
+
+    if (started && !joined) {
+
+        Lock l = mbed_host::detail::lock();
+
+        if (!finished) {
+
+            fprintf(stderr, "mbed-host: thread destroyed while running, which the emulation does not support\n");
+            abort();
+        }
+
+        l.unlock();
+        handle.join();
+    }
+}
+
+rtos::osStatus
+rtos::Thread::start(mbed::Callback<void()> task) {
+
+    // the new thread counts as running from now on, till it returns from the task
+
+    Lock l = mbed_host::detail::lock();
+
+    if (started) {
+        return osErrorResource;
+    }
+
+    started = true;
+    ++emulation().running;
+
+    handle = std::thread([this, task]() {
+
+        task();
+
+        Lock l = mbed_host::detail::lock();
+
+        finished = true;
+        --emulation().running;
+
+        mbed_host::detail::notify(l);
+    });
+
+    return osOK;
+}
+
+rtos::osStatus
+rtos::Thread::join() {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (!started || joined) {
+        return osError;
+    }
+
+    mbed_host::detail::block(l, [this]() { return finished; }, FOREVER);
+    l.unlock();
+
+    handle.join();
+    joined = true;
+
+    return osOK;
+}
+
+rtos::osStatus
+rtos::Thread::terminate() {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (started && !finished) {
+
+        fprintf(stderr, "mbed-host: Thread::terminate() of a running thread is not supported by the emulation\n");
+        abort();
+    }
+
+    return osOK;
+}
+
+rtos::Thread::State
+rtos::Thread::get_state() const {
+
+    Lock l = mbed_host::detail::lock();
+
+    if (!started) {
+        return Inactive;
+    }
+    return finished ? Deleted : Running;
+}
+
+rtos::osPriority
+rtos::Thread::get_priority() const {
+
+    return priority;
+}
+
+uint32_t
+rtos::Thread::stack_size() const {
+
+    return stackSize;
+}
+
+const char *
+rtos::Thread::get_name() const {
+
+    return threadName;
+}
+
+void
+rtos::ThisThread::sleep_until(Kernel::Clock::time_point absTime) {
+
+    Lock l = mbed_host::detail::lock();
+    mbed_host::detail::block(l, []() { return false; }, (uint64_t)absTime.time_since_epoch().count() * 1'000);
+}
+
+void
+rtos::ThisThread::sleep_for_us(uint64_t us) {
+
+    Lock l = mbed_host::detail::lock();
+    mbed_host::detail::block(l, []() { return false; }, mbed_host::detail::now_us(l) + us);
+}
+
+void
+rtos::ThisThread::yield() {
+
+    std::this_thread::yield();
+}
+
+// Event queues
+
+events::EventQueue::EventQueue(unsigned size, unsigned char *)
+        : capacity(size / EVENTS_EVENT_SIZE)
+{
+}
+
+events::EventQueue::~EventQueue() {
+
+    Lock l = mbed_host::detail::lock();
+    events.clear();
+}
+
+int
+events::EventQueue::post(uint64_t delayUs, uint64_t periodUs, bool periodic, std::function<void()> function) {
+
+    // a full queue fails the post with an ID of 0, as on a target
+
+    Lock        l   = mbed_host::detail::lock();
+    Emulation   &emu = emulation();
+
+    if (events.size() >= capacity) {
+        return 0;
+    }
+
+    int id = emu.nextEventId;
+
+    emu.nextEventId = (emu.nextEventId == INT32_MAX) ? 1 : emu.nextEventId + 1;
+
+    events.push_back(Event {id, emu.nowUs + delayUs, periodUs, periodic, std::move(function)});
+    mbed_host::detail::notify(l);
+
+    return id;
+}
+
+bool
+events::EventQueue::cancel(int id) {
+
+    // a periodic event stays in the queue while it runs, so it can be cancelled from its own callback
+
+    Lock l = mbed_host::detail::lock();
+
+    auto event = std::find_if(events.begin(), events.end(), [id](const Event &event) { return event.id == id; });
+
+    if (event == events.end()) {
+        return false;
+    }
+
+    events.erase(event);
+    return true;
+}
+
+void
+events::EventQueue::break_dispatch() {
+
+    Lock l = mbed_host::detail::lock();
+
+    breakRequested = true;
+    mbed_host::detail::notify(l);
+}
+
+void
+events::EventQueue::dispatch_forever() {
+
+    dispatch_us(FOREVER);
+}
+
+void
+events::EventQueue::dispatch_once() {
+
+    dispatch_us(0);
+}
+
+void
+events::EventQueue::dispatch_us(uint64_t durationUs) {
+
+    // run the due events in order of their due time (in order of posting for the same due time), without the lock
+    // a periodic event is rescheduled before it runs, and a one-shot event is removed
+    // return once the break is requested or the duration has passed, and otherwise wait for the next event to become due
+    // an event posted while waiting that is due before the end of the wait also ends it, so that the wait is shortened to its due time
+
+    Lock        l   = mbed_host::detail::lock();
+    Emulation   &emu = emulation();
+
+    uint64_t    endUs = (durationUs == FOREVER) ? FOREVER : emu.nowUs + durationUs;
+
+    auto earliest = [this]() {
+        return std::min_element(events.begin(), events.end(), [](const Event &a, const Event &b) { return a.dueUs < b.dueUs; });
+    };
+
+    for (;;) {
+
+        if (breakRequested) {
+
+            breakRequested = false;
+            return;
+        }
+
+        auto next = earliest();
+
+        if (next != events.end() && next->dueUs <= emu.nowUs) {
+
+            std::function<void()> function;
+
+            if (next->periodic) {
+
+                function    = next->function;
+                next->dueUs += next->periodUs;
+            }
+            else {
+
+                function = std::move(next->function);
+                events.erase(next);
+            }
+
+            l.unlock();
+            function();
+            l.lock();
+
+            continue;
+        }
+
+        if (emu.nowUs >= endUs) {
+            return;
+        }
+
+        uint64_t wakeUs = (next != events.end()) ? std::min(endUs, next->dueUs) : endUs;
+
+        mbed_host::detail::block(l, [this, &emu, &earliest, wakeUs]() {
+            auto next = earliest();
+            return breakRequested || (next != events.end() && (next->dueUs <= emu.nowUs || next->dueUs < wakeUs));
+        }, wakeUs);
+    }
+}
+
+events::EventQueue *
+mbed_event_queue() {
+
+    // the queue and its thread are never destroyed, so that events can still be posted while main() returns
+
+    static events::EventQueue *queue = []() {
+
+        events::EventQueue  *shared = new events::EventQueue(16 * events::EVENTS_EVENT_SIZE);
+        rtos::Thread        *thread = new rtos::Thread(rtos::osPriorityNormal, rtos::OS_STACK_SIZE, nullptr, "shared_event_queue");
+
+        thread->start(mbed::callback(shared, &events::EventQueue::dispatch_forever));
+        return shared;
+    }();
+
+    return queue;
+}
+
+// Platform
+
+bool
+core_util_is_isr_active() {
+
+    return mbed_host::detail::in_isr();
+}
+
+uint32_t
+us_ticker_read() {
+
+    Lock l = mbed_host::detail::lock();
+    return (uint32_t)mbed_host::detail::now_us(l);
+}
+
+void
+wait_us(int us) {
+
+    // a busy wait takes virtual time like any other wait, except in interrupt context where time can not pass
+
+    if (!core_util_is_isr_active()) {
+        rtos::ThisThread::sleep_for_us((uint64_t)us);
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ * @file                    MbedHost.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Functions with which host tools drive the emulation of MBed OS (see mbed.h) and the hardware around it
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __MBEDHOST_H__
+#define __MBEDHOST_H__
+
+#include <cstdint>
+#include <functional>
+
+#include "mbed.h"
+
+/**
+ * @remarks                 The thread that runs main() is an emulated thread, so the emulation advances while it sleeps (ThisThread::sleep_for())
+ *                          or waits, and stands still while it computes
+ * @remarks                 Threads of the host that are not started through rtos::Thread must not call into the emulation
+ */
+namespace mbed_host {
+
+/**
+ * @brief                   Get the current virtual time
+ *
+ * @return                  Microseconds of virtual time since the start of the program
+ */
+uint64_t            now_us();
+
+/**
+ * @brief                   Schedules a function to run in interrupt context at a point in virtual time, for example to drive a pin
+ *
+ * @param atUs              Virtual time at which to run the function (the current time if it has passed)
+ * @param isr               Function to run
+ */
+void                schedule_at(uint64_t atUs, std::function<void()> isr);
+
+/**
+ * @brief                   Schedules a function to run in interrupt context after a delay of virtual time
+ *
+ * @param delayUs           Delay in microseconds
+ * @param isr               Function to run
+ */
+void                schedule_in(uint64_t delayUs, std::function<void()> isr);
+
+/**
+ * @brief                   Drives the level of an input pin, calling the edge handlers of the InterruptIns on it if the level changes
+ *
+ * @attention               Must only be called from a function run by mbed_host::schedule_at() or mbed_host::schedule_in(), so that the
+ *                          handlers run in interrupt context while every thread is blocked
+ *
+ * @param pin               Pin to drive
+ * @param level             Level of the pin (0 or 1)
+ */
+void                set_pin(PinName pin, int level);
+
+/**
+ * @brief                   Get the level of a pin, as last written by a DigitalOut or driven by mbed_host::set_pin()
+ */
+int                 get_pin(PinName pin);
+
+/**
+ * @brief                   Registers a function that is called whenever a DigitalOut writes to a pin, for example to model a sensor
+ *
+ * @remarks                 The function is called in the context of the writer, so it should only schedule the reaction of the model
+ *                          (see mbed_host::schedule_in())
+ *
+ * @param pin               Pin to listen to
+ * @param owner             Owner of the listener (see mbed_host::remove_pin_listeners())
+ * @param listener          Function called with the written level
+ */
+void                on_pin_write(PinName pin, const void *owner, std::function<void(int level)> listener);
+
+/**
+ * @brief                   Removes the functions registered by an owner with mbed_host::on_pin_write(), before the owner is destroyed
+ *
+ * @param pin               Pin listened to
+ * @param owner             Owner of the listeners
+ */
+void                remove_pin_listeners(PinName pin, const void *owner);
+
+/**
+ * @brief                   Get the number of rtos::Thread objects that exist (including the thread of the shared event queue once it is used)
+ */
+uint32_t            get_thread_count();
+
+/**
+ * @brief                   Get the total stack size of the rtos::Thread objects that exist, which is the RAM they hold on the target
+ *
+ * @return                  Stack size in bytes
+ */
+uint64_t            get_thread_stack_bytes();
+
+/**
+ * @brief                   Get the pulse width driven by the PwmOut on a pin
+ *
+ * @return                  Pulse width in microseconds (0 if no PwmOut drives the pin)
+ */
+uint32_t            get_pwm_pulsewidth_us(PinName pin);
+
+} // namespace mbed_host
+
+#endif //__MBEDHOST_H__
@@ -0,0 +1,104 @@
+#include "SimulatedHCSR04.h"
+
+#include "MbedHost.h"
+
+// Constructors
+
+SimulatedHCSR04::SimulatedHCSR04(PinName trig, PinName echo)
+        : trigPin(trig)
+        , echoPin(echo)
+        , distance([](uint64_t) { return -1.0f; })
+{
+
+    mbed_host::on_pin_write(trigPin, this, [this](int level) { on_trigger(level); });
+}
+
+SimulatedHCSR04::~SimulatedHCSR04() {
+
+    mbed_host::remove_pin_listeners(trigPin, this);
+}
+
+// Public Methods
+
+void
+SimulatedHCSR04::set_distance(float cm) {
+
+    distance = [cm](uint64_t) { return cm; };
+}
+
+void
+SimulatedHCSR04::set_distance(std::function<float(uint64_t nowUs)> cm) {
+
+    distance = std::move(cm);
+}
+
+void
+SimulatedHCSR04::set_fault(SimulatedFault fault) {
+
+    this->fault = fault;
+    mbed_host::set_pin(echoPin, fault == SimulatedFault::STUCK_HIGH);
+}
+
+void
+SimulatedHCSR04::inject_noise(uint32_t edges, uint32_t intervalUs) {
+
+    for (uint32_t i = 0; i < edges + (edges & 1); ++i) {
+        schedule_echo((uint64_t)i * intervalUs, -1);
+    }
+}
+
+uint32_t
+SimulatedHCSR04::get_ping_count() const {
+
+    return pingCount;
+}
+
+bool
+SimulatedHCSR04::is_idle() const {
+
+    return scheduledCount == 0;
+}
+
+// Private methods
+
+void
+SimulatedHCSR04::on_trigger(int level) {
+
+    // the ping is sent at the falling edge of the trigger pulse, unless the sensor is faulty or still busy with the previous echo
+    // the echo pulse is scheduled as interrupts of the emulation, as the listener runs on the thread that wrote the trigger
+
+    bool    falling = triggerHigh && level == 0;
+    float   cm;
+    uint64_t widthUs;
+
+    triggerHigh = (level != 0);
+
+    if (!falling || busy || fault != SimulatedFault::NONE) {
+        return;
+    }
+
+    cm      = distance(mbed_host::now_us());
+    widthUs = (cm < 0) ? SIMULATED_NO_ECHO_US : (uint64_t)(cm * SIMULATED_US_PER_CM + 0.5f);
+
+    busy    = true;
+    ++pingCount;
+
+    schedule_echo(SIMULATED_ECHO_DELAY_US, 1);
+    schedule_echo(SIMULATED_ECHO_DELAY_US + widthUs, 0);
+}
+
+void
+SimulatedHCSR04::schedule_echo(uint64_t delayUs, int level) {
+
+    // the end of the echo pulse frees the sensor for the next ping
+
+    ++scheduledCount;
+
+    mbed_host::schedule_in(delayUs, [this, level]() {
+
+        mbed_host::set_pin(echoPin, (level < 0) ? !mbed_host::get_pin(echoPin) : level);
+
+        busy = busy && level != 0;
+        --scheduledCount;
+    });
+}
@@ -0,0 +1,144 @@
+/**
+ * @file                    SimulatedHCSR04.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Model of an HCSR04 sensor connected to emulated pins, for host tools built on the emulation of MBed OS
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __SIMULATEDHCSR04_H__
+#define __SIMULATEDHCSR04_H__
+
+#include <cstdint>
+#include <functional>
+
+#include "mbed.h"
+
+/** Delay between the end of the trigger pulse and the start of the echo pulse of a typical sensor in microseconds */
+constexpr uint32_t  SIMULATED_ECHO_DELAY_US     = 460;
+/** Width of the echo pulse of a typical sensor when nothing reflects the ping in microseconds */
+constexpr uint32_t  SIMULATED_NO_ECHO_US        = 38'000;
+/** Width of the echo pulse per centimetre of distance, at 343 m/s */
+constexpr float     SIMULATED_US_PER_CM         = 2e4f / 343.0f;
+
+/**
+ * @brief                   Fault of a simulated sensor
+ */
+enum class SimulatedFault : uint8_t {
+
+    /** The sensor works */
+    NONE,
+    /** The echo line stays low (sensor missing or broken wire) */
+    STUCK_LOW,
+    /** The echo line stays high (shorted line or locked-up sensor) */
+    STUCK_HIGH
+};
+
+/**
+ * @brief                   Class that answers the trigger pulses written to an emulated pin with echo pulses on another one
+ *
+ * @remarks                 The echo pulse starts SIMULATED_ECHO_DELAY_US after the end of the trigger pulse, and is as wide as the round trip
+ *                          of the ping to the current distance, or SIMULATED_NO_ECHO_US wide if nothing is in range
+ * @remarks                 Triggers that arrive while an echo pulse is in progress are ignored, as by a real sensor
+ */
+class SimulatedHCSR04 {
+
+    /** Pin of the trigger line (driven by the library) */
+    PinName         trigPin;
+    /** Pin of the echo line (driven by this model) */
+    PinName         echoPin;
+
+    /** Distance to the target in centimetres at a point in virtual time, negative if nothing is in range */
+    std::function<float(uint64_t)>  distance;
+    /** Fault of the sensor */
+    SimulatedFault  fault {SimulatedFault::NONE};
+
+    /** Whether the trigger line is high */
+    bool            triggerHigh {false};
+    /** Whether an echo pulse is scheduled or in progress */
+    bool            busy {false};
+    /** Number of pings answered */
+    uint32_t        pingCount {0};
+    /** Number of changes of the echo line that are scheduled and have not happened yet */
+    uint32_t        scheduledCount {0};
+
+public:
+
+    /**
+     * @brief               Construct a new SimulatedHCSR04 object, with nothing in range
+     *
+     * @param trig          Pin to which the trigger line is connected
+     * @param echo          Pin to which the echo line is connected
+     */
+    SimulatedHCSR04(PinName trig, PinName echo);
+
+    SimulatedHCSR04(const SimulatedHCSR04 &) = delete;
+    SimulatedHCSR04 &operator=(const SimulatedHCSR04 &) = delete;
+
+    /**
+     * @brief               Destroy the SimulatedHCSR04 object, no longer listening to the trigger pin
+     *
+     * @attention           Must not be destroyed while changes of the echo line are scheduled (see SimulatedHCSR04::is_idle())
+     */
+    ~SimulatedHCSR04();
+
+    /**
+     * @brief               Sets a fixed distance to the target
+     *
+     * @param cm            Distance in centimetres, negative if nothing is in range
+     */
+    void            set_distance(float cm);
+
+    /**
+     * @brief               Sets the distance to the target as a function of time, for a moving target
+     *
+     * @param cm            Function from the virtual time in microseconds to the distance in centimetres
+     */
+    void            set_distance(std::function<float(uint64_t nowUs)> cm);
+
+    /**
+     * @brief               Sets the fault of the sensor, driving the echo line accordingly
+     *
+     * @attention           Must only be called from a function scheduled with mbed_host::schedule_in() or mbed_host::schedule_at()
+     *
+     * @param fault         Fault of the sensor
+     */
+    void            set_fault(SimulatedFault fault);
+
+    /**
+     * @brief               Toggles the echo line repeatedly, as electrical noise would
+     *
+     * @param edges         Number of edges (rounded up to an even number, so that the line ends low)
+     * @param intervalUs    Time between two edges in microseconds
+     */
+    void            inject_noise(uint32_t edges, uint32_t intervalUs);
+
+    /**
+     * @brief               Get the number of pings answered with an echo pulse
+     */
+    uint32_t        get_ping_count() const;
+
+    /**
+     * @brief               Checks whether no change of the echo line (echo pulse or noise) is scheduled
+     */
+    bool            is_idle() const;
+
+private:
+
+    /**
+     * @brief               Schedules a change of the echo line
+     *
+     * @param delayUs       Delay of the change in microseconds
+     * @param level         Level of the echo line after the change (toggled if negative)
+     */
+    void            schedule_echo(uint64_t delayUs, int level);
+
+    /**
+     * @brief               Handler for writes to the trigger pin, which answers the end of a trigger pulse
+     */
+    void            on_trigger(int level);
+};
+
+#endif //__SIMULATEDHCSR04_H__
@@ -0,0 +1,695 @@
+/**
+ * @file                    mbed.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host emulation of the parts of the MBed OS 6 API used by the library, so that the library runs unmodified on a host
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __MBED_HOST_MBED_H__
+#define __MBED_HOST_MBED_H__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <sys/types.h>
+
+/**
+ * @remarks                 Every thread, event queue and pin is emulated in virtual time, which only advances once every emulated thread is blocked
+ *                          (sleeping, waiting on a semaphore, mutex or event queue, or joining a thread), so the timing of the library is exact
+ *                          and repeatable regardless of the speed of the host
+ * @remarks                 Interrupt handlers (pin edges, timeouts) only run while every emulated thread is blocked, so they never run concurrently
+ *                          with thread code, as on a single-core microcontroller
+ * @remarks                 Work done by the threads takes no virtual time, see MbedHost.h for the functions that drive the emulation
+ */
+
+using namespace std::chrono_literals;
+namespace chrono = std::chrono;
+
+/**
+ * @brief                   Names of the pins of the emulated board (the Arduino header of a Nucleo board)
+ */
+enum PinName {
+
+    D0, D1, D2, D3, D4, D5, D6, D7, D8, D9, D10, D11, D12, D13, D14, D15,
+    A0, A1, A2, A3, A4, A5,
+
+    /** Not connected */
+    NC = -1
+};
+
+/**
+ * @brief                   Pull resistor of an input pin (accepted and ignored)
+ */
+enum PinMode {
+
+    PullNone,
+    PullUp,
+    PullDown
+};
+
+namespace mbed_host {
+namespace detail {
+
+/** Lock held while reading or changing the state of the emulation */
+using Lock = std::unique_lock<std::mutex>;
+
+/** Point in virtual time that never comes, used as the deadline of waits without a timeout */
+constexpr uint64_t  FOREVER = UINT64_MAX;
+
+/**
+ * @brief                   Takes the lock of the emulation
+ */
+Lock                lock();
+
+/**
+ * @brief                   Get the current virtual time in microseconds (the lock must be held)
+ */
+uint64_t            now_us(const Lock &lock);
+
+/**
+ * @brief                   Blocks the calling emulated thread till the condition holds or the deadline passes, advancing virtual time if every
+ *                          emulated thread is blocked
+ *
+ * @param lock              Lock of the emulation, held on entry and on return
+ * @param ready             Condition to wait for, evaluated with the lock held
+ * @param deadlineUs        Virtual time at which to stop waiting (FOREVER to wait without a timeout)
+ *
+ * @return                  Value of the condition on return (false if the deadline passed)
+ */
+bool                block(Lock &lock, const std::function<bool()> &ready, uint64_t deadlineUs);
+
+/**
+ * @brief                   Re-evaluates the conditions of the blocked threads after a change of state (the lock must be held)
+ */
+void                notify(const Lock &lock);
+
+/**
+ * @brief                   Schedules a function to run in interrupt context at a point in virtual time (the lock must be held)
+ *
+ * @return                  ID of the scheduled function, to cancel it
+ */
+uint64_t            schedule(const Lock &lock, uint64_t atUs, std::function<void()> isr);
+
+/**
+ * @brief                   Cancels a scheduled function that has not run yet (the lock must be held)
+ */
+void                unschedule(const Lock &lock, uint64_t id);
+
+/**
+ * @brief                   Runs a function in interrupt context (core_util_is_isr_active() returns true while it runs)
+ */
+void                run_isr(const std::function<void()> &isr);
+
+/**
+ * @brief                   Checks whether the calling thread is running an interrupt handler
+ */
+bool                in_isr();
+
+/**
+ * @brief                   Get the level of a pin
+ */
+int                 read_pin(PinName pin);
+
+/**
+ * @brief                   Drives an output pin, notifying the listeners of the pin (see mbed_host::on_pin_write())
+ */
+void                write_pin(PinName pin, int level);
+
+/**
+ * @brief                   Registers the edge handlers of an InterruptIn on a pin, so that they run when the pin is driven (see mbed_host::set_pin())
+ */
+void                attach_pin(PinName pin, const void *owner, const std::function<void(bool rising)> &handler);
+
+/**
+ * @brief                   Removes the edge handlers registered by an InterruptIn
+ */
+void                detach_pin(PinName pin, const void *owner);
+
+/**
+ * @brief                   Records the period and pulse width driven on a PWM pin
+ */
+void                set_pwm(PinName pin, uint32_t periodUs, uint32_t pulsewidthUs);
+
+} // namespace detail
+} // namespace mbed_host
+
+namespace mbed {
+
+template <typename F>
+class Callback;
+
+/**
+ * @brief                   Callable object with the interface of mbed::Callback, holding any function, functor or bound member function
+ */
+template <typename R, typename... A>
+class Callback<R(A...)> {
+
+    /** Function that is called */
+    std::function<R(A...)>  function;
+
+public:
+
+    Callback() = default;
+    Callback(std::nullptr_t) {}
+
+    Callback(R (*func)(A...))
+            : function(func)
+    {
+    }
+
+    template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Callback>::value &&
+                                                             std::is_convertible<decltype(std::declval<F &>()(std::declval<A>()...)), R>::value>::type>
+    Callback(F func)
+            : function(std::move(func))
+    {
+    }
+
+    template <typename T, typename U>
+    Callback(U *obj, R (T::*method)(A...))
+            : function([obj, method](A... args) { return (obj->*method)(args...); })
+    {
+    }
+
+    template <typename T, typename U>
+    Callback(const U *obj, R (T::*method)(A...) const)
+            : function([obj, method](A... args) { return (obj->*method)(args...); })
+    {
+    }
+
+    R               operator()(A... args) const { return function(args...); }
+    R               call(A... args) const { return function(args...); }
+    explicit        operator bool() const { return (bool)function; }
+};
+
+template <typename R, typename... A>
+Callback<R(A...)>
+callback(R (*func)(A...)) {
+    return Callback<R(A...)>(func);
+}
+
+template <typename R, typename... A>
+Callback<R(A...)>
+callback(const Callback<R(A...)> &func) {
+    return func;
+}
+
+template <typename T, typename U, typename R, typename... A>
+Callback<R(A...)>
+callback(U *obj, R (T::*method)(A...)) {
+    return Callback<R(A...)>(obj, method);
+}
+
+template <typename T, typename U, typename R, typename... A>
+Callback<R(A...)>
+callback(const U *obj, R (T::*method)(A...) const) {
+    return Callback<R(A...)>(obj, method);
+}
+
+template <typename T>
+class NonCopyable {
+
+protected:
+
+    NonCopyable() = default;
+    ~NonCopyable() = default;
+
+public:
+
+    NonCopyable(const NonCopyable &) = delete;
+    NonCopyable &operator=(const NonCopyable &) = delete;
+};
+
+/**
+ * @brief                   Digital output, whose writes are passed to the listeners of the pin (see mbed_host::on_pin_write())
+ */
+class DigitalOut : NonCopyable<DigitalOut> {
+
+    PinName         pin;
+
+public:
+
+    DigitalOut(PinName pin, int value = 0);
+
+    void            write(int value);
+    int             read();
+    int             is_connected();
+
+    DigitalOut      &operator=(int value) { write(value); return *this; }
+    operator        int() { return read(); }
+};
+
+/**
+ * @brief                   Digital input, whose level is driven by mbed_host::set_pin()
+ */
+class DigitalIn : NonCopyable<DigitalIn> {
+
+    PinName         pin;
+
+public:
+
+    DigitalIn(PinName pin, PinMode mode = PullNone);
+
+    int             read();
+    void            mode(PinMode mode);
+
+    operator        int() { return read(); }
+};
+
+/**
+ * @brief                   Digital input with interrupts, whose handlers run in interrupt context when mbed_host::set_pin() changes its level
+ */
+class InterruptIn : NonCopyable<InterruptIn> {
+
+    PinName         pin;
+    /** Handler of rising edges (protected by the lock of the emulation) */
+    Callback<void()>    riseHandler;
+    /** Handler of falling edges (protected by the lock of the emulation) */
+    Callback<void()>    fallHandler;
+    /** Whether the handlers are called */
+    bool            irqEnabled {true};
+
+public:
+
+    InterruptIn(PinName pin, PinMode mode = PullNone);
+    ~InterruptIn();
+
+    int             read();
+    void            mode(PinMode mode);
+    void            rise(Callback<void()> func);
+    void            fall(Callback<void()> func);
+    void            enable_irq();
+    void            disable_irq();
+
+    operator        int() { return read(); }
+
+private:
+
+    void            on_edge(bool rising);
+};
+
+/**
+ * @brief                   PWM output, whose pulse width can be read back with mbed_host::get_pwm_pulsewidth_us()
+ */
+class PwmOut : NonCopyable<PwmOut> {
+
+    PinName         pin;
+    uint32_t        periodUs {20'000};
+    uint32_t        pulsewidthUs {0};
+
+public:
+
+    PwmOut(PinName pin);
+
+    void            period(float seconds);
+    void            period_ms(int ms);
+    void            period_us(int us);
+    void            pulsewidth(float seconds);
+    void            pulsewidth_ms(int ms);
+    void            pulsewidth_us(int us);
+    void            write(float duty);
+    float           read();
+
+    PwmOut          &operator=(float duty) { write(duty); return *this; }
+    operator        float() { return read(); }
+};
+
+/**
+ * @brief                   Stopwatch in virtual time
+ */
+class Timer : NonCopyable<Timer> {
+
+    bool            running {false};
+    uint64_t        startUs {0};
+    uint64_t        elapsedUs {0};
+
+public:
+
+    void            start();
+    void            stop();
+    void            reset();
+    std::chrono::microseconds   elapsed_time() const;
+};
+
+/**
+ * @brief                   One-shot timer that calls its handler in interrupt context once the delay has passed in virtual time
+ */
+class Timeout : NonCopyable<Timeout> {
+
+    /** ID of the scheduled handler (0 if none) */
+    uint64_t        eventId {0};
+    Callback<void()>    handler;
+
+public:
+
+    Timeout() = default;
+    ~Timeout();
+
+    template <typename D>
+    void            attach(Callback<void()> func, D delay) {
+        attach_us(std::move(func), std::chrono::duration_cast<std::chrono::microseconds>(delay).count());
+    }
+
+    void            detach();
+
+private:
+
+    void            attach_us(Callback<void()> func, uint64_t delayUs);
+    void            fire();
+};
+
+/**
+ * @brief                   Critical section (a no-op, as interrupt handlers never run concurrently with thread code in the emulation)
+ */
+class CriticalSectionLock {
+
+public:
+
+    CriticalSectionLock() {}
+    ~CriticalSectionLock() {}
+};
+
+class FileHandle {
+
+public:
+
+    virtual ~FileHandle() = default;
+    virtual ssize_t write(const void *buffer, size_t size) = 0;
+    virtual ssize_t read(void *buffer, size_t size) = 0;
+};
+
+/**
+ * @brief                   Serial port that writes to the standard output of the host and never receives anything
+ */
+class BufferedSerial : public FileHandle, NonCopyable<BufferedSerial> {
+
+public:
+
+    BufferedSerial(PinName tx, PinName rx, int baud = 9'600);
+
+    ssize_t         write(const void *buffer, size_t size) override;
+    ssize_t         read(void *buffer, size_t size) override;
+    int             set_blocking(bool blocking);
+};
+
+typedef uint64_t    bd_addr_t;
+typedef uint64_t    bd_size_t;
+
+class BlockDevice {
+
+public:
+
+    virtual ~BlockDevice() = default;
+    virtual int     init() = 0;
+    virtual int     deinit() = 0;
+    virtual int     sync() { return 0; }
+    virtual int     read(void *buffer, bd_addr_t addr, bd_size_t size) = 0;
+    virtual int     program(const void *buffer, bd_addr_t addr, bd_size_t size) = 0;
+    virtual int     erase(bd_addr_t addr, bd_size_t size) { (void)addr; (void)size; return 0; }
+    virtual bd_size_t   get_read_size() const = 0;
+    virtual bd_size_t   get_program_size() const = 0;
+    virtual bd_size_t   get_erase_size() const { return get_program_size(); }
+    virtual bd_size_t   get_erase_size(bd_addr_t addr) const { (void)addr; return get_erase_size(); }
+    virtual int     get_erase_value() const { return -1; }
+    virtual bd_size_t   size() const = 0;
+    virtual const char  *get_type() const = 0;
+};
+
+} // namespace mbed
+
+namespace rtos {
+
+enum osPriority {
+
+    osPriorityIdle,
+    osPriorityLow,
+    osPriorityBelowNormal,
+    osPriorityNormal,
+    osPriorityAboveNormal,
+    osPriorityHigh,
+    osPriorityRealtime
+};
+
+typedef int32_t     osStatus;
+
+constexpr osStatus  osOK                = 0;
+constexpr osStatus  osError             = -1;
+constexpr osStatus  osErrorResource     = -3;
+
+/** Default stack size of a thread, the same as the default of MBed OS */
+constexpr uint32_t  OS_STACK_SIZE       = 4'096;
+
+namespace Kernel {
+
+/**
+ * @brief                   Clock of the RTOS kernel, counting milliseconds of virtual time
+ */
+struct Clock {
+
+    using duration      = std::chrono::milliseconds;
+    using rep           = duration::rep;
+    using period        = duration::period;
+    using time_point    = std::chrono::time_point<Clock, duration>;
+
+    static constexpr bool   is_steady   = true;
+
+    static time_point   now();
+};
+
+uint64_t            get_ms_count();
+
+} // namespace Kernel
+
+class Semaphore : mbed::NonCopyable<Semaphore> {
+
+    int32_t         count;
+    int32_t         maxCount;
+
+public:
+
+    Semaphore(int32_t count = 0, uint16_t maxCount = 0xFFFF);
+
+    void            acquire();
+    bool            try_acquire();
+    osStatus        release();
+
+    template <typename R, typename P>
+    bool            try_acquire_for(std::chrono::duration<R, P> timeout) {
+        return try_acquire_for_us(std::chrono::duration_cast<std::chrono::microseconds>(timeout).count());
+    }
+
+private:
+
+    bool            try_acquire_for_us(uint64_t timeoutUs);
+};
+
+/**
+ * @brief                   Recursive mutex, as in MBed OS
+ */
+class Mutex : mbed::NonCopyable<Mutex> {
+
+    std::thread::id owner {};
+    uint32_t        depth {0};
+
+public:
+
+    void            lock();
+    bool            trylock();
+    void            unlock();
+};
+
+class EventFlags : mbed::NonCopyable<EventFlags> {
+
+    uint32_t        flags {0};
+
+public:
+
+    uint32_t        set(uint32_t flags);
+    uint32_t        clear(uint32_t flags = 0x7FFFFFFF);
+    uint32_t        get() const;
+    uint32_t        wait_any(uint32_t flags, uint32_t millisec = 0xFFFFFFFF, bool clear = true);
+    uint32_t        wait_all(uint32_t flags, uint32_t millisec = 0xFFFFFFFF, bool clear = true);
+
+private:
+
+    uint32_t        wait(uint32_t flags, uint32_t millisec, bool clear, bool all);
+};
+
+/**
+ * @brief                   Thread backed by a thread of the host, whose blocking calls are accounted in virtual time
+ *
+ * @remarks                 Priorities are recorded but not enforced, and the stack size is only recorded (see Thread::stack_size())
+ */
+class Thread : mbed::NonCopyable<Thread> {
+
+public:
+
+    enum State {
+
+        Inactive,
+        Ready,
+        Running,
+        WaitingDelay,
+        WaitingJoin,
+        Deleted
+    };
+
+private:
+
+    osPriority      priority;
+    uint32_t        stackSize;
+    const char      *threadName;
+
+    std::thread     handle;
+    bool            started {false};
+    bool            finished {false};
+    bool            joined {false};
+
+public:
+
+    Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = OS_STACK_SIZE, unsigned char *stack_mem = nullptr, const char *name = nullptr);
+    ~Thread();
+
+    osStatus        start(mbed::Callback<void()> task);
+    osStatus        join();
+    osStatus        terminate();
+    State           get_state() const;
+    osPriority      get_priority() const;
+    uint32_t        stack_size() const;
+    const char      *get_name() const;
+};
+
+namespace ThisThread {
+
+void                sleep_until(Kernel::Clock::time_point absTime);
+void                sleep_for_us(uint64_t us);
+void                yield();
+
+template <typename R, typename P>
+void
+sleep_for(std::chrono::duration<R, P> relTime) {
+    sleep_for_us(std::chrono::duration_cast<std::chrono::microseconds>(relTime).count());
+}
+
+} // namespace ThisThread
+
+} // namespace rtos
+
+namespace events {
+
+/** Size of an event with a small callback, the same order of magnitude as on a 32-bit target */
+constexpr unsigned  EVENTS_EVENT_SIZE   = 48;
+/** Default size of an event queue, 32 events as in MBed OS */
+constexpr unsigned  EVENTS_QUEUE_SIZE   = 32 * EVENTS_EVENT_SIZE;
+
+/**
+ * @brief                   Queue of events dispatched in virtual time, holding at most size / EVENTS_EVENT_SIZE events like a full queue on a target
+ */
+class EventQueue : mbed::NonCopyable<EventQueue> {
+
+    struct Event {
+
+        int             id;
+        uint64_t        dueUs;
+        uint64_t        periodUs;
+        bool            periodic;
+        std::function<void()>   function;
+    };
+
+    /** Pending events (protected by the lock of the emulation) */
+    std::list<Event>    events;
+    /** Maximum number of pending events */
+    size_t          capacity;
+    /** Whether the dispatch should return, kept till the next dispatch if not dispatching */
+    bool            breakRequested {false};
+
+public:
+
+    EventQueue(unsigned size = EVENTS_QUEUE_SIZE, unsigned char *buffer = nullptr);
+    ~EventQueue();
+
+    template <typename F>
+    int             call(F func) {
+        return post(0, 0, false, std::function<void()>(std::move(func)));
+    }
+
+    template <typename U, typename T, typename R, typename... A, typename... B>
+    int             call(U *obj, R (T::*method)(A...), B... args) {
+        return call([obj, method, args...]() { (obj->*method)(args...); });
+    }
+
+    template <typename D, typename F>
+    int             call_in(D delay, F func) {
+        return post(to_us(delay), 0, false, std::function<void()>(std::move(func)));
+    }
+
+    template <typename D, typename U, typename T, typename R, typename... A, typename... B>
+    int             call_in(D delay, U *obj, R (T::*method)(A...), B... args) {
+        return call_in(delay, [obj, method, args...]() { (obj->*method)(args...); });
+    }
+
+    template <typename D, typename F>
+    int             call_every(D period, F func) {
+        return post(to_us(period), to_us(period), true, std::function<void()>(std::move(func)));
+    }
+
+    template <typename D, typename U, typename T, typename R, typename... A, typename... B>
+    int             call_every(D period, U *obj, R (T::*method)(A...), B... args) {
+        return call_every(period, [obj, method, args...]() { (obj->*method)(args...); });
+    }
+
+    bool            cancel(int id);
+    void            dispatch_forever();
+    void            dispatch_once();
+    void            break_dispatch();
+
+    template <typename D>
+    void            dispatch_for(D duration) {
+        dispatch_us(to_us(duration));
+    }
+
+private:
+
+    template <typename D>
+    static uint64_t to_us(D duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+
+    int             post(uint64_t delayUs, uint64_t periodUs, bool periodic, std::function<void()> function);
+    void            dispatch_us(uint64_t durationUs);
+};
+
+} // namespace events
+
+/**
+ * @brief                   Get the shared event queue, which is dispatched by a thread of its own and holds 16 events
+ */
+events::EventQueue  *mbed_event_queue();
+
+bool                core_util_is_isr_active();
+uint32_t            us_ticker_read();
+void                wait_us(int us);
+
+inline uint32_t core_util_atomic_incr_u32(volatile uint32_t *ptr, uint32_t delta) { return __atomic_add_fetch(ptr, delta, __ATOMIC_SEQ_CST); }
+inline uint32_t core_util_atomic_decr_u32(volatile uint32_t *ptr, uint32_t delta) { return __atomic_sub_fetch(ptr, delta, __ATOMIC_SEQ_CST); }
+inline uint32_t core_util_atomic_load_u32(const volatile uint32_t *ptr) { return __atomic_load_n(ptr, __ATOMIC_SEQ_CST); }
+inline void core_util_atomic_store_u32(volatile uint32_t *ptr, uint32_t value) { __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST); }
+inline bool core_util_atomic_load_bool(const volatile bool *ptr) { return __atomic_load_n(ptr, __ATOMIC_SEQ_CST); }
+inline void core_util_atomic_store_bool(volatile bool *ptr, bool value) { __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST); }
+inline bool core_util_atomic_exchange_bool(volatile bool *ptr, bool value) { return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST); }
+
+using namespace mbed;
+using namespace rtos;
+using namespace events;
+
+#endif //__MBED_HOST_MBED_H__
@@ -0,0 +1,312 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host check of the quantiles estimated by P2Quantile against the exact quantiles of the same distances, over
+ *                          several distributions of distances and window sizes
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "P2Quantile.h"
+
+/** Quantiles checked, the defaults of QuantileMonitor */
+constexpr float     PROBABILITIES[]     = {0.05f, 0.5f, 0.95f};
+/** Number of distances per window: a few seconds, a minute and an hour of a sensor measured at 20Hz */
+constexpr uint32_t  WINDOWS[]           = {100, 1'200, 72'000};
+/** Number of distances generated for each distribution and window size (split into windows) */
+constexpr uint32_t  TRIAL_DISTANCES     = 1'440'000;
+/** Largest number of windows for each distribution and window size */
+constexpr uint32_t  MAX_TRIALS          = 200;
+/** Smallest window whose estimates are checked against RANK_TOLERANCE (smaller windows are only reported) */
+constexpr uint32_t  CHECKED_WINDOW      = 1'200;
+/** Largest mean difference between the rank of an estimate and the quantile, as a fraction of the window */
+constexpr double    RANK_TOLERANCE      = 0.01;
+/** Largest mean difference between an estimate and the exact quantile in centimetres, a few times the resolution of the sensor */
+constexpr double    DISTANCE_TOLERANCE  = 1.0;
+/** Largest sensor id in a trace */
+constexpr size_t    MAX_SENSORS         = 256;
+
+/**
+ * @brief                   Distribution of the distances of a window
+ */
+struct Distribution {
+
+    /** Name printed in the report */
+    const char      *name;
+    /** Generates the distance at an index of a window of a given size, in centimetres */
+    std::function<float(std::mt19937 &rng, uint32_t index, uint32_t size)>  generate;
+    /** Whether the distances are drawn from the same distribution throughout a window, so that the estimates are checked */
+    bool            stationary;
+};
+
+/**
+ * @brief                   Errors of the estimates of a quantile over the windows of a distribution
+ */
+struct QuantileError {
+
+    /** Mean absolute difference between the estimate and the exact quantile in centimetres */
+    double          meanAbsolute;
+    /** Mean absolute difference between the rank of the estimate and the quantile, as a fraction of the window */
+    double          meanRank;
+    /** Largest difference between the rank of the estimate and the quantile, as a fraction of the window */
+    double          maxRank;
+};
+
+/**
+ * @brief                   Get the exact quantile of sorted distances, interpolated between the two closest ranks as P2Quantile does
+ */
+static double
+exact_quantile(const std::vector<float> &sorted, float probability) {
+
+    double  h   = (sorted.size() - 1) * (double)probability;
+    size_t  lo  = (size_t)h;
+
+    if (lo + 1 >= sorted.size()) {
+        return sorted.back();
+    }
+    return sorted[lo] + (h - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+/**
+ * @brief                   Get the difference between the rank of a value among sorted distances and a quantile, as a fraction of the
+ *                          distances
+ *
+ * @note                    A value shared by several distances spans all of their ranks, so the difference is 0 if any of them is the quantile
+ */
+static double
+rank_error(const std::vector<float> &sorted, double value, float probability) {
+
+    double  below   = (double)(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin()) / sorted.size();
+    double  within  = (double)(std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin()) / sorted.size();
+
+    return std::max({0.0, below - probability, probability - within});
+}
+
+/**
+ * @brief                   Estimates each quantile of each window, and accumulates the errors against the exact quantiles
+ *
+ * @param windows           Distances of each window, in the order they are measured
+ * @param errors            Errors of each quantile of PROBABILITIES
+ * @param addSeconds        Location to accumulate the time spent adding distances to the estimates
+ * @param added             Location to accumulate the number of distances added
+ */
+static void
+check_windows(const std::vector<std::vector<float>> &windows, QuantileError (&errors)[std::size(PROBABILITIES)], double *addSeconds, uint64_t *added) {
+
+    for (QuantileError &error : errors) {
+        error = QuantileError {};
+    }
+
+    for (const std::vector<float> &window : windows) {
+
+        std::vector<float> sorted(window);
+        std::sort(sorted.begin(), sorted.end());
+
+        for (size_t q = 0; q < std::size(PROBABILITIES); ++q) {
+
+            P2Quantile estimate(PROBABILITIES[q]);
+
+            auto start = std::chrono::steady_clock::now();
+            for (float distance : window) {
+                estimate.add(distance);
+            }
+            *addSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            *added      += window.size();
+
+            double rankError = rank_error(sorted, estimate.get(), PROBABILITIES[q]);
+
+            errors[q].meanAbsolute  += std::fabs(estimate.get() - exact_quantile(sorted, PROBABILITIES[q]));
+            errors[q].meanRank      += rankError;
+            errors[q].maxRank       = std::max(errors[q].maxRank, rankError);
+        }
+    }
+
+    for (QuantileError &error : errors) {
+
+        error.meanAbsolute  /= windows.size();
+        error.meanRank      /= windows.size();
+    }
+}
+
+/**
+ * @brief                   Prints the errors of the quantiles of a distribution and window size, and checks each quantile against
+ *                          RANK_TOLERANCE and DISTANCE_TOLERANCE
+ *
+ * @param checked           Whether the errors are checked, or only reported
+ *
+ * @return                  true if the error of every quantile is within either tolerance (or the errors are not checked), false otherwise
+ */
+static bool
+report(const char *name, uint32_t window, size_t trials, bool checked, const QuantileError (&errors)[std::size(PROBABILITIES)]) {
+
+    // a quantile within a dense cluster of distances may be far in rank but close in distance, and one in a sparse tail the other way round
+
+    bool ok = true;
+
+    checked = checked && window >= CHECKED_WINDOW;
+
+    for (size_t q = 0; q < std::size(PROBABILITIES); ++q) {
+
+        bool within = errors[q].meanRank <= RANK_TOLERANCE || errors[q].meanAbsolute <= DISTANCE_TOLERANCE;
+
+        printf("%-16s %7u x %-4zu  p%-4.0f  %9.3f   %8.4f   %8.4f  %s\n", name, window, trials, PROBABILITIES[q] * 100, errors[q].meanAbsolute,
+               errors[q].meanRank, errors[q].maxRank, !checked ? "" : within ? "ok" : "TOO FAR");
+
+        ok = ok && (!checked || within);
+    }
+
+    return ok;
+}
+
+/**
+ * @brief                   Reads the valid distances of each sensor from a trace in the CSV format produced by sample-decoder
+ *                          (time_ms,sensor,sequence,distance_mm)
+ *
+ * @return                  Number of distances read
+ */
+static size_t
+read_trace(FILE *in, std::vector<std::vector<float>> &series) {
+
+    char        line[128];
+    unsigned    sensor;
+    unsigned    sequence;
+    unsigned    distance;
+    size_t      count;
+
+    count = 0;
+
+    while (fgets(line, sizeof(line), in) != nullptr) {
+
+        unsigned long long timeMs;
+
+        if (sscanf(line, "%llu,%u,%u,%u", &timeMs, &sensor, &sequence, &distance) != 4 || sensor >= MAX_SENSORS) {
+            continue;
+        }
+
+        series[sensor].push_back(distance / 10.0f);
+        ++count;
+    }
+
+    return count;
+}
+
+int
+main(int argc, char **argv) {
+
+    // split the distances of every distribution (or of every sensor of a trace) into windows, as QuantileMonitor does with its periods
+    // estimate each quantile of each window with P2Quantile, and compare it with the exact quantile of the sorted window
+    // the error in rank is the figure that matters for a percentile, as the error in distance depends on how spread the distances are
+    // a moving target is only reported, as P2Quantile assumes that the distances of a period are drawn from the same distribution, and its
+    // markers lag behind a distribution that drifts
+
+    std::vector<Distribution> distributions = {
+        {"steady target",   [](std::mt19937 &rng, uint32_t, uint32_t) { return std::normal_distribution<float>(150, 3)(rng); }, true},
+        {"uniform",         [](std::mt19937 &rng, uint32_t, uint32_t) { return std::uniform_real_distribution<float>(20, 400)(rng); }, true},
+        {"two targets",     [](std::mt19937 &rng, uint32_t, uint32_t) {
+            return (rng() % 10 < 3) ? std::normal_distribution<float>(80, 5)(rng) : std::normal_distribution<float>(250, 2)(rng);
+        }, true},
+        {"spikes",          [](std::mt19937 &rng, uint32_t, uint32_t) {
+            return (rng() % 50 == 0) ? std::uniform_real_distribution<float>(100, 400)(rng) : std::normal_distribution<float>(100, 2)(rng);
+        }, true},
+        {"moving target",   [](std::mt19937 &rng, uint32_t index, uint32_t size) {
+            return 100 + 200.0f * index / size + std::normal_distribution<float>(0, 3)(rng);
+        }, false},
+        {"millimetres",     [](std::mt19937 &rng, uint32_t, uint32_t) {
+            return std::round(std::normal_distribution<float>(150, 0.3f)(rng) * 10) / 10;
+        }, true},
+    };
+
+    QuantileError   errors[std::size(PROBABILITIES)];
+    double          addSeconds;
+    uint64_t        added;
+    bool            ok;
+
+    addSeconds  = 0;
+    added       = 0;
+    ok          = true;
+
+    if (argc > 1) {
+
+        std::vector<std::vector<float>> series(MAX_SENSORS);
+        FILE                            *in = fopen(argv[1], "r");
+
+        if (in == nullptr) {
+
+            fprintf(stderr, "usage: %s [TRACE.csv]\n", argv[0]);
+            return 1;
+        }
+
+        size_t count = read_trace(in, series);
+        fclose(in);
+
+        if (count == 0) {
+
+            fprintf(stderr, "no distances\n");
+            return 1;
+        }
+
+        printf("distribution      window x runs  quantile  mean cm   mean rank   max rank\n");
+
+        for (size_t sensor = 0; sensor < MAX_SENSORS; ++sensor) {
+
+            char name[32];
+            snprintf(name, sizeof(name), "sensor %zu", sensor);
+
+            for (uint32_t window : WINDOWS) {
+
+                std::vector<std::vector<float>> windows;
+
+                for (size_t start = 0; start + window <= series[sensor].size(); start += window) {
+                    windows.emplace_back(series[sensor].begin() + start, series[sensor].begin() + start + window);
+                }
+
+                if (windows.empty()) {
+                    continue;
+                }
+
+                check_windows(windows, errors, &addSeconds, &added);
+                ok = report(name, window, windows.size(), true, errors) && ok;
+            }
+        }
+    }
+    else {
+
+        std::mt19937 rng(1);
+
+        printf("distribution      window x runs  quantile  mean cm   mean rank   max rank\n");
+
+        for (const Distribution &distribution : distributions) {
+
+            for (uint32_t window : WINDOWS) {
+
+                std::vector<std::vector<float>> windows(std::min(MAX_TRIALS, std::max(1u, TRIAL_DISTANCES / window)));
+
+                for (std::vector<float> &distances : windows) {
+
+                    distances.resize(window);
+                    for (uint32_t i = 0; i < window; ++i) {
+                        distances[i] = distribution.generate(rng, i, window);
+                    }
+                }
+
+                check_windows(windows, errors, &addSeconds, &added);
+                ok = report(distribution.name, window, windows.size(), distribution.stationary, errors) && ok;
+            }
+        }
+    }
+
+    printf("add              %.1f ns/distance\n", addSeconds * 1e9 / added);
+    printf("%s\n", ok ? "estimates within tolerance" : "ESTIMATES OUT OF TOLERANCE");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+#include "FileBlockDevice.h"
+
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Error returned by the operations, the same value as BD_ERROR_DEVICE_ERROR of MBed OS */
+constexpr int       FILE_BD_ERROR   = -4001;
+
+// Constructors
+
+FileBlockDevice::FileBlockDevice(const char *path, uint64_t size, uint64_t eraseSize, uint64_t programSize)
+        : deviceSize(size)
+        , eraseSize(eraseSize)
+        , programSize(programSize)
+        , eraseCounts(size / eraseSize)
+{
+
+    // a file of a different size is erased, as it can not hold a log of this geometry
+
+    struct stat info;
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return;
+    }
+
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size != size) {
+
+        std::vector<uint8_t> erased(eraseSize, 0xFF);
+
+        if (ftruncate(fd, 0) != 0) {
+
+            close(fd);
+            fd = -1;
+            return;
+        }
+
+        for (uint64_t addr = 0; addr < size; addr += eraseSize) {
+
+            if (pwrite(fd, erased.data(), eraseSize, addr) != (ssize_t)eraseSize) {
+
+                close(fd);
+                fd = -1;
+                return;
+            }
+        }
+    }
+}
+
+FileBlockDevice::~FileBlockDevice() {
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Public Methods
+
+bool
+FileBlockDevice::is_open() const {
+
+    return fd >= 0;
+}
+
+void
+FileBlockDevice::set_timing(uint32_t programUs, uint32_t eraseUs) {
+
+    this->programUs = programUs;
+    this->eraseUs   = eraseUs;
+}
+
+void
+FileBlockDevice::set_crash_after(uint64_t programs) {
+
+    crashAfter      = programs;
+    programCount    = 0;
+    crashed         = false;
+}
+
+void
+FileBlockDevice::set_bad_block(int64_t block) {
+
+    badBlock = block;
+}
+
+const std::vector<uint32_t> &
+FileBlockDevice::get_erase_counts() const {
+
+    return eraseCounts;
+}
+
+int
+FileBlockDevice::read(void *buffer, uint64_t addr, uint64_t size) {
+
+    if (crashed || addr + size > deviceSize) {
+        return FILE_BD_ERROR;
+    }
+
+    return (pread(fd, buffer, size, addr) == (ssize_t)size) ? 0 : FILE_BD_ERROR;
+}
+
+int
+FileBlockDevice::program(const void *buffer, uint64_t addr, uint64_t size) {
+
+    // AND the bytes with the current contents, as programming a flash can only clear bits
+    // if a reset is due, only the first half of the bytes are written before failing
+
+    std::vector<uint8_t>    current(size);
+    const uint8_t           *bytes;
+
+    if (crashed || addr % programSize != 0 || size % programSize != 0 || addr + size > deviceSize) {
+        return FILE_BD_ERROR;
+    }
+
+    if (pread(fd, current.data(), size, addr) != (ssize_t)size) {
+        return FILE_BD_ERROR;
+    }
+
+    bytes = (const uint8_t *)buffer;
+    for (uint64_t i = 0; i < size; ++i) {
+        current[i] &= bytes[i];
+    }
+
+    if (crashAfter != 0 && ++programCount > crashAfter) {
+
+        crashed = true;
+        size    /= 2;
+    }
+
+    if (programUs != 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(programUs));
+    }
+
+    if (pwrite(fd, current.data(), size, addr) != (ssize_t)size || crashed) {
+        return FILE_BD_ERROR;
+    }
+    return 0;
+}
+
+int
+FileBlockDevice::erase(uint64_t addr, uint64_t size) {
+
+    std::vector<uint8_t> erased(size, 0xFF);
+
+    if (crashed || addr % eraseSize != 0 || size % eraseSize != 0 || addr + size > deviceSize) {
+        return FILE_BD_ERROR;
+    }
+
+    if (badBlock >= 0 && addr / eraseSize <= (uint64_t)badBlock && (uint64_t)badBlock < (addr + size) / eraseSize) {
+        return FILE_BD_ERROR;
+    }
+
+    for (uint64_t block = addr / eraseSize; block < (addr + size) / eraseSize; ++block) {
+        ++eraseCounts[block];
+    }
+
+    if (eraseUs != 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(eraseUs));
+    }
+
+    return (pwrite(fd, erased.data(), size, addr) == (ssize_t)size) ? 0 : FILE_BD_ERROR;
+}
+
+uint64_t
+FileBlockDevice::get_read_size() const {
+
+    return 1;
+}
+
+uint64_t
+FileBlockDevice::get_program_size() const {
+
+    return programSize;
+}
+
+uint64_t
+FileBlockDevice::get_erase_size() const {
+
+    return eraseSize;
+}
+
+int
+FileBlockDevice::get_erase_value() const {
+
+    return 0xFF;
+}
+
+uint64_t
+FileBlockDevice::size() const {
+
+    return deviceSize;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file                    FileBlockDevice.h
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host stand-in for an mbed::BlockDevice (such as a SPI NOR flash) that is backed by a file
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#ifndef __FILEBLOCKDEVICE_H__
+#define __FILEBLOCKDEVICE_H__
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief                   Class that emulates a NOR flash in a file, with the methods of mbed::BlockDevice used by RingLog
+ *
+ * @remarks                 Programming can only clear bits (the bytes are ANDed with the contents), so programming a page that was not erased
+ *                          corrupts it as it would on a real flash, and erasing sets every byte to 0xFF
+ * @remarks                 Optionally sleeps for the typical duration of each program and erase, and can simulate a reset in the middle of a
+ *                          program (only part of the page is written and every further operation fails)
+ * @remarks                 Can also simulate an erase block that fails to erase
+ * @remarks                 Counts the erases of every erase block, to check that wear is spread evenly
+ */
+class FileBlockDevice {
+
+    /** File descriptor of the backing file */
+    int             fd {-1};
+    /** Size of the device in bytes */
+    uint64_t        deviceSize;
+    /** Size of an erase block in bytes */
+    uint64_t        eraseSize;
+    /** Size of a program unit in bytes */
+    uint64_t        programSize;
+
+    /** Duration of a program in microseconds */
+    uint32_t        programUs {0};
+    /** Duration of an erase in microseconds */
+    uint32_t        eraseUs {0};
+
+    /** Number of programs after which the next program is torn (0 to never tear) */
+    uint64_t        crashAfter {0};
+    /** Number of programs so far */
+    uint64_t        programCount {0};
+    /** Whether a reset was simulated */
+    bool            crashed {false};
+    /** Index of the erase block that fails to erase (-1 if none) */
+    int64_t         badBlock {-1};
+
+    /** Number of erases of each erase block */
+    std::vector<uint32_t>   eraseCounts;
+
+public:
+
+    /**
+     * @brief               Construct a new FileBlockDevice object
+     *
+     * @param path          Path of the backing file, created (erased) if it does not exist or has a different size
+     * @param size          Size of the device in bytes
+     * @param eraseSize     Size of an erase block in bytes
+     * @param programSize   Size of a program unit in bytes
+     */
+    FileBlockDevice(const char *path, uint64_t size, uint64_t eraseSize = 4'096, uint64_t programSize = 256);
+
+    ~FileBlockDevice();
+
+    FileBlockDevice(const FileBlockDevice &) = delete;
+    FileBlockDevice &operator=(const FileBlockDevice &) = delete;
+
+    /**
+     * @brief               Checks whether the backing file could be opened
+     *
+     * @return              true if the device can be used, false otherwise
+     */
+    bool            is_open() const;
+
+    /**
+     * @brief               Sets the emulated duration of programs and erases
+     *
+     * @param programUs     Duration of a program in microseconds
+     * @param eraseUs       Duration of an erase in microseconds
+     */
+    void            set_timing(uint32_t programUs, uint32_t eraseUs);
+
+    /**
+     * @brief               Simulates a reset in the middle of a future program
+     *
+     * @param programs      Number of programs that complete before the torn one (0 to cancel)
+     */
+    void            set_crash_after(uint64_t programs);
+
+    /**
+     * @brief               Makes every erase of an erase block fail, as on a worn-out flash
+     *
+     * @param block         Index of the erase block (-1 for none)
+     */
+    void            set_bad_block(int64_t block);
+
+    /**
+     * @brief               Get the number of erases of each erase block
+     *
+     * @return              Erase counts, indexed by erase block
+     */
+    const std::vector<uint32_t> &get_erase_counts() const;
+
+    int             read(void *buffer, uint64_t addr, uint64_t size);
+    int             program(const void *buffer, uint64_t addr, uint64_t size);
+    int             erase(uint64_t addr, uint64_t size);
+    uint64_t        get_read_size() const;
+    uint64_t        get_program_size() const;
+    uint64_t        get_erase_size() const;
+    int             get_erase_value() const;
+    uint64_t        size() const;
+};
+
+#endif //__FILEBLOCKDEVICE_H__
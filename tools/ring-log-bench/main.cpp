@@ -0,0 +1,362 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host benchmark and crash test of RingLog on a file-backed block device
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#include "FileBlockDevice.h"
+#include "RingLog.h"
+
+/** Size of a page of the log */
+constexpr size_t    PAGE_SIZE           = 256;
+/** Size of the emulated device */
+constexpr uint64_t  DEVICE_SIZE         = 256 * 1'024;
+/** Size of an erase block of the emulated device */
+constexpr uint64_t  ERASE_SIZE          = 4'096;
+/** Typical duration of a page program of a SPI NOR flash in microseconds */
+constexpr uint32_t  PROGRAM_US          = 700;
+/** Typical duration of a 4KB erase of a SPI NOR flash in microseconds */
+constexpr uint32_t  ERASE_US            = 45'000;
+/** Size of a record, the same as a measurement stored by RingLogMonitor */
+constexpr uint8_t   RECORD_SIZE         = 7;
+/** Number of records appended to measure the cost of an append */
+constexpr uint32_t  APPEND_RECORDS      = 2'000'000;
+/** Duration of the measurement of the sustained ingest rate */
+constexpr auto      INGEST_DURATION     = std::chrono::seconds(3);
+/** Number of simulated resets */
+constexpr uint32_t  CRASH_TRIALS        = 200;
+
+using Log = RingLog<FileBlockDevice, PAGE_SIZE>;
+
+/**
+ * @brief                   Builds a record holding a counter
+ */
+static void
+make_record(uint32_t counter, uint8_t *record) {
+
+    memset(record, 0xA5, RECORD_SIZE);
+    memcpy(record, &counter, sizeof(counter));
+}
+
+/**
+ * @brief                   Reads the log and checks that the counters of the records are strictly increasing
+ *
+ * @param log               Log to read
+ * @param count             Location to store the number of records
+ * @param last              Location to store the counter of the newest record
+ *
+ * @return                  true if the log could be read and is in order, false otherwise
+ */
+static bool
+check_log(const Log &log, uint32_t *count, uint32_t *last) {
+
+    bool ordered = true;
+
+    *count  = 0;
+    *last   = 0;
+
+    int err = log.read([&](const uint8_t *record, uint8_t size) {
+
+        uint32_t counter;
+        memcpy(&counter, record, sizeof(counter));
+
+        ordered = ordered && size == RECORD_SIZE && (*count == 0 || counter > *last);
+        *last   = counter;
+        ++*count;
+    });
+
+    return err == 0 && ordered;
+}
+
+/**
+ * @brief                   Appends records from one thread while another writes the sealed pages, as RingLogMonitor does on the device
+ *
+ * @param log               Log to append to (mounted)
+ * @param duration          Time for which records are appended
+ *
+ * @return                  Time spent appending in seconds
+ */
+static double
+run_ingest(Log &log, std::chrono::milliseconds duration) {
+
+    std::atomic<bool>   done {false};
+    uint8_t             record[RECORD_SIZE];
+
+    std::thread writer([&]() {
+
+        while (!done.load()) {
+
+            log.write_pending();
+            std::this_thread::yield();
+        }
+    });
+
+    auto start  = std::chrono::steady_clock::now();
+    auto end    = start + duration;
+
+    for (uint32_t counter = 1; std::chrono::steady_clock::now() < end; ++counter) {
+
+        make_record(counter, record);
+        log.append(record, RECORD_SIZE);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    while (log.has_pending()) {
+        std::this_thread::yield();
+    }
+    log.seal();
+
+    done.store(true);
+    writer.join();
+    log.write_pending();
+
+    return seconds;
+}
+
+/**
+ * @brief                   Measures the cost of an append and the write amplification on a device without delays, and the wear of the blocks
+ *                          after many laps of the log
+ */
+static bool
+bench_append(const char *path) {
+
+    FileBlockDevice device(path, DEVICE_SIZE, ERASE_SIZE, PAGE_SIZE);
+    Log             log(device);
+    uint32_t        count;
+    uint32_t        last;
+
+    if (!device.is_open() || log.mount() != 0) {
+        return false;
+    }
+
+    // write each sealed page right away, and time the appends separately from the writes
+
+    uint8_t         record[RECORD_SIZE];
+    double          writeSeconds;
+
+    writeSeconds = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t counter = 1; counter <= APPEND_RECORDS; ++counter) {
+
+        make_record(counter, record);
+        if (log.append(record, RECORD_SIZE) == RingLogAppend::SEALED) {
+
+            auto writeStart = std::chrono::steady_clock::now();
+            log.write_pending();
+            writeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - writeSeconds;
+
+    log.seal();
+    log.write_pending();
+
+    uint64_t appended = (uint64_t)APPEND_RECORDS * RECORD_SIZE;
+
+    const std::vector<uint32_t> &erases = device.get_erase_counts();
+    auto wear = std::minmax_element(erases.begin(), erases.end());
+
+    bool ok = check_log(log, &count, &last);
+
+    printf("append           %.1f ns/record (%u records, %u dropped)\n", seconds * 1e9 / APPEND_RECORDS, APPEND_RECORDS, log.get_dropped_count());
+    printf("amplification    %.2f bytes programmed per byte of record (%u records per %zu byte page)\n",
+           (double)log.get_programmed_bytes() / appended, (unsigned)((PAGE_SIZE - RING_LOG_HEADER_SIZE) / (RECORD_SIZE + 1)), PAGE_SIZE);
+    printf("wear             %u to %u erases per block over %zu blocks\n", *wear.first, *wear.second, erases.size());
+    printf("read back        %u records, newest %u, %s\n", count, last, ok ? "in order" : "OUT OF ORDER");
+
+    return ok;
+}
+
+/**
+ * @brief                   Measures the sustained ingest rate with the typical program and erase times of a SPI NOR flash
+ */
+static bool
+bench_ingest(const char *path) {
+
+    FileBlockDevice device(path, DEVICE_SIZE, ERASE_SIZE, PAGE_SIZE);
+    Log             log(device);
+
+    if (!device.is_open() || log.mount() != 0) {
+        return false;
+    }
+
+    device.set_timing(PROGRAM_US, ERASE_US);
+
+    double seconds = run_ingest(log, std::chrono::duration_cast<std::chrono::milliseconds>(INGEST_DURATION));
+    double records = (double)log.get_appended_bytes() / RECORD_SIZE;
+
+    printf("ingest           %.0f records/s persisted with %u us programs and %u us erases (excess records dropped: %u)\n", records / seconds,
+           PROGRAM_US, ERASE_US, log.get_dropped_count());
+
+    return true;
+}
+
+/**
+ * @brief                   Simulates resets in the middle of programs, and checks that the log is recovered and continues after each one
+ */
+static bool
+test_crashes(const char *path) {
+
+    // after each reset, the log must hold records in order up to at least the newest one of the last completed page
+    // records appended after remounting must follow those, in order
+
+    std::mt19937    rng(7);
+    uint32_t        failures;
+
+    failures = 0;
+
+    for (uint32_t trial = 0; trial < CRASH_TRIALS; ++trial) {
+
+        FileBlockDevice device(path, DEVICE_SIZE, ERASE_SIZE, PAGE_SIZE);
+        uint8_t         record[RECORD_SIZE];
+        uint32_t        counter;
+        uint32_t        durable;
+        uint32_t        count;
+        uint32_t        last;
+
+        if (!device.is_open()) {
+            return false;
+        }
+
+        Log log(device);
+        log.mount();
+
+        check_log(log, &count, &durable);
+        counter = durable;
+
+        device.set_crash_after(1 + rng() % 200);
+
+        while (true) {
+
+            make_record(++counter, record);
+            if (log.append(record, RECORD_SIZE) == RingLogAppend::SEALED) {
+
+                if (log.write_pending() != 0) {
+                    break;
+                }
+                durable = counter - 1;
+            }
+        }
+
+        FileBlockDevice restarted(path, DEVICE_SIZE, ERASE_SIZE, PAGE_SIZE);
+        Log             recovered(restarted);
+
+        bool ok = recovered.mount() == 0 && check_log(recovered, &count, &last) && last >= durable;
+
+        for (uint32_t i = 0; ok && i < 100; ++i) {
+
+            make_record(++counter, record);
+            if (recovered.append(record, RECORD_SIZE) == RingLogAppend::SEALED) {
+                ok = recovered.write_pending() == 0;
+            }
+        }
+
+        ok = ok && recovered.seal() && recovered.write_pending() == 0 && check_log(recovered, &count, &last) && last == counter;
+        failures += !ok;
+    }
+
+    printf("crash recovery   %u of %u simulated resets recovered\n", CRASH_TRIALS - failures, CRASH_TRIALS);
+    return failures == 0;
+}
+
+/**
+ * @brief                   Runs the log over a device with an erase block that fails to erase, and checks that the block is skipped without
+ *                          losing the order of the records or counting the failed operations
+ */
+static bool
+test_bad_block(const char *path) {
+
+    // every lap of the log drops the page that hits the bad block, and no page is ever programmed into it
+    // the erases and bytes counted by the log must match the device, and the log must still read back in order
+
+    constexpr int64_t   BAD_BLOCK   = 5;
+    constexpr uint32_t  RECORDS     = 200'000;
+
+    FileBlockDevice device(path, DEVICE_SIZE, ERASE_SIZE, PAGE_SIZE);
+    Log             log(device);
+    uint8_t         record[RECORD_SIZE];
+    uint8_t         page[PAGE_SIZE];
+    uint32_t        errors;
+    uint32_t        count;
+    uint32_t        last;
+    uint64_t        erases;
+    bool            blank;
+
+    if (!device.is_open() || log.mount() != 0) {
+        return false;
+    }
+
+    device.set_bad_block(BAD_BLOCK);
+    errors = 0;
+
+    for (uint32_t counter = 1; counter <= RECORDS; ++counter) {
+
+        make_record(counter, record);
+        if (log.append(record, RECORD_SIZE) == RingLogAppend::SEALED) {
+            errors += log.write_pending() != 0;
+        }
+    }
+
+    log.seal();
+    errors += log.write_pending() != 0;
+
+    erases = 0;
+    for (uint32_t blockErases : device.get_erase_counts()) {
+        erases += blockErases;
+    }
+
+    blank = true;
+    for (uint64_t addr = BAD_BLOCK * ERASE_SIZE; addr < (BAD_BLOCK + 1) * ERASE_SIZE; addr += PAGE_SIZE) {
+
+        device.read(page, addr, PAGE_SIZE);
+        blank = blank && std::all_of(page, page + PAGE_SIZE, [](uint8_t byte) { return byte == 0xFF; });
+    }
+
+    bool ok = check_log(log, &count, &last) && last == RECORDS && blank && erases == log.get_erase_count() &&
+              log.get_programmed_bytes() % PAGE_SIZE == 0 && errors > 0;
+
+    printf("bad block        %u failed erases skipped, %u records read back, newest %u, %s\n", errors, count, last, ok ? "consistent" : "INCONSISTENT");
+    return ok;
+}
+
+int
+main(int argc, char **argv) {
+
+    // the backing file is recreated by each stage, so that the stages start from an erased device
+
+    const char  *path;
+    bool        ok;
+
+    path = (argc > 1) ? argv[1] : "ring-log-bench.bin";
+
+    remove(path);
+    ok = bench_append(path);
+
+    remove(path);
+    ok = bench_ingest(path) && ok;
+
+    remove(path);
+    ok = test_crashes(path) && ok;
+
+    remove(path);
+    ok = test_bad_block(path) && ok;
+
+    remove(path);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host tool to decode the binary frames streamed by SampleStreamer into CSV, and to benchmark the frame format
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "SampleFrame.h"
+
+/** Number of records encoded and decoded by the benchmark */
+constexpr uint32_t  BENCH_RECORDS   = 10'000'000;
+
+/**
+ * @brief                   Decodes a stream of frames and prints the records as CSV
+ *
+ * @remarks                 Reconstructs absolute timestamps from the time deltas, and reports gaps in the sequence numbers as lost frames
+ *                          (lost on the link, or dropped by the sender because its ring was full)
+ *
+ * @param in                Stream to read the frames from
+ *
+ * @return                  Exit code of the tool
+ */
+static int
+decode(FILE *in) {
+
+    SampleFrameDecoder  decoder;
+    SampleRecord        record;
+    uint64_t            timeMs;
+    uint32_t            count;
+    uint32_t            lost;
+    uint16_t            expected;
+    int                 c;
+
+    timeMs      = 0;
+    count       = 0;
+    lost        = 0;
+    expected    = 0;
+
+    printf("time_ms,sensor,sequence,distance_mm\n");
+
+    while ((c = fgetc(in)) != EOF) {
+
+        if (!decoder.push((uint8_t)c, &record)) {
+            continue;
+        }
+
+        if (count > 0) {
+            lost += (uint16_t)(record.sequence - expected);
+        }
+
+        timeMs      += record.deltaMs;
+        expected    = record.sequence + 1;
+        ++count;
+
+        if (record.distanceMm == SAMPLE_DISTANCE_INVALID) {
+            printf("%llu,%u,%u,\n", (unsigned long long)timeMs, record.sensorId, record.sequence);
+        }
+        else {
+            printf("%llu,%u,%u,%u\n", (unsigned long long)timeMs, record.sensorId, record.sequence, record.distanceMm);
+        }
+    }
+
+    fprintf(stderr, "%u records, %u lost, %u corrupted frames\n", count, lost, decoder.get_error_count());
+    return 0;
+}
+
+/**
+ * @brief                   Measures the throughput of encoding and decoding frames
+ *
+ * @return                  Exit code of the tool
+ */
+static int
+bench() {
+
+    // encode records resembling a few sensors measured at 20Hz into one buffer, then feed the buffer to a decoder byte by byte
+
+    std::vector<uint8_t>    stream(BENCH_RECORDS * SAMPLE_FRAME_MAX_SIZE);
+    SampleFrameDecoder      decoder;
+    SampleRecord            record;
+    size_t                  length;
+    uint32_t                decoded;
+    uint32_t                checksum;
+
+    auto encodeStart = std::chrono::steady_clock::now();
+
+    length = 0;
+    for (uint32_t i = 0; i < BENCH_RECORDS; ++i) {
+
+        record.sensorId     = i % 8;
+        record.sequence     = i;
+        record.deltaMs      = (i % 8 == 0) ? 50 : 0;
+        record.distanceMm   = (i * 37) % 4000;
+
+        length += sample_frame_encode(record, stream.data() + length);
+    }
+
+    auto decodeStart = std::chrono::steady_clock::now();
+
+    decoded     = 0;
+    checksum    = 0;
+    for (size_t i = 0; i < length; ++i) {
+
+        if (decoder.push(stream[i], &record)) {
+
+            ++decoded;
+            checksum += record.distanceMm;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    double encodeSeconds = std::chrono::duration<double>(decodeStart - encodeStart).count();
+    double decodeSeconds = std::chrono::duration<double>(end - decodeStart).count();
+
+    printf("frames           %u (%u decoded, checksum %u)\n", BENCH_RECORDS, decoded, checksum);
+    printf("bytes per frame  %.2f\n", (double)length / BENCH_RECORDS);
+    printf("encode           %.1f ns/frame, %.1f MB/s\n", encodeSeconds * 1e9 / BENCH_RECORDS, length / encodeSeconds / 1e6);
+    printf("decode           %.1f ns/frame, %.1f MB/s\n", decodeSeconds * 1e9 / BENCH_RECORDS, length / decodeSeconds / 1e6);
+
+    return (decoded == BENCH_RECORDS && decoder.get_error_count() == 0) ? 0 : 1;
+}
+
+int
+main(int argc, char **argv) {
+
+    // with --bench, run the benchmark
+    // otherwise decode the file given as argument (or the standard input)
+
+    FILE    *in;
+    int     result;
+
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return bench();
+    }
+
+    in = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+    if (in == nullptr) {
+
+        fprintf(stderr, "usage: %s [--bench | FILE]\n", argv[0]);
+        return 1;
+    }
+
+    result = decode(in);
+
+    if (in != stdin) {
+        fclose(in);
+    }
+    return result;
+}
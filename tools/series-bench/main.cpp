@@ -0,0 +1,215 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host benchmark of the compression ratio and per-sample cost of SeriesEncoder and SeriesDecoder
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "SeriesCodec.h"
+
+/** Size of each block, such as a page of flash */
+constexpr size_t    BLOCK_SIZE      = 512;
+/** Size of a sample stored without compression (32-bit timestamp and 32-bit float distance) */
+constexpr size_t    RAW_SAMPLE_SIZE = 8;
+/** Number of sensors in the synthetic trace */
+constexpr uint8_t   SYNTHETIC_SENSORS   = 8;
+/** Number of samples per sensor in the synthetic trace */
+constexpr uint32_t  SYNTHETIC_SAMPLES   = 1'000'000;
+/** Largest sensor id in a trace */
+constexpr size_t    MAX_SENSORS     = 256;
+
+/**
+ * @brief                   Sample of a trace
+ */
+struct TraceSample {
+
+    /** Timestamp in milliseconds */
+    uint32_t        timeMs;
+    /** Whether the measurement was successful */
+    bool            valid;
+    /** Distance in millimetres */
+    uint32_t        distanceMm;
+};
+
+/**
+ * @brief                   Reads a trace in the CSV format produced by sample-decoder (time_ms,sensor,sequence,distance_mm)
+ *
+ * @param in                Stream to read the trace from
+ * @param series            Samples of each sensor
+ *
+ * @return                  Number of samples read
+ */
+static size_t
+read_trace(FILE *in, std::vector<std::vector<TraceSample>> &series) {
+
+    char                line[128];
+    unsigned long long  timeMs;
+    unsigned            sensor;
+    unsigned            sequence;
+    unsigned            distance;
+    size_t              count;
+
+    count = 0;
+
+    while (fgets(line, sizeof(line), in) != nullptr) {
+
+        int fields = sscanf(line, "%llu,%u,%u,%u", &timeMs, &sensor, &sequence, &distance);
+
+        if (fields < 3 || sensor >= MAX_SENSORS) {
+            continue;
+        }
+
+        series[sensor].push_back({(uint32_t)timeMs, fields == 4, (fields == 4) ? distance : 0});
+        ++count;
+    }
+
+    return count;
+}
+
+/**
+ * @brief                   Generates a trace of sensors measured at 20Hz with scheduling jitter, slowly moving objects, noise and occasional timeouts
+ *
+ * @param series            Samples of each sensor
+ *
+ * @return                  Number of samples generated
+ */
+static size_t
+synthesize_trace(std::vector<std::vector<TraceSample>> &series) {
+
+    std::mt19937                        rng(1);
+    std::normal_distribution<float>     noise(0, 3);
+    std::uniform_int_distribution<int>  jitter(-1, 1);
+
+    for (uint8_t sensor = 0; sensor < SYNTHETIC_SENSORS; ++sensor) {
+
+        uint32_t    timeMs  = sensor * 6;
+        float       target  = 500 + sensor * 300;
+
+        for (uint32_t i = 0; i < SYNTHETIC_SAMPLES; ++i) {
+
+            timeMs  += 50 + jitter(rng);
+            target  += (rng() % 200 == 0) ? (float)(rng() % 2001) - 1000 : 0;
+            target  = (target < 100) ? 100 : (target > 4000) ? 4000 : target;
+
+            bool valid = rng() % 50 != 0;
+            series[sensor].push_back({timeMs, valid, valid ? (uint32_t)(target + noise(rng)) : 0});
+        }
+    }
+
+    return SYNTHETIC_SENSORS * SYNTHETIC_SAMPLES;
+}
+
+int
+main(int argc, char **argv) {
+
+    // compress the series of each sensor into blocks of BLOCK_SIZE bytes, as they would be written to flash
+    // then decode every block again, checking that the samples match, and report the sizes and times
+
+    std::vector<std::vector<TraceSample>>   series(MAX_SENSORS);
+    std::vector<std::vector<uint8_t>>       blocks;
+    size_t                                  samples;
+    size_t                                  bytes;
+    size_t                                  mismatches;
+    FILE                                    *in;
+
+    if (argc > 1) {
+
+        in = fopen(argv[1], "r");
+        if (in == nullptr) {
+
+            fprintf(stderr, "usage: %s [TRACE.csv]\n", argv[0]);
+            return 1;
+        }
+
+        samples = read_trace(in, series);
+        fclose(in);
+    }
+    else {
+        samples = synthesize_trace(series);
+    }
+
+    if (samples == 0) {
+
+        fprintf(stderr, "no samples\n");
+        return 1;
+    }
+
+    auto encodeStart = std::chrono::steady_clock::now();
+
+    bytes = 0;
+    for (const auto &sensorSeries : series) {
+
+        std::vector<uint8_t>    block(BLOCK_SIZE);
+        SeriesEncoder           encoder(block.data(), block.size());
+
+        for (const TraceSample &sample : sensorSeries) {
+
+            if (!encoder.add(sample.timeMs, sample.valid, sample.distanceMm)) {
+
+                bytes += encoder.size();
+                block.resize(encoder.size());
+                blocks.push_back(std::move(block));
+
+                block.assign(BLOCK_SIZE, 0);
+                encoder = SeriesEncoder(block.data(), block.size());
+                encoder.add(sample.timeMs, sample.valid, sample.distanceMm);
+            }
+        }
+
+        if (encoder.get_count() > 0) {
+
+            bytes += encoder.size();
+            block.resize(encoder.size());
+            blocks.push_back(std::move(block));
+        }
+    }
+
+    auto decodeStart = std::chrono::steady_clock::now();
+
+    std::vector<TraceSample>    decoded;
+    decoded.reserve(samples);
+
+    for (const auto &block : blocks) {
+
+        SeriesDecoder   decoder(block.data(), block.size());
+        TraceSample     sample;
+
+        while (decoder.next(&sample.timeMs, &sample.valid, &sample.distanceMm)) {
+            decoded.push_back(sample);
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    mismatches = (decoded.size() == samples) ? 0 : samples;
+    for (size_t i = 0, sensor = 0, k = 0; mismatches == 0 && i < decoded.size(); ++i, ++k) {
+
+        while (k == series[sensor].size()) {
+
+            ++sensor;
+            k = 0;
+        }
+
+        const TraceSample &expected = series[sensor][k];
+        mismatches += expected.timeMs != decoded[i].timeMs || expected.valid != decoded[i].valid || expected.distanceMm != decoded[i].distanceMm;
+    }
+
+    double encodeSeconds = std::chrono::duration<double>(decodeStart - encodeStart).count();
+    double decodeSeconds = std::chrono::duration<double>(end - decodeStart).count();
+
+    printf("samples          %zu in %zu blocks of up to %zu bytes\n", samples, blocks.size(), BLOCK_SIZE);
+    printf("bytes per sample %.2f (%.1fx smaller than %zu raw bytes)\n", (double)bytes / samples, (double)(samples * RAW_SAMPLE_SIZE) / bytes, RAW_SAMPLE_SIZE);
+    printf("encode           %.1f ns/sample\n", encodeSeconds * 1e9 / samples);
+    printf("decode           %.1f ns/sample\n", decodeSeconds * 1e9 / samples);
+    printf("mismatches       %zu\n", mismatches);
+
+    return (mismatches == 0) ? 0 : 1;
+}
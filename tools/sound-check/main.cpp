@@ -0,0 +1,236 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host check of speed_of_sound() against reference values, and of the distances converted by the unit policies once
+ *                          the speed of sound is set, up to the longest pulse a capture accepts
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "mbed.h"
+#include "EchoTiming.h"
+#include "HCSR04Units.h"
+#include "SpeedOfSound.h"
+
+/**
+ * @brief                   Speed of sound in dry air quoted by textbooks
+ */
+struct ReferenceSpeed {
+
+    /** Temperature of the air in degrees Celsius */
+    float           celsius;
+    /** Speed of sound in metres per second */
+    float           metresPerSecond;
+};
+
+/** Speeds of sound in dry air that the model must reproduce */
+constexpr ReferenceSpeed    DRY_SPEEDS[]        = {{0.0f, 331.3f}, {20.0f, 343.2f}, {35.0f, 351.9f}};
+/** Largest difference from a speed of DRY_SPEEDS in metres per second (the rounding of the quoted values) */
+constexpr double            DRY_TOLERANCE       = 0.05;
+/** Lowest and highest temperature of the range checked against the reference equation, in degrees Celsius */
+constexpr int               MIN_CELSIUS         = -10;
+constexpr int               MAX_CELSIUS         = 45;
+/** Largest relative difference from the reference equation, the accuracy stated by SpeedOfSound.h */
+constexpr double            MODEL_TOLERANCE     = 0.001;
+/** Speeds of sound at which the unit policies are checked, in metres per second */
+constexpr float             UNIT_SPEEDS[]       = {SPEED_OF_SOUND_DEFAULT, 331.3f, 343.2f, 351.9f, 358.9f};
+/** Pulse widths at which the unit policies are checked, in microseconds: 1cm, 1m, the 4m range of the sensor, a pulse without echo */
+constexpr uint32_t          UNIT_PULSES[]       = {58, 5'831, 23'324, 38'000};
+/** Largest relative difference of a distance in Centimetres from the exact one (rounding of a float) */
+constexpr double            UNIT_TOLERANCE      = 1e-5;
+/** Largest error of the Q16.16 scale of Millimetres, in millimetres per microsecond of pulse (half of its least significant bit) */
+constexpr double            SCALE_Q16_ERROR     = 0.5 / 65'536;
+
+/**
+ * @brief                   Get the speed of sound in humid air at sea level from the reference equation of Cramer (1993), with the
+ *                          saturation vapour pressure of Davis (1992), for 400 ppm of carbon dioxide
+ *
+ * @param celsius           Temperature of the air in degrees Celsius
+ * @param relativeHumidity  Relative humidity of the air in percent
+ *
+ * @return                  Speed of sound in metres per second
+ */
+static double
+cramer_speed(double celsius, double relativeHumidity) {
+
+    // the mole fraction of the vapour is the relative humidity times the saturation vapour pressure, with the enhancement factor of moist air
+
+    constexpr double    a[]         = {331.5024, 0.603055, -0.000528, 51.471935, 0.1495874, -0.000782, -1.82e-7, 3.73e-8, -2.93e-10, -85.20931,
+                                       -0.228525, 5.91e-5, -2.835149, -2.15e-13, 29.179762, 0.000486};
+    constexpr double    pressure    = 101'325.0;
+    constexpr double    carbon      = 0.0004;
+
+    double  t           = celsius;
+    double  kelvin      = celsius + 273.15;
+    double  saturation  = std::exp(1.2811805e-5 * kelvin * kelvin - 1.9509874e-2 * kelvin + 34.04926034 - 6.3536311e3 / kelvin);
+    double  enhancement = 1.00062 + 3.14e-8 * pressure + 5.6e-7 * t * t;
+    double  vapour      = relativeHumidity / 100.0 * enhancement * saturation / pressure;
+
+    return a[0] + a[1] * t + a[2] * t * t + (a[3] + a[4] * t + a[5] * t * t) * vapour + (a[6] + a[7] * t + a[8] * t * t) * pressure +
+           (a[9] + a[10] * t + a[11] * t * t) * carbon + a[12] * vapour * vapour + a[13] * pressure * pressure + a[14] * carbon * carbon +
+           a[15] * vapour * pressure * carbon;
+}
+
+/**
+ * @brief                   Checks speed_of_sound() against the speeds in dry air quoted by textbooks
+ *
+ * @return                  true if every speed is within DRY_TOLERANCE, false otherwise
+ */
+static bool
+check_dry_speeds() {
+
+    bool ok = true;
+
+    for (const ReferenceSpeed &reference : DRY_SPEEDS) {
+
+        float   speed   = speed_of_sound(reference.celsius);
+        bool    within  = std::fabs(speed - reference.metresPerSecond) <= DRY_TOLERANCE;
+
+        printf("dry air %5.1f C      %7.2f m/s, reference %7.2f m/s   %s\n", reference.celsius, speed, reference.metresPerSecond,
+               within ? "ok" : "WRONG");
+
+        ok = ok && within;
+    }
+
+    return ok;
+}
+
+/**
+ * @brief                   Checks speed_of_sound() against the reference equation over a range of temperatures and humidities
+ *
+ * @return                  true if the largest relative difference is within MODEL_TOLERANCE, false otherwise
+ */
+static bool
+check_humid_speeds() {
+
+    // the humidity term matters most in warm air, where the saturation vapour pressure is highest, so the largest difference is reported
+    // with the conditions where it occurs
+
+    double  worst           = 0;
+    int     worstCelsius    = 0;
+    int     worstHumidity   = 0;
+    bool    ok;
+
+    for (int celsius = MIN_CELSIUS; celsius <= MAX_CELSIUS; ++celsius) {
+
+        for (int humidity = 0; humidity <= 100; humidity += 10) {
+
+            double reference    = cramer_speed(celsius, humidity);
+            double difference   = std::fabs(speed_of_sound((float)celsius, (float)humidity) - reference) / reference;
+
+            if (difference > worst) {
+
+                worst           = difference;
+                worstCelsius    = celsius;
+                worstHumidity   = humidity;
+            }
+        }
+    }
+
+    ok = worst <= MODEL_TOLERANCE;
+
+    printf("humid air           %d to %d C, 0 to 100%%: at most %.3f%% from the reference, at %d C and %d%%   %s\n", MIN_CELSIUS, MAX_CELSIUS,
+           worst * 100, worstCelsius, worstHumidity, ok ? "ok" : "WRONG");
+
+    for (int celsius : {0, 20, 35}) {
+        printf("  %3d C, 50%%         %7.2f m/s, reference %7.2f m/s\n", celsius, speed_of_sound((float)celsius, 50.0f), cramer_speed(celsius, 50));
+    }
+
+    return ok;
+}
+
+/**
+ * @brief                   Checks the distance converted by a unit policy from a pulse width against the exact distance
+ *
+ * @param name              Name of the unit, printed in the report
+ * @param distance          Converted distance
+ * @param exact             Exact distance in the same unit
+ * @param allowed           Error allowed in the same unit on top of UNIT_TOLERANCE (the rounding and the fixed-point scale of an integer unit)
+ *
+ * @return                  true if the distance is within the allowed error of the exact one, false otherwise
+ */
+static bool
+check_distance(const char *name, float speed, uint32_t pulseUs, double distance, double exact, double allowed) {
+
+    bool within = std::fabs(distance - exact) <= exact * UNIT_TOLERANCE + allowed;
+
+    if (!within) {
+        printf("%-12s %6.1f m/s, %10u us: %.1f instead of %.1f   WRONG\n", name, speed, pulseUs, distance, exact);
+    }
+
+    return within;
+}
+
+/**
+ * @brief                   Checks the distances converted by Centimetres and Millimetres after each speed of UNIT_SPEEDS is set, up to the
+ *                          longest pulse that a capture waits for (ECHO_SENSOR_TIMEOUT)
+ *
+ * @return                  true if every distance is within its allowed error, false otherwise
+ */
+static bool
+check_units() {
+
+    // the longest pulse a capture accepts is the one that ends right before ECHO_SENSOR_TIMEOUT, whose product with the Q16.16 scale of
+    // Millimetres does not fit in 32 bits (see Millimetres::from_pulse()), so a product that wraps is off by metres
+    // Millimetres rounds to the nearest millimetre, and its scale to the nearest 1/65536 mm/us, whose error grows with the pulse
+    // both policies start at SPEED_OF_SOUND_DEFAULT, which is checked before any speed is set
+
+    uint32_t    longest = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(ECHO_SENSOR_TIMEOUT).count();
+    uint32_t    checked = 0;
+    bool        ok      = true;
+
+    for (size_t i = 0; i < std::size(UNIT_SPEEDS); ++i) {
+
+        Centimetres centimetres;
+        Millimetres millimetres;
+        float       speed = UNIT_SPEEDS[i];
+
+        if (i > 0) {
+
+            centimetres.set_speed_of_sound(speed);
+            millimetres.set_speed_of_sound(speed);
+        }
+
+        for (uint32_t pulseUs : UNIT_PULSES) {
+
+            ok = check_distance("centimetres", speed, pulseUs, centimetres.from_pulse(pulseUs), (double)pulseUs * speed / 20'000, 0) && ok;
+            ok = check_distance("millimetres", speed, pulseUs, millimetres.from_pulse(pulseUs), (double)pulseUs * speed / 2'000,
+                                 0.5 + pulseUs * SCALE_Q16_ERROR) && ok;
+            checked += 2;
+        }
+
+        ok = check_distance("centimetres", speed, longest, centimetres.from_pulse(longest), (double)longest * speed / 20'000, 0) && ok;
+        ok = check_distance("millimetres", speed, longest, millimetres.from_pulse(longest), (double)longest * speed / 2'000,
+                             0.5 + longest * SCALE_Q16_ERROR) && ok;
+        checked += 2;
+
+        printf("units   %6.1f m/s    %u us (timeout): %.1f cm, %u mm\n", speed, longest, centimetres.from_pulse(longest), millimetres.from_pulse(longest));
+    }
+
+    printf("units               %u conversions within the rounding of the exact distance   %s\n", checked, ok ? "ok" : "WRONG");
+
+    return ok;
+}
+
+int
+main() {
+
+    // the model is checked against the textbook values of dry air, and against the reference equation in humid air
+    // the unit policies are checked after setting the speed of sound, from a centimetre to the longest pulse a capture accepts
+
+    bool    ok;
+
+    ok = check_dry_speeds();
+    ok = check_humid_speeds() && ok;
+    ok = check_units() && ok;
+
+    printf("%s\n", ok ? "speed of sound and units match the references" : "SPEED OF SOUND OR UNITS DO NOT MATCH THE REFERENCES");
+
+    return ok ? 0 : 1;
+}
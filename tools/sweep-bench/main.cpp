@@ -0,0 +1,299 @@
+/**
+ * @file                    main.cpp
+ * @author                  Aditya Agarwal (aditya.agarwal@dumblebots.com)
+ *
+ * @brief                   Host simulation and benchmark of the sweeps of a SweepScanner in a room with a source of interference, reporting the
+ *                          time taken by a sweep and the share of the other directions that it measured correctly
+ *
+ * @copyright               Copyright (c) 2023
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "mbed.h"
+#include "MbedHost.h"
+#include "SimulatedHCSR04.h"
+#include "SweepScanner.h"
+
+/** Pin of the trigger line of the emulated sensor */
+constexpr PinName   TRIG_PIN            = D2;
+/** Pin of the echo line of the emulated sensor */
+constexpr PinName   ECHO_PIN            = D3;
+/** Pin of the signal of the servo */
+constexpr PinName   SERVO_PIN           = D6;
+
+/** Distance from the sensor to each side wall of the room in centimetres */
+constexpr float     SIDE_WALL_CM        = 100.0f;
+/** Distance from the sensor to the front wall of the room in centimetres */
+constexpr float     FRONT_WALL_CM       = 120.0f;
+/** Direction of a source of interference (for example a fan motor) in degrees */
+constexpr float     NOISE_ANGLE         = 60.0f;
+/** Half of the range of directions in which the interference reaches the echo line, in degrees */
+constexpr float     NOISE_HALF_WIDTH    = 3.0f;
+/** Time between two bursts of interference on the echo line while the sensor points at the source, in microseconds */
+constexpr uint64_t  NOISE_PERIOD_US     = 1'000;
+/** Number of edges of a burst of interference */
+constexpr uint32_t  NOISE_EDGES         = 4;
+/** Time between two edges of a burst of interference in microseconds */
+constexpr uint32_t  NOISE_INTERVAL_US   = 20;
+/** Largest error of a measured distance, relative to the true distance */
+constexpr float     MAX_RELATIVE_ERROR  = 0.02f;
+/** Number of samples per sweep of each configuration */
+constexpr size_t    COUNTS[]            = {19, 37, 91};
+
+/** Pi, to convert degrees into radians */
+constexpr float     PI                  = 3.14159265f;
+
+/**
+ * @brief                   Get the distance to the first wall in a direction of the room
+ *
+ * @param angle             Direction in degrees, 0 along the right wall and 90 towards the front wall
+ *
+ * @return                  Distance in centimetres
+ */
+static float
+wall_distance(float angle) {
+
+    // the nearest of the walls that the ray crosses
+
+    float   dx      = std::cos(angle * PI / 180);
+    float   dy      = std::sin(angle * PI / 180);
+    float   nearest = -1.0f;
+
+    auto hit = [&nearest](float distance) {
+        if (nearest < 0 || distance < nearest) {
+            nearest = distance;
+        }
+    };
+
+    if (dx > 1e-6f) {
+        hit(SIDE_WALL_CM / dx);
+    }
+    if (dx < -1e-6f) {
+        hit(-SIDE_WALL_CM / dx);
+    }
+    if (dy > 1e-6f) {
+        hit(FRONT_WALL_CM / dy);
+    }
+
+    return nearest;
+}
+
+/**
+ * @brief                   Checks whether a direction is reached by the interference
+ */
+static bool
+is_interfered(float angle) {
+
+    return std::fabs(angle - NOISE_ANGLE) <= NOISE_HALF_WIDTH;
+}
+
+/**
+ * @brief                   Get the angle to which the servo is commanded, from the pulse width driven on its pin
+ */
+static float
+servo_angle(const SweepConfig &config) {
+
+    uint32_t pulse = mbed_host::get_pwm_pulsewidth_us(SERVO_PIN);
+
+    return (float)(pulse - config.servoMinPulseUs) * config.servoRange / (config.servoMaxPulseUs - config.servoMinPulseUs);
+}
+
+/**
+ * @brief                   Source of interference that couples bursts of edges into the echo line while the sensor points at it
+ */
+struct Interference {
+
+    /** Simulated sensor whose echo line receives the interference */
+    SimulatedHCSR04 *simulated;
+    /** Configuration of the servo, to find the direction of the sensor */
+    const SweepConfig   *config;
+    /** Whether the source keeps running */
+    bool            running {true};
+    /** Whether the source has stopped scheduling bursts */
+    bool            stopped {false};
+
+    /**
+     * @brief               Injects a burst if the sensor points at the source, and schedules the next check
+     *
+     * @attention           Must only be called from a function scheduled with mbed_host::schedule_in()
+     */
+    void
+    tick() {
+
+        if (!running) {
+
+            stopped = true;
+            return;
+        }
+
+        if (is_interfered(servo_angle(*config))) {
+            simulated->inject_noise(NOISE_EDGES, NOISE_INTERVAL_US);
+        }
+
+        mbed_host::schedule_in(NOISE_PERIOD_US, [this]() { tick(); });
+    }
+};
+
+/**
+ * @brief                   Outcome of a sweep
+ */
+struct SweepResult {
+
+    /** Virtual time from the request to the callback in milliseconds */
+    double          ms;
+    /** Number of samples in directions without interference */
+    uint32_t        clear;
+    /** Number of those samples measured within MAX_RELATIVE_ERROR */
+    uint32_t        covered;
+    /** Number of samples in directions reached by the interference */
+    uint32_t        interfered;
+    /** Number of samples in directions without interference reported as backing off from the edge storm of the interference */
+    uint32_t        backoff;
+    /** Number of samples in directions without interference reported as backing off without following the interference */
+    uint32_t        stray;
+};
+
+/**
+ * @brief                   Checks the samples of a sweep against the walls of the room
+ *
+ * @param reverse           Whether the samples were swept from the last to the first
+ */
+static void
+check_samples(const PolarSample *samples, size_t count, bool reverse, SweepResult *result) {
+
+    // the echo interrupt stays disabled till the back-off of the edge storm has passed, so the samples swept right after the interference
+    // may be backing off, while a sample backing off anywhere else is a fault of its own direction that was not cleared
+
+    bool afterStorm = false;
+
+    for (size_t step = 0; step < count; ++step) {
+
+        const PolarSample   &sample = samples[reverse ? count - 1 - step : step];
+        float               truth   = wall_distance(sample.angle);
+
+        if (is_interfered(sample.angle)) {
+
+            ++result->interfered;
+            afterStorm = true;
+            continue;
+        }
+
+        ++result->clear;
+
+        if (sample.status == HCSR04Status::BACKOFF) {
+
+            if (afterStorm) {
+                ++result->backoff;
+            }
+            else {
+                ++result->stray;
+            }
+            continue;
+        }
+
+        afterStorm = false;
+
+        if (sample.status == HCSR04Status::OK && std::fabs(sample.distance - truth) <= truth * MAX_RELATIVE_ERROR) {
+            ++result->covered;
+        }
+    }
+}
+
+/**
+ * @brief                   Sweeps the room once in each direction with a number of samples per sweep
+ *
+ * @param count             Number of samples per sweep
+ * @param results           Locations to store the outcome of the forward and the reverse sweep
+ */
+static void
+run_sweeps(size_t count, SweepResult (&results)[2]) {
+
+    // the simulated sensor measures the wall in the direction the servo is commanded to when it is triggered
+    // the scanner waits for the travel and settle time of the servo before each ping, so the servo is taken to be there already
+    // while the sensor points at the source of interference, bursts of edges arrive faster than a real sensor produces them, which the
+    // capture reports as an edge storm, and which starts its back-off
+    // the simulated sensor is only destroyed once the source has stopped and the last echo has been driven
+
+    SweepConfig                 config;
+    SimulatedHCSR04             simulated(TRIG_PIN, ECHO_PIN);
+    std::vector<PolarSample>    samples(count);
+    Semaphore                   swept(0, 1);
+    Interference                interference {&simulated, &config};
+
+    simulated.set_distance([&config](uint64_t) { return wall_distance(servo_angle(config)); });
+    mbed_host::schedule_in(0, [&interference]() { interference.tick(); });
+
+    {
+        SweepScanner scanner(TRIG_PIN, ECHO_PIN, SERVO_PIN, config, samples.data(), count, [&swept](const PolarSample *, size_t) {
+            swept.release();
+        });
+
+        scanner.initialize();
+
+        for (SweepResult &result : results) {
+
+            uint64_t startUs = mbed_host::now_us();
+
+            result = SweepResult {};
+
+            scanner.do_sweep();
+            swept.acquire();
+
+            result.ms = (mbed_host::now_us() - startUs) / 1'000.0;
+            check_samples(samples.data(), count, &result == &results[1], &result);
+
+            while (scanner.is_busy()) {
+                ThisThread::sleep_for(1ms);
+            }
+        }
+
+        scanner.finalize();
+    }
+
+    interference.running = false;
+
+    while (!interference.stopped || !simulated.is_idle()) {
+        ThisThread::sleep_for(1ms);
+    }
+}
+
+int
+main() {
+
+    // every direction without interference must be measured, except those swept right after the interference while the echo interrupt is
+    // disabled by the back-off of the edge storm, which must report that they are backing off
+    // the time per sample is the travel and settle time of the servo plus the ping
+
+    bool    ok;
+
+    ok = true;
+
+    printf("room %.0f cm to the sides and %.0f cm to the front, with interference at %.0f +/- %.0f degrees\n", SIDE_WALL_CM, FRONT_WALL_CM,
+           NOISE_ANGLE, NOISE_HALF_WIDTH);
+    printf("samples  direction    sweep ms   ms/sample   covered   interfered   after storm   backing off elsewhere\n");
+
+    for (size_t count : COUNTS) {
+
+        SweepResult results[2];
+
+        run_sweeps(count, results);
+
+        for (size_t i = 0; i < 2; ++i) {
+
+            const SweepResult &result = results[i];
+
+            printf("%7zu  %-9s   %9.1f   %9.2f   %3u/%-3u   %10u   %11u   %21u\n", count, (i == 0) ? "forward" : "reverse", result.ms,
+                   result.ms / count, result.covered, result.clear, result.interfered, result.backoff, result.stray);
+
+            ok = ok && result.covered + result.backoff == result.clear && result.stray == 0;
+        }
+    }
+
+    printf("%s\n", ok ? "every direction without interference was measured, or backing off from the edge storm"
+                   : "DIRECTIONS WITHOUT INTERFERENCE WERE MISSED");
+    return ok ? 0 : 1;
+}